@@ -0,0 +1,81 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BPU_ARBITER_H_
+#define BPU_ARBITER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+#include "dnn_node/dnn_node_data.h"
+
+namespace hobot {
+namespace dnn_node {
+
+// 进程内所有dnn node共享的BPU仲裁器
+// 限制同时提交到BPU的推理任务数，有空闲名额时按照优先级从高到低放行等待中的推理任务，
+// 等待时间每超过aging_ms，推理任务的有效优先级提升一级，避免低优先级的任务饿死
+// 抢占的推理任务不排队，直接提交到BPU
+class BpuArbiter {
+ public:
+  static BpuArbiter &Instance();
+
+  // 配置仲裁器，只有第一次配置生效
+  // - 参数
+  //   - [in] max_inflight 同时提交到BPU的推理任务数上限
+  //   - [in] aging_ms 有效优先级提升一级的等待时间，单位ms
+  void Configure(int max_inflight, int aging_ms);
+
+  // 等待提交推理任务的名额
+  // - 参数
+  //   - [in] priority 推理任务的优先级
+  //   - [in] preempt 是否抢占，为true时不等待
+  //   - [in] timeout_ms 等待超时时间，小于0时一直等待
+  // - 返回值
+  //   - 0成功，超时返回HB_DNN_TIMEOUT
+  int Acquire(DnnPriorityClass priority, bool preempt, int timeout_ms);
+
+  // 推理任务结束，释放名额
+  void Release();
+
+  // 获取等待提交和已经提交的推理任务数
+  void GetLoad(int &waiting, int &inflight);
+
+ private:
+  BpuArbiter() = default;
+
+  struct Waiter {
+    int priority = 0;
+    std::chrono::steady_clock::time_point enqueue_tp;
+    bool granted = false;
+  };
+
+  // 按照有效优先级放行等待中的推理任务，需要持有mtx_
+  void Dispatch();
+
+  bool configured_ = false;
+  int max_inflight_ = 4;
+  int aging_ms_ = 50;
+  int inflight_ = 0;
+  std::list<Waiter *> waiters_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // BPU_ARBITER_H_
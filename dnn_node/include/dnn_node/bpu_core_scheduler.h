@@ -0,0 +1,83 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BPU_CORE_SCHEDULER_H_
+#define BPU_CORE_SCHEDULER_H_
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "dnn_node/dnn_node_data.h"
+
+namespace hobot {
+namespace dnn_node {
+
+// BPU核调度器
+// 统计每个BPU核上推理中的任务数和推理耗时的指数加权平均（EWMA），
+// 提交推理任务时选择期望完成时间（(推理中的任务数 + 1) * 平均推理耗时）最短的BPU核
+class BpuCoreScheduler {
+ public:
+  // - 参数
+  //   - [in] core_num BPU核数，为1时所有任务使用HB_BPU_CORE_0，只做统计
+  //   - [in] ewma_alpha 新的推理耗时在平均值中的权重，范围(0, 1]
+  explicit BpuCoreScheduler(int core_num, float ewma_alpha = 0.2);
+
+  // 为推理任务选择BPU核，并记录一个推理中的任务
+  // - 参数
+  //   - [in] pinned_core_id 用户指定的BPU核，为HB_BPU_CORE_ANY时按照负载选择
+  // - 返回值
+  //   - 选择的BPU核，HB_BPU_CORE_0或HB_BPU_CORE_1
+  int32_t Acquire(int32_t pinned_core_id = HB_BPU_CORE_ANY);
+
+  // 推理任务结束
+  // - 参数
+  //   - [in] core_id Acquire返回的BPU核
+  //   - [in] service_us 推理耗时，单位us
+  //   - [in] success 推理是否成功，失败的耗时不计入平均推理耗时
+  void Release(int32_t core_id, int64_t service_us, bool success);
+
+  // 获取每个BPU核的负载统计
+  std::vector<BpuCoreStat> GetStat();
+
+  int GetCoreNum() const { return static_cast<int>(cores_.size()); }
+
+ private:
+  struct CoreLoad {
+    int32_t core_id = HB_BPU_CORE_0;
+    int inflight = 0;
+    // 推理耗时的指数加权平均，单位us，小于等于0表示还没有统计数据
+    double ewma_service_us = 0;
+    uint64_t submit_count = 0;
+    uint64_t done_count = 0;
+    uint64_t fail_count = 0;
+    // 有推理中任务的累计时间
+    int64_t busy_us = 0;
+    std::chrono::steady_clock::time_point busy_start;
+  };
+
+  // 核的索引，core_id不合法时返回-1
+  int CoreIndex(int32_t core_id) const;
+
+  float ewma_alpha_;
+  std::vector<CoreLoad> cores_;
+  // 负载相同时轮流选择BPU核
+  size_t next_idx_ = 0;
+  std::chrono::steady_clock::time_point start_tp_;
+  std::mutex mtx_;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // BPU_CORE_SCHEDULER_H_
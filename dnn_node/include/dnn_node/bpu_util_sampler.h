@@ -0,0 +1,84 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef BPU_UTIL_SAMPLER_H_
+#define BPU_UTIL_SAMPLER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dnn_node/dnn_node_data.h"
+
+namespace hobot {
+namespace dnn_node {
+
+using BpuUtilSampleCbType =
+    std::function<void(const std::vector<BpuUtilSample> &)>;
+
+// 定期从sysfs读取每个BPU核的利用率和频率
+// 第i个核的利用率读取{sysfs_root}/bpu{i}/ratio，频率读取{sysfs_root}/bpu{i}/devfreq/*/cur_freq，
+// sysfs_root可以指向模拟的目录，用于在x86上调试
+class BpuUtilSampler {
+ public:
+  // - 参数
+  //   - [in] sysfs_root BPU的sysfs根目录
+  //   - [in] interval_ms 采样周期，单位ms
+  //   - [in] sample_cb 每次采样后在采样线程中调用
+  BpuUtilSampler(const std::string &sysfs_root,
+                 int interval_ms,
+                 BpuUtilSampleCbType sample_cb = nullptr);
+  ~BpuUtilSampler();
+
+  BpuUtilSampler(const BpuUtilSampler &) = delete;
+  BpuUtilSampler &operator=(const BpuUtilSampler &) = delete;
+
+  // 查找BPU核并启动采样线程，没有找到任何BPU核时返回-1
+  int Start();
+
+  // 最近一次采样的结果
+  std::vector<BpuUtilSample> GetLatest();
+
+ private:
+  struct CoreNode {
+    int32_t core_id = 0;
+    std::string ratio_file;
+    // 没有找到devfreq节点时为空
+    std::string freq_file;
+  };
+
+  // 读取文件中的整数，失败返回-1
+  static int64_t ReadInt(const std::string &file);
+  std::vector<BpuUtilSample> Sample();
+  void SampleLoop();
+
+  std::string sysfs_root_;
+  int interval_ms_ = 1000;
+  BpuUtilSampleCbType sample_cb_ = nullptr;
+  std::vector<CoreNode> cores_;
+
+  std::vector<BpuUtilSample> latest_;
+  bool stop_ = false;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::shared_ptr<std::thread> sample_thread_ = nullptr;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // BPU_UTIL_SAMPLER_H_
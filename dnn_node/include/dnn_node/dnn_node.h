@@ -15,16 +15,22 @@
 #ifndef DNN_NODE_H_
 #define DNN_NODE_H_
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "dnn_node/dnn_node_data.h"
+#include "std_msgs/msg/string.hpp"
 
 namespace hobot {
 namespace dnn_node {
 
 class DnnNodeImpl;
+class BpuUtilSampler;
 
 class DnnNode : public rclcpp::Node {
  public:
@@ -75,6 +81,133 @@ class DnnNode : public rclcpp::Node {
           const int alloctask_timeout_ms = -1,
           const int infer_timeout_ms = 20000);
 
+  // 使用用户提供的模型输出tensor进行推理，BPU直接将推理结果写入output_tensors，不经过内存拷贝
+  // 例如output_tensors的内存为共享内存传输或者下游直接读取的ring buffer中的内存
+  // 推理完成后output中的output_tensors就是传入的output_tensors
+  // 只支持ModelInferType模型，不支持动态batch
+  // - output_tensors的要求和生命周期
+  //   - 数量等于模型输出branch数，每个tensor的sysMem[0]需要是BPU可以访问的内存
+  //     （使用hbSysAlloc*Mem申请，或者有有效物理地址的共享内存），memSize不小于对应输出的对齐大小
+  //   - tensor的properties在推理时被设置为模型对应输出的properties
+  //   - dnn node只持有tensor的智能指针，不释放tensor的内存，用户负责内存的申请和释放
+  //   - 从调用Run到该请求的PostProcess执行完成（同步模式下到Run返回）之间，
+  //     BPU可能正在写入，用户不能读写或者释放tensor的内存
+  //   - 请求未推理（例如被准入策略丢弃）时tensor内存不会被写入
+  // - 参数
+  //   - [in] inputs 输入数据智能指针列表
+  //   - [in] output_tensors 模型输出tensor列表
+  //   - 其他参数同Run接口
+  int Run(std::vector<std::shared_ptr<DNNInput>> &inputs,
+          const std::vector<std::shared_ptr<DNNTensor>> &output_tensors,
+          const std::shared_ptr<DnnNodeOutput> &output = nullptr,
+          const bool is_sync_mode = false,
+          const int alloctask_timeout_ms = -1,
+          const int infer_timeout_ms = 20000);
+
+  // 使用DNNTensor类型数据和用户提供的模型输出tensor进行推理，output_tensors的要求同上
+  int Run(std::vector<std::shared_ptr<DNNTensor>> &inputs,
+          const std::vector<std::shared_ptr<DNNTensor>> &output_tensors,
+          const std::shared_ptr<DnnNodeOutput> &output = nullptr,
+          const bool is_sync_mode = false,
+          const int alloctask_timeout_ms = -1,
+          const int infer_timeout_ms = 20000);
+
+  // 多模型模式下使用DNNInput类型数据和模型名为model_name的模型进行推理
+  // 模型名为空时使用DnnNodePara中model_name对应的模型，其他参数同Run接口
+  // 模型不存在时返回-1
+  int Run(const std::string &model_name,
+          std::vector<std::shared_ptr<DNNInput>> &inputs,
+          const std::shared_ptr<DnnNodeOutput> &output = nullptr,
+          const std::shared_ptr<std::vector<hbDNNRoi>> rois = nullptr,
+          const bool is_sync_mode = false,
+          const int alloctask_timeout_ms = -1,
+          const int infer_timeout_ms = 20000);
+
+  // 多模型模式下使用DNNTensor类型数据和模型名为model_name的模型进行推理
+  int Run(const std::string &model_name,
+          std::vector<std::shared_ptr<DNNTensor>> &inputs,
+          const std::shared_ptr<DnnNodeOutput> &output = nullptr,
+          const bool is_sync_mode = false,
+          const int alloctask_timeout_ms = -1,
+          const int infer_timeout_ms = 20000);
+
+  // 异步推理，返回推理输出的future，推理完成后不执行PostProcess
+  // 请求未被接收（例如排队请求数达到上限）时future立即就绪，输出状态为DROPPED，
+  // 推理失败或者被丢弃时输出状态为对应的状态，future总会就绪
+  // 可以同时提交多个请求（包括不同模型的请求）后分别等待，不需要在PostProcess中匹配推理结果
+  // - 参数
+  //   - [in] inputs 输入数据智能指针列表
+  //   - [in] output 输出数据智能指针，future返回的就是此输出，为空时创建DnnNodeOutput
+  //   - [in] rois 抠图roi数据，只对ModelRoiInferType模型有效
+  //   - [in] model_name 推理使用的模型名，为空时使用DnnNodePara中model_name对应的模型
+  //   - 其他参数同Run接口
+  std::future<std::shared_ptr<DnnNodeOutput>> RunAsync(
+      std::vector<std::shared_ptr<DNNInput>> &inputs,
+      const std::shared_ptr<DnnNodeOutput> &output = nullptr,
+      const std::shared_ptr<std::vector<hbDNNRoi>> rois = nullptr,
+      const std::string &model_name = "",
+      const int alloctask_timeout_ms = -1,
+      const int infer_timeout_ms = 20000);
+
+  // 使用DNNTensor类型数据异步推理，返回推理输出的future，参数同上
+  std::future<std::shared_ptr<DnnNodeOutput>> RunAsync(
+      std::vector<std::shared_ptr<DNNTensor>> &inputs,
+      const std::shared_ptr<DnnNodeOutput> &output = nullptr,
+      const std::string &model_name = "",
+      const int alloctask_timeout_ms = -1,
+      const int infer_timeout_ms = 20000);
+
+  // 异步推理，推理完成、失败或者被丢弃时执行callback，不执行PostProcess
+  // - 参数
+  //   - [in] callback 本次推理请求的完成回调
+  //   - 其他参数同上
+  // - 返回值
+  //   - 0请求被接收，callback会被执行一次；非0请求未被接收，callback不会被执行
+  int RunAsync(std::vector<std::shared_ptr<DNNInput>> &inputs,
+               const DnnNodeRunCbType &callback,
+               const std::shared_ptr<DnnNodeOutput> &output = nullptr,
+               const std::shared_ptr<std::vector<hbDNNRoi>> rois = nullptr,
+               const std::string &model_name = "",
+               const int alloctask_timeout_ms = -1,
+               const int infer_timeout_ms = 20000);
+
+  // 批量提交异步推理请求，返回每个请求的推理输出的future，顺序和inputs_list一致
+  // 使能动态batch时，同时提交的请求可以合并为一次batch推理
+  // - 参数
+  //   - [in] inputs_list 每个推理请求的输入数据
+  //   - [in] outputs 每个推理请求的输出数据智能指针，为空或者对应位置为空时创建DnnNodeOutput
+  //   - 其他参数同RunAsync接口
+  std::vector<std::future<std::shared_ptr<DnnNodeOutput>>> RunBatch(
+      std::vector<std::vector<std::shared_ptr<DNNInput>>> &inputs_list,
+      const std::vector<std::shared_ptr<DnnNodeOutput>> &outputs = {},
+      const std::string &model_name = "",
+      const int alloctask_timeout_ms = -1,
+      const int infer_timeout_ms = 20000);
+
+  // 检测+roi模型级联推理，两级模型在同一个进程中使用同一帧图片推理，不需要序列化
+  // 中间结果和重复导入图片
+  // 先使用det_model_name模型推理pyramid，roi_gen解析推理输出生成roi，
+  // 按照roi_constraint规范化后使用roi_model_name模型推理pyramid上的roi
+  // 两级推理都完成后执行一次PostProcess，output中包含两级模型的推理输出
+  // - 参数
+  //   - [in] det_model_name 第一级模型名，为空时使用DnnNodePara中model_name对应的模型
+  //   - [in] roi_model_name 第二级模型名，模型task类型需要为ModelRoiInferType
+  //   - [in] pyramid 两级模型共同使用的输入图片
+  //   - [in] roi_gen roi生成回调，在第一级推理完成后执行
+  //   - [in] output 输出数据智能指针，用户可以继承DnnNodeCascadeOutput扩展输出
+  //   - [in] roi_constraint 第二级模型输入roi的约束
+  //   - 其他参数同Run接口，同时作用于两级推理
+  int RunCascade(const std::string &det_model_name,
+                 const std::string &roi_model_name,
+                 const std::shared_ptr<NV12PyramidInput> &pyramid,
+                 const CascadeRoiGenCbType &roi_gen,
+                 const std::shared_ptr<DnnNodeCascadeOutput> &output = nullptr,
+                 const DnnNodeRoiConstraint &roi_constraint =
+                     DnnNodeRoiConstraint(),
+                 const bool is_sync_mode = false,
+                 const int alloctask_timeout_ms = -1,
+                 const int infer_timeout_ms = 20000);
+
  protected:
   // 设置DnnNodePara类型的dnn_node_para_ptr_
   virtual int SetNodePara() = 0;
@@ -90,6 +223,8 @@ class DnnNode : public rclcpp::Node {
   std::shared_ptr<DnnNodePara> dnn_node_para_ptr_ = nullptr;
 
   // 获取dnn node管理和推理使用的模型。
+  // 返回的指针由当前加载的模型文件持有，SwapModel替换模型后旧模型在推理完成时释放，
+  // 之前获取的指针不再有效，替换后需要重新获取
   Model *GetModel();
 
   // 获取模型的输入size
@@ -99,9 +234,151 @@ class DnnNode : public rclcpp::Node {
   //   - [out] h 模型输入的高度。
   int GetModelInputSize(int32_t input_index, int &w, int &h);
 
+  // 多模型模式下根据模型名获取模型，模型不存在时返回nullptr
+  Model *GetModel(const std::string &model_name);
+
+  // 多模型模式下根据模型名获取模型的输入size，模型不存在时返回-1
+  int GetModelInputSize(const std::string &model_name,
+                        int32_t input_index,
+                        int &w,
+                        int &h);
+
+  // 初始化是否完成并且成功，同步初始化时Init成功返回后即为true
+  bool IsReady();
+
+  // 等待异步初始化完成，timeout_ms小于0时一直等待
+  // - 返回值
+  //   - 0初始化成功，超时返回DNN_NODE_NOT_READY，初始化失败返回失败码
+  int WaitReady(int timeout_ms = -1);
+
+  // 获取初始化耗时统计，包括模型加载、创建task、预热推理的耗时和总的time to ready
+  DnnNodeInitStat GetInitStat();
+
+  // 获取推理完成事件的eventfd，用于在ROS executor等事件循环中等待推理完成
+  // 每完成一个推理任务eventfd计数加1，读取eventfd可清零计数
+  // 只在流水线模式下使能completion reactor时有效，否则返回-1
+  int GetCompletionEventFd();
+
+  // 取消排队中的异步推理请求，例如同一数据流中已经被新请求替代的请求
+  // 被取消的请求在调用线程中执行后处理，输出状态为CANCELED
+  // - 参数
+  //   - [in] pred 返回true表示取消对应输出的推理请求，输出中包含Run时传入的msg_header
+  // - 返回值
+  //   - 取消的推理请求数
+  int CancelPendingRuns(
+      const std::function<bool(const std::shared_ptr<DnnNodeOutput> &)> &pred);
+
+  // 获取推理请求准入统计，包括各准入策略下被拒绝和丢弃的推理请求数，以及超过截止时间被丢弃的推理请求数
+  DnnNodeAdmissionStat GetAdmissionStat();
+
+  // 获取每个BPU核的负载统计，包括推理中的任务数、平均推理耗时和利用率
+  std::vector<BpuCoreStat> GetBpuCoreStat();
+
+  // 获取推理task统计，包括推理超时的task数，以及使能task watchdog时被回收的task数
+  DnnNodeTaskStat GetTaskStat();
+
+  // 获取推理流程各阶段的耗时统计，包括次数、平均值、P50/P90/P99/P99.9分位数和最大值，单位us
+  // 统计从启动或者上次ResetLatencyStat开始，各阶段使用单调时钟计时，端到端耗时从msg_header的时间戳开始计算
+  // - 参数
+  //   - [in] model_name 模型名，为空时获取DnnNodePara中model_name对应模型的统计
+  // - 返回值
+  //   - 各阶段的耗时统计，顺序和DnnNodeLatencyStage一致，模型不存在时为空
+  std::vector<DnnNodeLatencyStat> GetLatencyStat(
+      const std::string &model_name = "");
+
+  // 清空所有模型各阶段的耗时统计，开始新的统计窗口
+  void ResetLatencyStat();
+
+  // 导出进程内各线程缓存的trace事件，包括排队、申请task、前处理、提交推理、等待推理完成、解析和后处理，
+  // 同一帧的事件通过msg_header的时间戳关联，可以使用chrome://tracing或者Perfetto UI打开
+  // 需要编译时打开cmake选项DNN_NODE_ENABLE_TRACE，否则没有事件
+  // - 参数
+  //   - [in] file_name 导出的json文件，为空时使用DnnNodePara中的trace_file
+  // - 返回值
+  //   - 0成功，非0失败
+  int DumpTrace(const std::string &file_name = "");
+
+  // 将flight recorder中最近帧的处理记录导出为csv文件，各阶段时刻相对于请求创建，单位us
+  // 端到端耗时超过DnnNodePara中flight_recorder_threshold_ms时会自动导出，也可以调用此接口手动导出
+  // - 参数
+  //   - [in] file_name 导出的csv文件
+  //   - [in] model_name 模型名，为空时导出DnnNodePara中model_name对应模型的记录
+  // - 返回值
+  //   - 0成功，非0失败
+  int DumpFlightRecord(const std::string &file_name,
+                       const std::string &model_name = "");
+
+  // 获取每个task slot的状态，以及推理流程中各队列的深度
+  // 用于吞吐下降时判断task是卡在BPU推理（INFERRING且占用时间长）、等待CPU处理（队列堆积）还是泄漏（长期占用且无对应的帧）
+  // - 参数
+  //   - [in] model_name 模型名，为空时获取DnnNodePara中model_name对应模型的task状态
+  // - 返回值
+  //   - task状态表，模型不存在时tasks为空
+  DnnNodeTaskTable GetTaskTable(const std::string &model_name = "");
+
+  // 获取BPU实际负载和dnn node自身的负载、吞吐
+  // DnnNodePara中bpu_sample_interval_ms大于0时包括从sysfs采样的每个BPU核的利用率和频率
+  // - 返回值
+  //   - BPU负载统计，cpu_bound为true表示BPU空闲但是请求排队或者被丢弃，瓶颈在CPU侧
+  DnnNodeBpuStat GetBpuStat();
+
+  // 获取进程内hbSysMem的使用统计，按照申请的类别统计，最后一项为所有类别的总和
+  // 统计在进程内共享，包括同一进程中所有dnn node和用户通过SysMemAccounting申请的内存
+  // - 返回值
+  //   - 每个类别的当前占用、峰值、申请/释放次数、失败次数、预算和申请速率
+  std::vector<SysMemStat> GetSysMemStat();
+
+  // 设置hbSysMem的预算，超出预算的申请直接失败
+  // - 参数
+  //   - [in] category 内存类别，为SysMemCategory::CATEGORY_NUM时设置所有类别的总预算
+  //   - [in] budget_bytes 预算，单位字节，0表示不限制
+  void SetSysMemBudget(SysMemCategory category, uint64_t budget_bytes);
+
+  // 不重启node热替换推理使用的模型，可以在后台线程中调用
+  // 在调用线程中加载和预热新模型，期间推理继续使用旧模型
+  // 新模型的输入输出个数、数据类型、layout和shape需要和旧模型一致，否则替换失败
+  // 替换后输出中的model_name保持不变，之前通过GetModel获取的Model指针不再有效
+  // - 参数
+  //   - [in] model_file 新模型文件
+  //   - [in] file_model_name 新模型在模型文件中的模型名，为空时使用文件中唯一的模型或者原模型名
+  //   - [in] model_name 被替换的模型名，为空时替换DnnNodePara中model_name对应的模型
+  //   - [in] drain_timeout_ms 等待旧模型上推理中任务完成的超时时间，超时后旧模型在任务完成时释放
+  // - 返回值
+  //   - 0成功，失败时继续使用旧模型。新模型预热失败时不替换，
+  //     模型输入不支持预热时跳过预热继续替换
+  int SwapModel(const std::string &model_file,
+                const std::string &file_model_name = "",
+                const std::string &model_name = "",
+                int drain_timeout_ms = 1000);
+
  private:
+  // 创建查询和重置耗时统计的服务
+  void CreateLatencyService();
+
+  // 创建导出trace的服务
+  void CreateTraceService();
+
+  // 创建查询task状态的服务
+  void CreateTaskTableService();
+
+  // 创建查询hbSysMem使用统计的服务
+  void CreateSysMemService();
+
+  // 启动BPU利用率采样
+  void StartBpuSampler();
+  // 每次采样后判断是否CPU瓶颈，并发布BPU负载
+  void OnBpuSample(const std::vector<BpuUtilSample> &samples);
+
   // dnn node的实现类
   std::shared_ptr<DnnNodeImpl> dnn_node_impl_;
+
+  std::shared_ptr<BpuUtilSampler> bpu_sampler_ = nullptr;
+  rclcpp::Publisher<std_msgs::msg::String>::SharedPtr bpu_stat_pub_ =
+      nullptr;
+  // 上次采样时被拒绝和丢弃的请求总数，只在采样线程中访问
+  uint64_t last_drop_count_ = 0;
+  std::chrono::steady_clock::time_point last_cpu_bound_warn_tp_;
+  std::atomic<bool> cpu_bound_{false};
 };
 
 }  // namespace dnn_node
@@ -15,6 +15,7 @@
 #ifndef DNN_NODE_DATA_H_
 #define DNN_NODE_DATA_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -29,7 +30,9 @@
 #include "easy_dnn/model.h"
 #include "easy_dnn/model_infer_task.h"
 #include "easy_dnn/model_roi_infer_task.h"
+#include "easy_dnn/sys_mem.h"
 #include "easy_dnn/task.h"
+#include "easy_dnn/tensor_pool.h"
 
 namespace hobot {
 namespace dnn_node {
@@ -41,8 +44,11 @@ using hobot::easy_dnn::Model;
 using hobot::easy_dnn::ModelInferTask;
 using hobot::easy_dnn::ModelRoiInferTask;
 using hobot::easy_dnn::NV12PyramidInput;
+using hobot::easy_dnn::SysMemCategory;
+using hobot::easy_dnn::SysMemStat;
 
 using hobot::easy_dnn::Task;
+using hobot::easy_dnn::TensorPool;
 using rclcpp::NodeOptions;
 
 using TaskId = int;
@@ -57,6 +63,95 @@ enum class ModelTaskType {
   ModelRoiInferType = 2
 };
 
+// 异步推理时排队的推理请求数达到上限后，新推理请求的准入策略
+// - RejectNew: 拒绝新的推理请求，Run返回DNN_NODE_RUN_QUEUE_FULL
+// - DropOldest: 丢弃最早排队的推理请求，接收新的推理请求
+// - LatestOnly: 每个数据流（按照msg_header的frame_id区分）只保留最新的排队请求，
+//   同一数据流中被新请求替代的排队请求被丢弃，排队请求数达到上限时同DropOldest；
+//   没有msg_header或者frame_id为空的请求不属于任何数据流，不会替代其他请求
+// - BoundedWait: 等待排队的推理请求被处理，超时后Run返回DNN_NODE_RUN_WAIT_TIMEOUT
+// 被丢弃的推理请求在Run的调用线程中执行后处理，输出状态为DROPPED
+enum class RunAdmissionPolicy {
+  RejectNew = 0,
+  DropOldest = 1,
+  LatestOnly = 2,
+  BoundedWait = 3
+};
+
+// 异步推理请求未被接收时Run接口的返回值
+// 排队的推理请求数达到上限，RejectNew策略
+constexpr int DNN_NODE_RUN_QUEUE_FULL = -100;
+// 等待排队超时，BoundedWait策略
+constexpr int DNN_NODE_RUN_WAIT_TIMEOUT = -101;
+// 推理请求队列已关闭，例如dnn node正在析构
+constexpr int DNN_NODE_RUN_QUEUE_CLOSED = -102;
+
+// dnn node初始化完成前Run接口的返回值
+constexpr int DNN_NODE_NOT_READY = -103;
+
+// 同步推理请求超过截止时间被丢弃时Run接口的返回值，此时已经执行了后处理，输出状态为EXPIRED
+constexpr int DNN_NODE_RUN_EXPIRED = -104;
+
+// 模型输入不支持预热（例如图片和tensor混合输入）时预热的返回值，此时跳过预热
+constexpr int DNN_NODE_WARMUP_UNSUPPORTED = -105;
+
+// 等待BPU仲裁器放行超时时推理的失败码，和BPU推理超时（HB_DNN_TIMEOUT）区分
+constexpr int DNN_NODE_ARBITER_TIMEOUT = -106;
+
+// 模型文件的加载方式
+// - File: 使用hbDNNInitializeFromFiles从文件加载
+// - Mmap: 将文件mmap到内存后使用hbDNNInitializeFromDDR加载，映射在模型释放时解除
+// - Memory: 使用hbDNNInitializeFromDDR从DnnNodePara中的model_data加载，
+//   模型引用model_data，不和其他node共享加载的模型
+enum class ModelLoadMode { File = 0, Mmap = 1, Memory = 2 };
+
+// 异步初始化完成前推理请求的处理策略
+// - Reject: Run返回DNN_NODE_NOT_READY
+// - Queue: 异步推理请求排队（不超过msg_limit_count），初始化完成后按照准入策略处理；
+//   同步推理等待初始化完成，alloctask_timeout_ms大于等于0时最多等待alloctask_timeout_ms
+// 初始化失败时排队的推理请求执行后处理，输出状态为INFER_FAILED
+enum class NotReadyPolicy { Reject = 0, Queue = 1 };
+
+// 推理任务的优先级，优先级越高越先提交到BPU
+// Default只用于单次推理请求，表示使用dnn node的优先级
+enum class DnnPriorityClass {
+  Default = -1,
+  Low = 0,
+  Normal = 1,
+  High = 2,
+  Critical = 3
+};
+
+// 级联推理中第二级模型输入roi的约束，用于将第一级模型解析出的检测框规范化为roi
+// roi坐标为闭区间，规范化后left和top为偶数，right和bottom为奇数（宽高为偶数），
+// 并且限制在输入图片内
+struct DnnNodeRoiConstraint {
+  // 以检测框中心扩展宽高的比例
+  float expand_ratio = 1.0f;
+
+  // 是否以长边为边长扩展为正方形，在expand_ratio之后执行
+  bool square = false;
+
+  // roi宽高的范围，超出范围的roi被过滤，max_size小于等于0时不限制
+  int min_size = 16;
+  int max_size = 0;
+};
+
+// 多模型模式下，模型文件中其他需要管理和推理的模型的参数
+struct DnnNodeSubModelPara {
+  // 模型名
+  std::string model_name;
+
+  // 模型的task类型
+  ModelTaskType model_task_type = ModelTaskType::ModelInferType;
+
+  // 创建的task数量
+  int task_num = 2;
+
+  // 为task指定使用的BPU核，为空或者size等于task_num，含义同DnnNodePara中的bpu_core_ids
+  std::vector<int32_t> bpu_core_ids{};
+};
+
 struct DnnNodePara {
   // 模型文件名称
   std::string model_file;
@@ -68,6 +163,29 @@ struct DnnNodePara {
   // 如果模型文件中只包含一个模型时，可以不指定模型名
   std::string model_name{""};
 
+  // 多模型模式，同一个模型文件中除model_name之外还需要管理和推理的模型
+  // 所有模型共享一次加载的模型文件，每个模型使用独立的task、模型task类型和推理线程，
+  // 其余参数和model_name对应的模型相同
+  // 推理时通过模型名指定使用的模型，推理输出的model_name为推理使用的模型名
+  std::vector<DnnNodeSubModelPara> sub_models{};
+
+  // 模型文件的加载方式
+  ModelLoadMode model_load_mode = ModelLoadMode::File;
+
+  // Memory方式加载时的模型数据和长度，需要在dnn node析构前保持有效
+  const void *model_data = nullptr;
+  int32_t model_data_size = 0;
+
+  // 异步初始化，使能后Init只校验参数，在后台线程中加载模型、创建task和预热
+  // 初始化完成前的推理请求按照not_ready_policy处理，可以通过WaitReady等待初始化完成
+  // 初始化完成前GetModel等获取模型信息的接口无效
+  bool async_init = false;
+  NotReadyPolicy not_ready_policy = NotReadyPolicy::Reject;
+
+  // 初始化完成前使用全0的输入预热推理的次数，预先分配内存池并触发首次推理的开销
+  // 同时对多模型模式下的其他模型生效
+  int warmup_num = 0;
+
   // 模型的task类型，dnn node根据模型类型创建task
   // 当算法的输入包含roi（Region of
   // Interest，例如目标的检测框）时选择ModelRoiInferType类型，其他情况下选择ModelInferType类型。
@@ -81,14 +199,163 @@ struct DnnNodePara {
   int task_num = 2;
 
   // 推理任务使用的BPU核，包括以下几种类型
-  // - HB_BPU_CORE_ANY: 不指定BPU核，推理任务交替使用两个BPU核，实现负载均衡
+  // - HB_BPU_CORE_ANY: 不指定BPU核，根据每个BPU核的负载选择BPU核，实现负载均衡
   // - HB_BPU_CORE_0: 推理任务使用BPU 0
   // - HB_BPU_CORE_1: 推理任务使用BPU 1
   // 为task指定使用的BPU核，bpu_core_ids为空或者size等于task_num
-  // 为空不指定，即使用BPU_CORE_ANY模式
+  // 为空不指定，即使用BPU_CORE_ANY模式，每次提交推理任务时选择期望完成时间最短的BPU核
   // 当bpu_core_ids size等于task_num时，分别为每个task指定对应的BPU核
   // 例如task_num为2，bpu_core_ids为{HB_BPU_CORE_0, HB_BPU_CORE_1}时，两个task分别运行在BPU 0 和 BPU 1 上
   std::vector<int32_t> bpu_core_ids{};
+
+  // dnn node推理任务的优先级，DnnNodeOutput中没有指定优先级时使用
+  // 非Normal的优先级同时设置到推理任务的hbDNNInferCtrlParam中，由BPU按照优先级调度，
+  // Normal使用hbDNN的默认优先级
+  DnnPriorityClass priority = DnnPriorityClass::Normal;
+
+  // 允许推理请求使用抢占模式（DnnNodeOutput中preempt为true），
+  // 抢占的推理任务不经过BPU仲裁器排队，并使用HB_DNN_PRIORITY_PREEMP优先级
+  bool allow_preemption = false;
+
+  // 使用进程内所有dnn node共享的BPU仲裁器，限制同时提交到BPU的推理任务数，
+  // 并按照优先级提交推理任务，适用于多个dnn node竞争BPU的场景
+  // 等待放行的时间不超过infer_timeout_ms，超时的推理失败码为DNN_NODE_ARBITER_TIMEOUT
+  bool enable_bpu_arbiter = false;
+
+  // BPU仲裁器的配置，进程内第一个使能仲裁器的dnn node的配置生效
+  // 同时提交到BPU的推理任务数上限
+  int bpu_arbiter_max_inflight = 4;
+  // 推理任务等待时间每超过bpu_arbiter_aging_ms，有效优先级提升一级，避免低优先级任务饿死
+  int bpu_arbiter_aging_ms = 50;
+
+  // 模型输出tensor内存池中每个输出branch的内存块数量上限
+  // task持有一份输出内存，其余的被用户通过DnnNodeOutput持有
+  // 小于等于0时使用2 * task_num，即用户最多同时持有task_num帧推理输出
+  int output_tensor_pool_size = 0;
+
+  // 内存池耗尽（用户持有推理输出过久）时，等待用户释放输出的超时时间，单位ms
+  // 超时后本次推理失败，小于0表示一直等待
+  int output_tensor_pool_timeout_ms = 1000;
+
+  // 异步推理请求的准入策略
+  RunAdmissionPolicy admission_policy = RunAdmissionPolicy::RejectNew;
+
+  // 异步推理时排队的推理请求数上限，流水线模式下使用preprocess_queue_depth
+  int msg_limit_count = 10;
+
+  // BoundedWait策略下等待排队的超时时间，单位ms
+  int admission_wait_ms = 10;
+
+  // task watchdog，定期检查推理中的task，占用时间超过task_watchdog_timeout_ms时强制回收，
+  // 尽可能取消对应的BPU推理任务，并使用新创建的task替换，避免task泄漏导致推理吞吐下降
+  // 小于等于0时不使能，使能时应大于infer_timeout_ms
+  int task_watchdog_timeout_ms = 0;
+  // watchdog的检查周期，单位ms
+  int task_watchdog_interval_ms = 1000;
+
+  // 创建查询和重置各阶段耗时统计的ROS服务（std_srvs/srv/Trigger），服务名为
+  // ~/dnn_latency_stat和~/dnn_latency_reset，查询服务在message中返回各模型各阶段的分位数
+  // 耗时统计一直开启，不受此开关影响，也可以通过GetLatencyStat接口获取
+  bool enable_latency_service = false;
+
+  // 创建导出trace的ROS服务（std_srvs/srv/Trigger），服务名为~/dnn_trace_dump，
+  // 将各线程缓存的帧处理流程trace事件导出到trace_file，格式为Chrome trace event json
+  // 需要编译时打开cmake选项DNN_NODE_ENABLE_TRACE才会记录trace事件
+  bool enable_trace_service = false;
+  std::string trace_file = "dnn_node_trace.json";
+
+  // 创建查询task状态的ROS服务（std_srvs/srv/Trigger），服务名为~/dnn_task_table，
+  // 在message中返回每个task slot的状态、BPU核、占用时长和对应的帧，以及各队列的深度
+  bool enable_task_table_service = false;
+
+  // 从sysfs采样BPU利用率和频率的周期，单位ms，小于等于0时不采样
+  int bpu_sample_interval_ms = 0;
+  // BPU的sysfs根目录，可以指向模拟的目录用于在x86上调试
+  std::string bpu_sysfs_root = "/sys/devices/system/bpu";
+  // 所有BPU核的利用率低于此值（单位%）且有请求排队或者被丢弃时，判断为CPU瓶颈并告警
+  float bpu_idle_threshold = 30;
+  // 每次采样后在~/dnn_bpu_stat话题（std_msgs/msg/String）上发布BPU利用率、dnn node推理中的任务数和吞吐
+  bool enable_bpu_stat_publisher = false;
+
+  // 进程内所有hbSysMem申请（输出tensor、图片转换、预热输入等）的总预算，单位MB，小于等于0时不限制
+  // 超出预算的申请直接失败，不会调用系统接口，避免耗尽板端多个进程共享的内存
+  // 预算在进程内共享，多个dnn node设置时以最后一次设置为准
+  int sys_mem_budget_mb = 0;
+  // 创建查询hbSysMem使用统计的ROS服务（std_srvs/srv/Trigger），服务名为~/dnn_sys_mem_stat，
+  // 在message中返回每个类别的当前占用、峰值、申请次数、失败次数和申请速率
+  bool enable_sys_mem_service = false;
+
+  // flight recorder一直保存最近flight_recorder_frame_num帧的处理记录，包括各阶段的时刻、task、BPU核、
+  // 排队的请求数和输出内存块数，小于等于0时不使能
+  int flight_recorder_frame_num = 64;
+  // 一帧的端到端耗时（从msg_header的时间戳到后处理完成）超过阈值时，自动将记录导出到
+  // flight_recorder_dir目录下的dnn_flight_{model_name}_{时间戳}.csv，单位ms，小于等于0时不自动导出
+  int flight_recorder_threshold_ms = -1;
+  // 两次自动导出的最小间隔，单位ms，避免持续超时时频繁写文件
+  int flight_recorder_dump_interval_ms = 10000;
+  std::string flight_recorder_dir = ".";
+
+  // 推理请求的默认截止时间预算，单位ms，截止时间为msg_header的时间戳加上预算
+  // DnnNodeOutput中未指定截止时间时生效，小于等于0或者没有msg_header时不限制
+  int deadline_budget_ms = -1;
+
+  // 异步推理线程池配置，只对非流水线模式的异步推理有效
+  // 线程池名称，同时作为线程名前缀
+  // 同一进程中executor_shared为true且名称相同的dnn node共享同一个线程池，避免线程数超过CPU核数
+  // 共享时线程池的配置以第一个创建线程池的dnn node为准
+  std::string executor_name{"dnn_exec"};
+  bool executor_shared = false;
+
+  // 线程池的线程数，小于等于0时使用task_num
+  int executor_thread_num = 0;
+
+  // 线程绑定的CPU核，第i个线程绑定到executor_cpu_affinity[i % size]，为空时不绑定
+  std::vector<int> executor_cpu_affinity{};
+
+  // 大于0时线程使用SCHED_FIFO实时调度策略和该优先级（1-99），需要CAP_SYS_NICE权限
+  // 否则使用SCHED_OTHER调度策略和executor_nice
+  int executor_sched_priority = 0;
+  int executor_nice = 0;
+
+  // 动态batch，只对batch模型（模型输入的第一维大于1）的ModelInferType任务有效，流水线模式下不支持
+  // 使能后多个推理请求（例如并发的同步Run调用、异步推理或者多路相机）合并为一个batch提交推理，
+  // 收集到batch size个请求或者等待超过batch_max_wait_ms后提交推理，不足batch size时使用最后一个请求补齐
+  // 推理输出按照batch拆分后分别填充到每个请求的DnnNodeOutput并执行后处理
+  // 收集期间超过截止时间的请求不参与推理，batch使用其中最早的截止时间，超过时所有请求按照EXPIRED输出
+  // 异步推理时，收集batch的线程会等待其他线程提交请求，task_num需要大于1
+  bool enable_dynamic_batch = false;
+  int batch_max_wait_ms = 5;
+
+  // 流水线模式，只对异步推理有效
+  // 使能后推理流程拆分为前处理（申请task和输入预处理）、BPU推理（提交推理任务和等待推理完成）、
+  // 后处理（用户定义的PostProcess）三个阶段，每个阶段使用独立的有界队列和线程，
+  // 多帧之间并行执行，BPU推理当前帧时CPU可以同时处理前一帧的后处理和下一帧的前处理
+  bool enable_pipeline = false;
+
+  // 流水线各阶段的队列深度，前处理队列满时按照admission_policy处理新的推理请求
+  int preprocess_queue_depth = 4;
+  int infer_queue_depth = 2;
+  int postprocess_queue_depth = 4;
+
+  // 流水线各阶段的线程数
+  // BPU推理阶段的线程会阻塞等待推理完成，小于等于0时使用task_num
+  int preprocess_thread_num = 1;
+  int infer_thread_num = 0;
+  int postprocess_thread_num = 1;
+
+  // 推理完成reactor，只在流水线模式下有效
+  // 使能后BPU推理阶段的线程只提交推理任务，由一个reactor线程轮询所有推理中的任务，
+  // 推理完成后分发到后处理阶段，避免每个推理中的任务都占用一个阻塞等待的线程
+  // 此时infer_thread_num小于等于0时使用1个线程
+  bool enable_completion_reactor = false;
+
+  // reactor每轮检查所有推理中的任务，不等待单个任务，
+  // 一轮中没有任务完成时睡眠reactor_poll_timeout_ms后开始下一轮，单位ms，最小为1ms
+  int reactor_poll_timeout_ms = 1;
+
+  // 低延迟模式，有推理中的任务时reactor线程忙等而不是睡眠，会占满一个CPU核，
+  // 没有推理中的任务时仍然等待提交
+  bool reactor_busy_poll = false;
 };
 
 // 运行时时间统计
@@ -111,6 +378,172 @@ struct DnnNodeRunTimeStat {
   bool fps_updated = false;
 };
 
+// 异步推理请求准入统计
+struct DnnNodeAdmissionStat {
+  // 接收的推理请求数
+  uint64_t accepted = 0;
+  // RejectNew策略下被拒绝的推理请求数
+  uint64_t rejected = 0;
+  // BoundedWait策略下等待超时的推理请求数
+  uint64_t wait_timeout = 0;
+  // DropOldest和LatestOnly策略下，排队请求数达到上限时被丢弃的最早的排队请求数
+  uint64_t dropped_oldest = 0;
+  // LatestOnly策略下，被同一数据流中新请求替代的排队请求数
+  uint64_t coalesced = 0;
+  // 被用户取消的排队请求数
+  uint64_t canceled = 0;
+  // 超过截止时间被丢弃的推理请求数
+  uint64_t expired = 0;
+};
+
+// 推理流程的各个阶段，用于耗时统计
+enum class DnnNodeLatencyStage {
+  // 异步推理请求排队等待处理，动态batch时包括收集batch的等待
+  QueueWait = 0,
+  // 等待申请推理task
+  AllocWait,
+  // 设置模型输入和输入预处理
+  PreProcess,
+  // 等待BPU仲裁器和提交推理任务
+  Submit,
+  // 提交推理任务到推理完成
+  BpuExec,
+  // 获取推理输出
+  Parse,
+  // 执行用户的后处理
+  PostProcess,
+  // 从msg_header的时间戳到后处理完成，时间戳为系统时间，因此使用系统时钟计算
+  EndToEnd,
+  StageNum
+};
+
+// 推理流程一个阶段的耗时统计，单位us
+struct DnnNodeLatencyStat {
+  DnnNodeLatencyStage stage = DnnNodeLatencyStage::QueueWait;
+  // 统计窗口内的次数
+  uint64_t count = 0;
+  double mean_us = 0;
+  double p50_us = 0;
+  double p90_us = 0;
+  double p99_us = 0;
+  double p999_us = 0;
+  double max_us = 0;
+};
+
+// 推理task统计
+struct DnnNodeTaskStat {
+  // 等待推理完成超时的task数
+  uint64_t infer_timeout = 0;
+  // 等待BPU仲裁器放行超时，没有提交推理的task数
+  uint64_t arbiter_timeout = 0;
+  // 占用时间超过task_watchdog_timeout_ms，被watchdog强制回收的task数
+  uint64_t reclaimed = 0;
+  // 回收时成功取消了BPU推理任务的task数
+  uint64_t canceled = 0;
+};
+
+// 一个task slot的状态
+struct DnnNodeTaskInfo {
+  TaskId task_id = -1;
+  // 是否被推理请求占用
+  bool running = false;
+  // easy_dnn中task的状态，例如ALLOCATED、INPUT_PROCESS_DONE、INFERRING、INFERENCE_TIMEOUT
+  std::string status;
+  // 推理使用的BPU核，-1表示还未提交推理任务
+  int32_t bpu_core_id = -1;
+  // 从申请task到现在的时间，单位ms，未被占用时为-1
+  int64_t age_ms = -1;
+  // 占用task的推理请求对应的帧
+  std::string frame_id;
+  int64_t frame_stamp_ns = 0;
+};
+
+// 所有task slot的状态和推理流程中各队列的深度
+struct DnnNodeTaskTable {
+  std::string model_name;
+  std::vector<DnnNodeTaskInfo> tasks;
+  // 非流水线模式下排队等待推理的请求数
+  int pending_run_num = 0;
+  // 流水线模式下各阶段排队的请求数，非流水线模式下为0
+  int preprocess_queue_depth = 0;
+  int infer_queue_depth = 0;
+  int postprocess_queue_depth = 0;
+  // 流水线模式下已经提交、等待BPU推理完成的任务数
+  int reactor_inflight_num = 0;
+};
+
+// BPU核负载统计
+struct BpuCoreStat {
+  // BPU核，HB_BPU_CORE_0或HB_BPU_CORE_1
+  int32_t core_id = HB_BPU_CORE_0;
+  // 推理中的任务数
+  int inflight = 0;
+  // 推理耗时的指数加权平均，单位ms
+  float ewma_service_ms = 0;
+  // 提交、推理成功和推理失败的任务数
+  uint64_t submit_count = 0;
+  uint64_t done_count = 0;
+  uint64_t fail_count = 0;
+  // 利用率，有推理中任务的时间占统计时间的比例
+  float utilization = 0;
+};
+
+// 从sysfs采样的BPU核负载
+struct BpuUtilSample {
+  int32_t core_id = 0;
+  // 平台统计的利用率，单位%，-1表示读取失败
+  float utilization = -1;
+  // 当前频率，单位Hz，-1表示平台没有devfreq节点或者读取失败
+  int64_t freq_hz = -1;
+};
+
+// BPU实际负载和dnn node自身的负载、吞吐，用于判断增加task_num是否能提升吞吐
+struct DnnNodeBpuStat {
+  // sysfs采样的每个BPU核的负载，没有使能采样时为空
+  std::vector<BpuUtilSample> samples;
+  // dnn node统计的每个BPU核推理中的任务数和利用率
+  std::vector<BpuCoreStat> core_stats;
+  float input_fps = -1;
+  float output_fps = -1;
+  // 排队等待处理的请求数
+  int queue_depth = 0;
+  // BPU空闲但是有请求排队或者被丢弃，瓶颈在CPU侧，增加task_num不能提升吞吐
+  bool cpu_bound = false;
+};
+
+// dnn node初始化统计，单位ms
+struct DnnNodeInitStat {
+  // 初始化是否完成
+  bool done = false;
+  // 初始化结果，0为成功
+  int ret = 0;
+  // 加载模型文件和初始化模型的耗时
+  int64_t load_ms = 0;
+  // 创建task的耗时
+  int64_t task_init_ms = 0;
+  // 预热推理的耗时
+  int64_t warmup_ms = 0;
+  // 预热结果，0为成功或者没有配置预热，模型输入不支持预热时为DNN_NODE_WARMUP_UNSUPPORTED，
+  // 多模型时为第一个失败的模型的结果。预热失败不影响初始化结果
+  int warmup_ret = 0;
+  // 从调用Init到可以推理的耗时
+  int64_t ready_ms = 0;
+};
+
+// 推理输出状态
+enum class DnnNodeOutputStatus {
+  // 推理成功，或者roi推理时当前帧中无roi
+  SUCCESS = 0,
+  // 推理失败
+  INFER_FAILED = 1,
+  // 排队时被准入策略丢弃，未推理
+  DROPPED = 2,
+  // 排队时被用户取消，未推理
+  CANCELED = 3,
+  // 超过截止时间，在排队、申请task或者提交推理前被丢弃，未推理
+  EXPIRED = 4
+};
+
 // 用户可以继承DnnNodeOutput来扩展输出内容
 // 例如增加推理结果对应的图片数据、图片名、时间戳、ID等
 struct DnnNodeOutput {
@@ -126,6 +559,7 @@ struct DnnNodeOutput {
 
   // 模型输出的tensor数据指针列表，维度等于模型输出branch数
   // 推理完成后，用户可以直接解析output_tensors并使用解析后的结构化数据
+  // tensor内存来自内存池，最后一个引用释放后归还内存池，用户不应长期持有
   std::vector<std::shared_ptr<DNNTensor>> output_tensors;
 
   // 运行时时间统计指针，用于管理模型推理时间
@@ -134,8 +568,56 @@ struct DnnNodeOutput {
   // 模型输入的Roi数据指针列表，仅在模型任务为ModelRoiInferTask时有效
   // 仅传递Roi数据用于模型后处理解析，不用于实际推理
   std::shared_ptr<std::vector<hbDNNRoi>> rois;
+
+  // 本次推理请求的优先级，为Default时使用DnnNodePara中的priority
+  DnnPriorityClass priority = DnnPriorityClass::Default;
+
+  // 本次推理请求是否抢占，DnnNodePara中allow_preemption为true时有效
+  bool preempt = false;
+
+  // 推理使用的模型名，多模型模式下用于区分推理输出对应的模型
+  std::string model_name;
+
+  // 本次推理请求的截止时间，单位ns，和msg_header的时间戳使用相同的时钟（系统时间）
+  // 大于0时生效，否则使用deadline_budget_ms计算截止时间
+  int64_t deadline_ns = 0;
+
+  // 本次推理请求的截止时间预算，单位ms，截止时间为msg_header的时间戳加上预算
+  // 小于等于0时使用DnnNodePara中的deadline_budget_ms
+  int deadline_budget_ms = -1;
+
+  // 推理输出状态，非SUCCESS时output_tensors为空
+  DnnNodeOutputStatus status = DnnNodeOutputStatus::SUCCESS;
 };
 
+// 级联推理的输出，合并两级模型的推理输出
+// 基类中为第二级roi模型的推理输出，rois为规范化后实际推理使用的roi
+// 第一级模型推理失败时status为第一级模型的输出状态，不执行第二级推理
+struct DnnNodeCascadeOutput : public DnnNodeOutput {
+  // 第一级模型的推理输出
+  std::shared_ptr<DnnNodeOutput> det_output = nullptr;
+
+  // rois中每个roi对应的roi生成回调输出的roi序号，被过滤的roi不参与推理
+  std::vector<int> roi_index;
+};
+
+// 级联推理的roi生成回调，解析第一级模型的推理输出，生成第二级模型推理使用的roi
+// - 参数
+//   - [in] output 第一级模型的推理输出
+//   - [out] rois 输入图片上的roi，不需要对齐和限制在图片内
+// - 返回值
+//   - 0成功，非0时第二级推理的输出状态为INFER_FAILED
+using CascadeRoiGenCbType =
+    std::function<int(const std::shared_ptr<DnnNodeOutput> &output,
+                      std::vector<hbDNNRoi> &rois)>;
+
+// 推理请求的完成回调，推理完成、失败或者请求被丢弃时执行一次，代替PostProcess
+// 在dnn node的推理或者后处理线程中执行，不应长时间阻塞
+// - 参数
+//   - [in] output 推理输出，status为SUCCESS时output_tensors有效
+using DnnNodeRunCbType =
+    std::function<void(const std::shared_ptr<DnnNodeOutput> &output)>;
+
 }  // namespace dnn_node
 }  // namespace hobot
 #endif  // DNN_NODE_DATA_H_
@@ -15,15 +15,31 @@
 #ifndef DNN_NODE_IMPL_H_
 #define DNN_NODE_IMPL_H_
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "dnn_node/bpu_arbiter.h"
+#include "dnn_node/bpu_core_scheduler.h"
 #include "dnn_node/dnn_node_data.h"
+#include "dnn_node/flight_recorder.h"
+#include "dnn_node/infer_completion_reactor.h"
+#include "dnn_node/latency_histogram.h"
+#include "dnn_node/trace.h"
+#include "dnn_node/packed_model.h"
 #include "easy_dnn/model.h"
-#include "util/threads/threadpool.h"
+#include "util/threads/bounded_queue.h"
+#include "util/threads/pipeline_stage.h"
+#include "util/threads/work_stealing_executor.h"
+#include "std_srvs/srv/trigger.hpp"
 
 using hobot::easy_dnn::Model;
+using hobot::easy_dnn::SysMemAccounting;
+using hobot::easy_dnn::TaskStatus;
 
 namespace hobot {
 namespace dnn_node {
@@ -39,18 +55,107 @@ enum class InputType { DNN_INPUT = 0, DNN_TENSOR };
 struct DnnNodeTask {
   explicit DnnNodeTask(TaskId id) {
     task_id = id;
-    alloc_tp = std::chrono::system_clock::now();
+    alloc_tp = std::chrono::steady_clock::now();
   }
   void SetBPUCoreID(int32_t bpu_core_id) { bpuCoreId = bpu_core_id; }
   TaskId task_id = -1;
-  // 实际运行时使用的BPU核，必须为BPU_CORE_0或BPU_CORE_1
-  // 如果用户指定的是BPU_CORE_ANY，将会转成BPU_CORE_0或BPU_CORE_1
-  int32_t bpuCoreId = HB_BPU_CORE_0;
+  // 每次申请task时分配的租约号，task被watchdog回收后旧租约的释放操作无效
+  uint64_t lease = 0;
+  // 用户为task指定的BPU核，为BPU_CORE_ANY时由BpuCoreScheduler在提交推理任务时选择
+  int32_t bpuCoreId = HB_BPU_CORE_ANY;
+
+  // 申请task的时间，watchdog据此判断task是否卡住，使用steady_clock避免系统时间跳变
+  std::chrono::steady_clock::time_point alloc_tp;
+
+  // 占用task的推理请求对应的帧，由DnnNodeRunTimePara的task_mtx保护
+  std::string frame_id;
+  int64_t frame_stamp_ns = 0;
+  // 推理使用的BPU核，提交推理任务时设置，-1表示还未提交
+  std::atomic<int32_t> infer_core_id{-1};
+  // 是否占用了BpuCoreScheduler的BPU核和BPU仲裁器的名额，
+  // 推理结束或者task被watchdog回收时释放，先将标志置为false的一方负责释放
+  std::atomic<bool> core_acquired{false};
+  std::atomic<bool> arbiter_granted{false};
+};
+
+// 一次推理请求的上下文，在推理流程的各个阶段之间传递
+struct DnnNodeRunContext {
+  std::vector<std::shared_ptr<DNNInput>> dnn_inputs;
+  std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+  InputType input_type = InputType::DNN_INPUT;
+  std::shared_ptr<DnnNodeOutput> output = nullptr;
+  PostProcessCbType post_process = nullptr;
+  std::shared_ptr<std::vector<hbDNNRoi>> rois = nullptr;
+  // 用户提供的模型输出tensor，BPU直接将推理结果写入，为空时从内存池申请
+  std::vector<std::shared_ptr<DNNTensor>> output_tensors;
+  int alloctask_timeout_ms = -1;
+  int infer_timeout_ms = 20000;
+  // 同步推理时前处理失败通过Run的返回值返回，异步推理时执行后处理
+  bool is_sync_mode = false;
+
+  // 数据流标识，LatestOnly策略下用于合并同一数据流的排队请求
+  std::string stream_id;
+
+  // 截止时间，单位ns，系统时间，为0表示不限制
+  int64_t deadline_ns = 0;
+
+  // 为true表示是动态batch中合并多个推理请求的推理，截止时间为其中最早的截止时间
+  bool is_batch = false;
+
+  // 为true表示不需要推理，直接执行后处理，例如roi推理时当前帧中无roi
+  bool skip_infer = false;
+  // 申请到的推理任务
+  TaskId task_id = -1;
+  // 申请task时的task和租约号，task被watchdog回收替换后继续使用原来的task
+  std::shared_ptr<Task> task = nullptr;
+  uint64_t task_lease = 0;
+  // 申请到的task slot，用于查询task状态
+  std::shared_ptr<DnnNodeTask> node_task = nullptr;
+  // 创建请求和提交推理任务完成的单调时间，用于统计各阶段耗时
+  std::chrono::steady_clock::time_point create_tp =
+      std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point submit_done_tp;
+  // 各阶段的开始和结束时间，用于flight recorder，未经过的阶段为默认值
+  std::chrono::steady_clock::time_point preprocess_start_tp;
+  std::chrono::steady_clock::time_point alloc_done_tp;
+  std::chrono::steady_clock::time_point preprocess_done_tp;
+  std::chrono::steady_clock::time_point infer_done_tp;
+  std::chrono::steady_clock::time_point parse_done_tp;
+  // 开始处理时排队的请求数和申请到task后推理中的task数
+  int queue_depth = 0;
+  int running_task_num = 0;
+  // msg_header的时间戳，单位ns，用于关联同一帧的trace事件和统计端到端耗时
+  int64_t frame_stamp_ns = 0;
+  // 提交推理任务的时间，用于统计推理耗时和BpuCoreScheduler的服务时间，
+  // 使用steady_clock避免系统时间跳变影响统计；timespec为输出给用户的系统时间
+  std::chrono::steady_clock::time_point infer_start_tp;
+  struct timespec infer_start_timespec = {0, 0};
+  // 推理使用的BPU核，由BpuCoreScheduler选择，小于0表示没有提交推理任务
+  int32_t bpu_core_id = -1;
+  // 推理由reactor完成，输出的解析和task的释放在后处理阶段执行
+  bool finish_in_postprocess = false;
+  // 推理使用的模型和task，在申请task时确定，模型热替换时推理中的请求继续使用旧模型
+  std::shared_ptr<DnnNodeRunTimePara> rt_para = nullptr;
+  // 推理流程的返回值
+  int ret = 0;
+};
 
-  std::chrono::high_resolution_clock::time_point alloc_tp;
+using DnnNodeRunContextPtr = std::shared_ptr<DnnNodeRunContext>;
+
+// 动态batch中合并推理的一组推理请求
+struct DnnNodeBatch {
+  InputType input_type = InputType::DNN_INPUT;
+  std::vector<DnnNodeRunContextPtr> members;
+  // 收集请求的截止时间
+  std::chrono::steady_clock::time_point deadline;
+  // 推理和所有请求的后处理都已经完成，由batch_mtx_保护
+  bool done = false;
 };
 
 struct DnnNodeRunTimePara {
+  // 加载后的模型文件，多模型模式下所有模型共享，需要在task之后释放
+  std::shared_ptr<PackedModel> packed_model = nullptr;
+
   // 使用模型文件加载后的模型列表
   std::vector<Model *> models_load;
 
@@ -58,15 +163,22 @@ struct DnnNodeRunTimePara {
   Model *model_manage = nullptr;
 
   // 一个DNNNode实例只支持一种ModelTask类型
+  // 每个task slot对应的task在TaskInit中创建，推理结束后Reset复用
   std::vector<std::shared_ptr<Task>> tasks{};
 
-  // todo 20220228
-  // Add task release strategy according to task alloc_tp to
-  // avoid task abnormal leakage
+  // 为推理任务选择BPU核
+  std::shared_ptr<BpuCoreScheduler> core_scheduler = nullptr;
+
+  // 所有task共享的模型输出tensor内存池
+  std::shared_ptr<TensorPool> output_tensor_pool = nullptr;
+
+  // 占用时间过长的task由watchdog根据alloc_tp回收
   std::unordered_map<TaskId, std::shared_ptr<DnnNodeTask>> idle_tasks{};
   std::unordered_map<TaskId, std::shared_ptr<DnnNodeTask>> running_tasks{};
   std::mutex task_mtx;
   std::condition_variable task_cv;
+  // 租约号，由task_mtx保护
+  uint64_t lease_seq = 0;
 };
 
 // 运行时fps统计
@@ -83,41 +195,112 @@ struct DnnNodeRunTimeFpsStat {
 };
 
 struct ThreadPool {
-  hobot::CThreadPool msg_handle_;
+  // 非流水线模式下的异步推理线程池，可以在多个dnn node之间共享
+  std::shared_ptr<hobot::WorkStealingExecutor> msg_handle_;
   std::mutex msg_mutex_;
-  int msg_limit_count_ = 10;
+  // 等待drainer_num_减为0，析构时使用
+  std::condition_variable drainer_cv_;
+  // 非流水线模式下排队的推理请求，由msg_handle_中的线程取出并推理
+  std::shared_ptr<hobot::BoundedQueue<DnnNodeRunContextPtr>> pending_runs_;
+  // 正在处理pending_runs_的线程数，不超过msg_handle_的线程数，由msg_mutex_保护
+  int drainer_num_ = 0;
+  int drainer_limit_ = 0;
+
+  // 流水线模式下的各个阶段，析构时按照数据流向依次停止
+  std::shared_ptr<hobot::PipelineStage<DnnNodeRunContextPtr>> preprocess_stage_;
+  std::shared_ptr<hobot::PipelineStage<DnnNodeRunContextPtr>> infer_stage_;
+  std::shared_ptr<hobot::PipelineStage<DnnNodeRunContextPtr>>
+      postprocess_stage_;
+  // 流水线模式下等待BPU推理完成的reactor
+  std::shared_ptr<InferCompletionReactor> reactor_;
 };
 
 class DnnNodeImpl {
  public:
   explicit DnnNodeImpl(std::shared_ptr<DnnNodePara> &dnn_node_para_ptr);
 
+  // 多模型模式下使用已经加载的模型文件创建其他模型的实现
+  DnnNodeImpl(std::shared_ptr<DnnNodePara> &dnn_node_para_ptr,
+              const std::shared_ptr<PackedModel> &packed_model);
+
   ~DnnNodeImpl();
 
   int ModelInit();
 
+  // 初始化：加载模型、创建task和预热推理，使能async_init时在后台线程中执行
+  // 异步初始化时只返回启动结果，初始化结果通过WaitReady获取
+  int Init();
+
+  // 初始化是否完成并且成功
+  bool IsReady();
+
+  // 等待初始化完成，timeout_ms小于0时一直等待
+  // - 返回值
+  //   - 0初始化成功，超时返回DNN_NODE_NOT_READY，初始化失败返回失败码
+  int WaitReady(int timeout_ms);
+
+  // 获取初始化耗时统计
+  DnnNodeInitStat GetInitStat();
+
+  // 热替换模型，在调用线程中加载新模型，推理不受影响
+  // 校验新模型的输入输出和当前模型一致后切换，之后申请task的推理请求使用新模型，
+  // 等待旧模型上推理中的任务完成后释放旧模型
+  // - 参数
+  //   - [in] model_file 新模型文件
+  //   - [in] model_name 新模型在模型文件中的模型名，为空时使用文件中唯一的模型或者当前模型名
+  //   - [in] drain_timeout_ms 等待旧模型上推理中任务完成的超时时间
+  // - 返回值
+  //   - 0成功，失败时继续使用当前模型
+  int SwapModel(const std::string &model_file,
+                const std::string &model_name,
+                int drain_timeout_ms);
+
+  // 根据模型名获取推理使用的实现，模型名为空时返回model_name对应的实现
+  // 模型不存在时返回nullptr
+  DnnNodeImpl *GetModelImpl(const std::string &model_name);
+
+  // 保存DnnNode创建的Trigger服务，公开的dnn_node.h不依赖std_srvs
+  void AddTriggerService(
+      const rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr &service);
+
+  // 释放Trigger服务，服务回调中会访问DnnNode，需要在DnnNode析构时调用
+  void ClearTriggerServices();
+
  public:
   // 申请模型预测任务。
   // - 参数
   //   - [in] timeout_ms 申请超时时间。
   // - 返回值
   //   - 返回申请到的task id，小于0为无效id。
-  TaskId AllocTask(int timeout_ms = -1);
+  //   - [in] rt_para 申请task使用的模型，为空时使用当前模型。
+  //   - [out] lease 申请到的task的租约号，释放task时使用。
+  TaskId AllocTask(int timeout_ms = -1,
+                   std::shared_ptr<DnnNodeRunTimePara> rt_para = nullptr,
+                   uint64_t *lease = nullptr);
 
   // 释放模型预测任务。
   // - 参数
   //   - [in] task_id 需要释放的task id。
-  int ReleaseTask(const TaskId &);
+  //   - [in] rt_para 申请task使用的模型，为空时使用当前模型。
+  //   - [in] lease 申请task时的租约号，不为0且task已经被watchdog回收时不释放。
+  int ReleaseTask(const TaskId &task_id,
+                  std::shared_ptr<DnnNodeRunTimePara> rt_para = nullptr,
+                  uint64_t lease = 0);
 
   // 根据预测任务ID获取任务task。
+  // task可能被watchdog替换，持有task_mtx读取，调用者应持有返回的task直到推理结束
   // - 参数
   //   - [in] task_id 预测任务ID。
-  std::shared_ptr<Task> GetTask(const TaskId &);
+  //   - [in] rt_para 申请task使用的模型，为空时使用当前模型。
+  std::shared_ptr<Task> GetTask(
+      const TaskId &task_id,
+      std::shared_ptr<DnnNodeRunTimePara> rt_para = nullptr);
 
   int TaskInit();
 
   // 启动推理
   // is_sync_mode 预测模式，true为同步模式，false为异步模式。
+  // output_tensors 用户提供的模型输出tensor，为空时从内存池申请
   int Run(std::vector<std::shared_ptr<DNNInput>> &dnn_inputs,
           std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
           InputType input_type,
@@ -126,7 +309,26 @@ class DnnNodeImpl {
           const std::shared_ptr<std::vector<hbDNNRoi>> rois,
           const bool is_sync_mode,
           const int alloctask_timeout_ms,
-          const int infer_timeout_ms);
+          const int infer_timeout_ms,
+          const std::vector<std::shared_ptr<DNNTensor>> &output_tensors = {});
+
+  // 级联推理，使用本模型推理pyramid，由roi_gen生成roi后使用roi_impl推理pyramid上的roi
+  // 两级推理都完成后对output执行一次post_process
+  // - 参数
+  //   - [in] roi_impl 第二级模型的实现，模型task类型需要为ModelRoiInferType
+  //   - [in] pyramid 两级模型共同使用的输入图片
+  //   - [in] roi_gen roi生成回调
+  //   - [in] roi_constraint 第二级模型输入roi的约束
+  //   - 其他参数同Run接口
+  int RunCascade(DnnNodeImpl *roi_impl,
+                 const std::shared_ptr<NV12PyramidInput> &pyramid,
+                 const CascadeRoiGenCbType &roi_gen,
+                 const DnnNodeRoiConstraint &roi_constraint,
+                 const std::shared_ptr<DnnNodeCascadeOutput> &output,
+                 PostProcessCbType post_process,
+                 const bool is_sync_mode,
+                 const int alloctask_timeout_ms,
+                 const int infer_timeout_ms);
 
   // 推理实现
   int RunImpl(std::vector<std::shared_ptr<DNNInput>> dnn_inputs,
@@ -136,32 +338,94 @@ class DnnNodeImpl {
               PostProcessCbType post_process,
               const std::shared_ptr<std::vector<hbDNNRoi>> rois,
               const int alloctask_timeout_ms,
-              const int infer_timeout_ms);
+              const int infer_timeout_ms,
+              const std::vector<std::shared_ptr<DNNTensor>> &output_tensors =
+                  {});
+
+  // 推理流程的各个阶段，同步推理时在同一个线程中依次执行，
+  // 流水线模式下分别在各个阶段的线程中执行
+  // 前处理阶段：申请推理task，配置并预处理输入数据
+  // 返回true表示需要继续执行推理阶段
+  bool RunPreProcessStage(const DnnNodeRunContextPtr &ctx);
+  // 推理阶段：提交推理任务，等待推理完成并获取输出，释放推理task
+  void RunInferStage(const DnnNodeRunContextPtr &ctx);
+  // 使能completion reactor时的推理阶段：只提交推理任务
+  void SubmitInferStage(const DnnNodeRunContextPtr &ctx);
+  // 推理结束：统计输出帧率，释放推理task
+  void FinishInferStage(const DnnNodeRunContextPtr &ctx);
+  // 送入后处理阶段，后处理阶段已经停止时直接执行后处理
+  void PushPostProcessStage(const DnnNodeRunContextPtr &ctx);
+  // 推理阶段停止时丢弃等待推理的请求，释放task并以DROPPED状态输出
+  void DiscardInferStage(const DnnNodeRunContextPtr &ctx);
+  // 推理完成后释放BPU核和仲裁器名额，可以重复调用，已经被watchdog释放时不再释放
+  void ReleaseBpuResource(const DnnNodeRunContextPtr &ctx);
+  // 记录推理完成时间
+  void MarkInferDone(const DnnNodeRunContextPtr &ctx);
+  // 后处理阶段：执行用户定义的后处理
+  void RunPostProcessStage(const DnnNodeRunContextPtr &ctx);
 
   // 配置预测任务的输入数据
   // - 参数
   //   - [in] inputs 输入数据智能指针列表。
-  //   - [in] task_id 预测任务ID。
+  //   - [in] task 申请到的推理任务，使用ctx->task，不再根据task_id重新查找。
   //   - [in] rois 抠图roi数据，只对抠图检测模型有效。
   int PreProcess(std::vector<std::shared_ptr<DNNInput>> &dnn_inputs,
                  std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
                  InputType input_type,
-                 const TaskId &task_id,
+                 const std::shared_ptr<Task> &task,
                  const std::shared_ptr<std::vector<hbDNNRoi>> rois = nullptr);
 
   // 输入预处理
-  int RunProcessInput( const TaskId &task_id,
-                   InputType input_type);
+  int RunProcessInput(const std::shared_ptr<Task> &task, InputType input_type);
 
-  // 使用通过SetInputs输入给模型的数据进行推理
+  // 使用通过SetInputs输入给模型的数据进行推理，提交推理任务并等待推理完成
   // - 参数
-  //   - [in/out] node_output 推理任务输出智能。
-  //   - [in] task 推理任务。
-  //   - [in] timeout_ms 推理推理超时时间。
-  // outputs为模型输出，timeout_ms为推理超时时间
-  int RunInferTask(std::shared_ptr<DnnNodeOutput> node_output,
-               const std::shared_ptr<Task> &task,
-               const int timeout_ms = 1000);
+  //   - [in/out] ctx 推理请求上下文，推理输出保存在ctx->output中
+  int RunInferTask(const DnnNodeRunContextPtr &ctx);
+
+  // 提交推理任务，不等待推理完成
+  int SubmitInferTask(const DnnNodeRunContextPtr &ctx);
+
+  // 推理完成后获取推理输出，并统计推理耗时
+  int GetInferOutput(const DnnNodeRunContextPtr &ctx);
+
+  // 获取推理完成事件的eventfd，未使能completion reactor时返回-1
+  int GetCompletionEventFd();
+
+  // 取消排队中的异步推理请求，被取消的请求执行后处理，输出状态为CANCELED
+  // - 参数
+  //   - [in] pred 返回true表示取消对应输出的推理请求
+  // - 返回值
+  //   - 取消的推理请求数
+  int CancelPendingRuns(
+      const std::function<bool(const std::shared_ptr<DnnNodeOutput> &)> &pred);
+
+  // 获取异步推理请求准入统计
+  DnnNodeAdmissionStat GetAdmissionStat();
+
+  // 获取每个BPU核的负载统计
+  std::vector<BpuCoreStat> GetBpuCoreStat();
+
+  // 获取推理task统计，包括推理超时和被watchdog回收的task数
+  DnnNodeTaskStat GetTaskStat();
+
+  // 获取推理流程各阶段的耗时统计
+  std::vector<DnnNodeLatencyStat> GetLatencyStat();
+
+  // 清空各阶段的耗时统计，开始新的统计窗口
+  void ResetLatencyStat();
+
+  // 推理使用的模型名，多模型模式下包括其他模型
+  std::vector<std::string> GetModelNames();
+
+  // 将flight recorder中最近帧的处理记录导出到file_name，返回0成功
+  int DumpFlightRecord(const std::string &file_name);
+
+  // 获取每个task slot的状态和各队列的深度
+  DnnNodeTaskTable GetTaskTable();
+
+  // 获取dnn node统计的BPU核负载、吞吐和排队的请求数，不包括sysfs采样结果
+  DnnNodeBpuStat GetBpuStat();
 
   // 获取dnn node管理和推理使用的模型。
   Model *GetModel();
@@ -181,7 +445,36 @@ class DnnNodeImpl {
   std::shared_ptr<DnnNodeRunTimePara> dnn_rt_para_ = nullptr;
   std::shared_ptr<ThreadPool> thread_pool_ = nullptr;
 
-  hbPackedDNNHandle_t packed_dnn_handle_;
+  std::vector<rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr>
+      trigger_services_;
+
+  // 推理使用的模型名，ModelInit后有效
+  std::string model_name_;
+
+  // 依次执行ModelInit、TaskInit和预热推理，统计各阶段耗时
+  int InitImpl();
+
+  // 使用全0的输入和rt_para中的模型预热推理warmup_num次，失败不影响初始化结果
+  // 模型输入不支持预热时返回DNN_NODE_WARMUP_UNSUPPORTED
+  int Warmup(const std::shared_ptr<DnnNodeRunTimePara> &rt_para);
+
+  // 初始化完成，处理初始化完成前排队的推理请求
+  void SetInitDone(int ret);
+
+  // 异步初始化线程
+  std::shared_ptr<std::thread> init_thread_ = nullptr;
+  // 初始化是否完成，完成后init_ret_有效
+  std::atomic<bool> init_done_{false};
+  int init_ret_ = 0;
+  std::mutex init_mtx_;
+  std::condition_variable init_cv_;
+  std::chrono::steady_clock::time_point init_start_tp_;
+  DnnNodeInitStat init_stat_;
+  // 初始化完成前排队的异步推理请求，由init_mtx_保护
+  std::vector<DnnNodeRunContextPtr> not_ready_runs_;
+
+  // 多模型模式下其他模型的实现，key为模型名
+  std::unordered_map<std::string, std::shared_ptr<DnnNodeImpl>> sub_impls_;
 
   // 输入的统计
   // 例如对于订阅图片进行推理的场景，此处统计的输入帧率等于订阅到图片的帧率
@@ -197,8 +490,108 @@ class DnnNodeImpl {
   // 而对于多核模型，推理任务会同时使用两个BPU核，因此如果指定了BPU核将会推理失败。
   bool en_set_task_para_ = true;
 
-  std::mutex load_lock_;
-  int32_t core_id_ = HB_BPU_CORE_0;
+  // 配置推理任务优先级使能开关，使用默认参数推理成功后和en_set_task_para_一起设置为false
+  // X5只有一个BPU核，不配置BPU核但是配置优先级
+  bool en_set_task_priority_ = true;
+
+
+  // 根据模型task类型创建task并绑定rt_para中的模型
+  std::shared_ptr<Task> CreateTask(
+      const std::shared_ptr<DnnNodeRunTimePara> &rt_para);
+
+  // 为rt_para中的模型创建task、输出内存池和BPU核调度器
+  int RunTimeParaInit(const std::shared_ptr<DnnNodeRunTimePara> &rt_para);
+
+  // 获取当前推理使用的模型和task，模型热替换时原子切换
+  std::shared_ptr<DnnNodeRunTimePara> GetRunTimePara();
+
+  // 校验新模型的输入输出个数、数据类型、layout和shape是否和旧模型一致
+  int CheckModelCompatible(Model *old_model, Model *new_model);
+
+  // 保证同一时间只进行一次模型热替换
+  std::mutex swap_mtx_;
+
+  // 创建流水线模式下的各个阶段
+  int PipelineInit();
+
+  // 异步推理请求的排队队列，流水线模式下为前处理阶段的队列
+  hobot::BoundedQueue<DnnNodeRunContextPtr> *GetRunQueue();
+
+  // 按照准入策略将异步推理请求加入排队队列
+  int AdmitRunContext(const DnnNodeRunContextPtr &ctx);
+
+  // 非流水线模式下，唤醒线程处理排队的推理请求
+  void ScheduleDrainer();
+
+  // 动态batch推理，第一个加入batch的请求所在线程负责收集batch并推理
+  // - 参数
+  //   - [in] ctx 推理请求
+  //   - [in] wait_done 为true时等待推理和后处理完成，同步推理时使用
+  // - 返回值
+  //   - 0成功，wait_done为true时返回推理结果
+  int RunBatched(const DnnNodeRunContextPtr &ctx, bool wait_done);
+
+  // 合并batch中的输入，推理后拆分输出并执行每个请求的后处理
+  void RunBatch(const std::shared_ptr<DnnNodeBatch> &batch);
+
+  // 将batch中每个请求的输入tensor拷贝到一个batch输入tensor中
+  int BuildBatchTensorInputs(const std::shared_ptr<DnnNodeBatch> &batch,
+                             const DnnNodeRunContextPtr &batch_ctx);
+
+  // 模型的batch size，大于1时使能动态batch
+  int batch_size_ = 1;
+  std::shared_ptr<DnnNodeBatch> open_batch_ = nullptr;
+  std::mutex batch_mtx_;
+  std::condition_variable batch_cv_;
+  // DNNTensor输入合并为batch时使用的内存池
+  std::shared_ptr<TensorPool> batch_input_pool_ = nullptr;
+
+  // 丢弃未推理的请求，执行后处理输出空的结果
+  void DiscardRunContext(const DnnNodeRunContextPtr &ctx,
+                         DnnNodeOutputStatus status);
+
+  // 前处理失败，异步推理时执行后处理输出INFER_FAILED状态的空结果，保证每个推理输入都有输出
+  void OnRunFailed(const DnnNodeRunContextPtr &ctx);
+
+  DnnNodeAdmissionStat admission_stat_;
+  std::mutex admission_mtx_;
+
+  // task watchdog线程，定期回收占用时间超过task_watchdog_timeout_ms的task
+  void WatchdogLoop();
+  // 回收rt_para中占用时间过长的task，返回回收的task数
+  int ReclaimStuckTasks(const std::shared_ptr<DnnNodeRunTimePara> &rt_para);
+  std::shared_ptr<std::thread> watchdog_thread_ = nullptr;
+  bool watchdog_stop_ = false;
+  std::mutex watchdog_mtx_;
+  std::condition_variable watchdog_cv_;
+
+  DnnNodeTaskStat task_stat_;
+  std::mutex task_stat_mtx_;
+
+  // 推理流程各阶段的耗时统计
+  LatencyRecorder latency_recorder_;
+
+  // 最近帧的处理记录，在ModelInit中根据参数创建
+  std::shared_ptr<FlightRecorder> flight_recorder_ = nullptr;
+  // 记录一帧的处理过程，端到端耗时超过阈值时导出
+  void RecordFlight(
+      const DnnNodeRunContextPtr &ctx,
+      const std::chrono::steady_clock::time_point &postprocess_start_tp,
+      const std::chrono::steady_clock::time_point &postprocess_done_tp);
+  // 排队等待处理的请求数
+  int GetQueueDepth();
+
+  // 根据输出中的截止时间或者时间预算计算请求的截止时间
+  void SetRunDeadline(const DnnNodeRunContextPtr &ctx);
+
+  // 请求距离截止时间的剩余时间，单位ms，未设置截止时间时返回-1，已经超时返回0
+  int64_t GetDeadlineRemainMs(const DnnNodeRunContextPtr &ctx);
+
+  // 请求是否已经超过截止时间
+  bool IsRunExpired(const DnnNodeRunContextPtr &ctx);
+
+  // 设置请求的输出状态为EXPIRED并统计，不执行后处理
+  void MarkRunExpired(const DnnNodeRunContextPtr &ctx);
 };
 
 }  // namespace dnn_node
@@ -0,0 +1,114 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FLIGHT_RECORDER_H_
+#define FLIGHT_RECORDER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hobot {
+namespace dnn_node {
+
+// 一帧推理的处理记录
+struct FlightRecord {
+  // msg_header的时间戳，单位ns，0表示没有msg_header
+  int64_t frame_stamp_ns = 0;
+  std::string stream_id;
+  int task_id = -1;
+  int bpu_core_id = -1;
+  // DnnNodeOutputStatus
+  int status = 0;
+  int ret = 0;
+
+  // 各阶段相对于请求创建的时刻，单位us，-1表示没有经过该阶段
+  int64_t preprocess_start_us = -1;
+  int64_t alloc_done_us = -1;
+  int64_t preprocess_done_us = -1;
+  int64_t submit_done_us = -1;
+  int64_t infer_done_us = -1;
+  int64_t parse_done_us = -1;
+  int64_t postprocess_start_us = -1;
+  int64_t postprocess_done_us = -1;
+  // 从msg_header的时间戳到后处理完成的耗时，单位us，
+  // 没有msg_header时间戳时为从创建请求到后处理完成的耗时
+  int64_t end_to_end_us = -1;
+
+  // 开始处理时排队的请求数
+  int queue_depth = 0;
+  // 申请到task后推理中的task数
+  int running_task_num = 0;
+  // 输出tensor内存池中从系统申请的内存块数和等待内存块释放的次数
+  int32_t tensor_alloc_count = 0;
+  uint64_t tensor_wait_count = 0;
+};
+
+// 保存最近capacity帧的处理记录，出现耗时异常的帧时将记录导出到文件
+// 导出在后台线程中执行，不阻塞推理流程
+class FlightRecorder {
+ public:
+  // min_dump_interval_ms为两次自动导出的最小间隔
+  FlightRecorder(size_t capacity, int min_dump_interval_ms);
+  ~FlightRecorder();
+
+  FlightRecorder(const FlightRecorder &) = delete;
+  FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+  // 添加一帧的记录，超过容量时覆盖最早的记录
+  void Add(const FlightRecord &record);
+
+  // 按照时间顺序获取保存的记录
+  std::vector<FlightRecord> Snapshot();
+
+  // 在后台线程中导出当前保存的记录，距上次导出不足min_dump_interval_ms或者上次导出未完成时返回false
+  bool DumpAsync(const std::string &file_name, const std::string &title);
+
+  // 在调用线程中导出当前保存的记录，不受导出间隔限制，返回0成功
+  int Dump(const std::string &file_name, const std::string &title);
+
+ private:
+  static int WriteCsv(const std::vector<FlightRecord> &records,
+                      const std::string &file_name,
+                      const std::string &title);
+  void DumpLoop();
+
+  std::mutex records_mtx_;
+  std::vector<FlightRecord> records_;
+  size_t capacity_ = 0;
+  // 下一条记录写入的位置
+  size_t next_idx_ = 0;
+
+  int min_dump_interval_ms_ = 0;
+  std::atomic<int64_t> last_dump_ns_{0};
+
+  // 等待后台导出的记录，由dump_mtx_保护
+  std::mutex dump_mtx_;
+  std::condition_variable dump_cv_;
+  bool dump_pending_ = false;
+  bool stop_ = false;
+  std::vector<FlightRecord> dump_records_;
+  std::string dump_file_;
+  std::string dump_title_;
+  std::shared_ptr<std::thread> dump_thread_ = nullptr;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // FLIGHT_RECORDER_H_
@@ -0,0 +1,97 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef INFER_COMPLETION_REACTOR_H_
+#define INFER_COMPLETION_REACTOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "easy_dnn/task.h"
+
+namespace hobot {
+namespace dnn_node {
+
+// 推理完成的回调，参数为推理结果，0表示推理成功
+using InferCompletionCbType = std::function<void(int32_t)>;
+
+// 推理完成reactor
+// 由一个线程轮询所有已提交的BPU推理任务，推理完成后执行对应的完成回调，
+// 避免每个推理中的任务都占用一个阻塞在hbDNNWaitTaskDone中的线程
+class InferCompletionReactor {
+ public:
+  // - 参数
+  //   - [in] poll_interval_ms 一轮轮询没有任务完成时的睡眠时间，单位ms，最小为1ms
+  //   - [in] busy_poll 为true时有推理中的任务不睡眠，只让出CPU，降低唤醒延迟
+  InferCompletionReactor(int poll_interval_ms, bool busy_poll);
+
+  ~InferCompletionReactor();
+
+  // 启动reactor线程，创建eventfd
+  int Start();
+
+  // 停止reactor线程，等待所有推理中的任务完成并执行完成回调
+  void Stop();
+
+  // 添加已经提交到BPU的推理任务
+  // - 参数
+  //   - [in] task 已经调用RunInfer提交的推理任务
+  //   - [in] infer_timeout_ms 推理超时时间，单位毫秒，超时后以失败结束任务
+  //   - [in] cb 推理完成回调，在reactor线程中执行，不能阻塞，耗时的处理应转交给其他线程
+  int Submit(const std::shared_ptr<hobot::easy_dnn::Task> &task,
+             int infer_timeout_ms,
+             InferCompletionCbType cb);
+
+  // 获取推理完成事件的eventfd，每完成一个推理任务计数加1
+  int GetEventFd() const { return event_fd_; }
+
+  // 获取推理中的任务数
+  int GetInflightNum() const { return inflight_num_; }
+
+ private:
+  struct InflightTask {
+    std::shared_ptr<hobot::easy_dnn::Task> task;
+    std::chrono::steady_clock::time_point deadline;
+    InferCompletionCbType cb;
+  };
+
+  void exec_loop();
+  void Complete(InflightTask &inflight_task, int32_t code);
+
+  int poll_interval_ms_ = 1;
+  bool busy_poll_ = false;
+  int event_fd_ = -1;
+
+  // 新提交的任务，由reactor线程合并到inflight_tasks_中
+  std::list<InflightTask> submitted_tasks_;
+  std::mutex submit_mtx_;
+  std::condition_variable submit_cv_;
+
+  // 推理中的任务，只在reactor线程中访问
+  std::list<InflightTask> inflight_tasks_;
+  std::atomic<int> inflight_num_{0};
+
+  std::atomic<bool> stop_{false};
+  std::shared_ptr<std::thread> thread_ = nullptr;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // INFER_COMPLETION_REACTOR_H_
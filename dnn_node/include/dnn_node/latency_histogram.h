@@ -0,0 +1,93 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "dnn_node/dnn_node_data.h"
+
+namespace hobot {
+namespace dnn_node {
+
+// 耗时直方图，单位ns
+// 按照HDR histogram的方式分桶：每个2的幂区间等分为kSubBucketNum个桶，相对误差不超过1/kSubBucketNum
+// 记录只有原子加操作，不加锁，可以在推理流程的各个线程中同时记录
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+  // 记录一次耗时，小于0时按0记录，超过最大值时记入最后一个桶
+  void Record(int64_t value_ns);
+
+  // 计算统计窗口内的次数、平均值、分位数和最大值
+  DnnNodeLatencyStat GetStat();
+
+  // 清空统计，开始新的统计窗口
+  void Reset();
+
+ private:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBucketNum = 1 << kSubBucketBits;
+  // 最大记录约2^40ns（约18分钟）
+  static constexpr int kMaxValueBits = 40;
+  static constexpr int kBucketNum =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBucketNum;
+
+  static int BucketIndex(uint64_t value);
+  // 桶内的最大值，分位数使用桶内最大值，不会低估耗时
+  static uint64_t BucketUpperValue(int index);
+
+  std::array<std::atomic<uint64_t>, kBucketNum> counts_;
+  std::atomic<uint64_t> total_ns_{0};
+  std::atomic<uint64_t> max_ns_{0};
+};
+
+// 推理流程各阶段的耗时直方图
+class LatencyRecorder {
+ public:
+  // 记录stage阶段的一次耗时
+  void Record(DnnNodeLatencyStage stage, int64_t value_ns);
+
+  // 记录stage阶段从start到end的耗时，使用单调时钟
+  void Record(DnnNodeLatencyStage stage,
+              const std::chrono::steady_clock::time_point &start,
+              const std::chrono::steady_clock::time_point &end);
+
+  // 获取每个阶段的耗时统计，顺序和DnnNodeLatencyStage一致
+  std::vector<DnnNodeLatencyStat> GetStat();
+
+  // 清空所有阶段的统计
+  void Reset();
+
+  // 阶段名
+  static const char *GetStageName(DnnNodeLatencyStage stage);
+
+ private:
+  std::array<LatencyHistogram,
+             static_cast<size_t>(DnnNodeLatencyStage::StageNum)>
+      histograms_;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // LATENCY_HISTOGRAM_H_
@@ -0,0 +1,119 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PACKED_MODEL_H_
+#define PACKED_MODEL_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dnn/hb_dnn.h"
+
+#include "easy_dnn/model.h"
+
+namespace hobot {
+namespace dnn_node {
+
+using hobot::easy_dnn::Model;
+
+// 加载后的模型文件，一个模型文件中可能包含多个模型
+// 文件中的所有模型共享同一个hbPackedDNNHandle_t，最后一个引用释放时释放模型
+class PackedModel {
+ public:
+  ~PackedModel();
+
+  PackedModel(const PackedModel &) = delete;
+  PackedModel &operator=(const PackedModel &) = delete;
+
+  // 加载模型文件，并为文件中的每个模型创建Model
+  // - 参数
+  //   - [in] model_file 模型文件名称
+  //   - [out] packed_model 加载后的模型文件
+  //   - [in] use_mmap 为true时mmap模型文件后从内存加载
+  // - 返回值
+  //   - 0成功，失败返回hbDNN的错误码
+  static int Load(const std::string &model_file,
+                  std::shared_ptr<PackedModel> &packed_model,
+                  bool use_mmap = false);
+
+  // 从内存加载模型，内存需要在模型释放前保持有效
+  // 加载的模型引用调用者的内存，不加入模型缓存，避免其他调用者使用已经释放的内存
+  // - 参数
+  //   - [in] data size 模型数据和长度
+  //   - [out] packed_model 加载后的模型
+  static int LoadFromMemory(const void *data,
+                            int32_t size,
+                            std::shared_ptr<PackedModel> &packed_model);
+
+  // 从进程内共享的模型缓存中获取模型文件，缓存中不存在时加载并加入缓存
+  // 缓存以模型文件的长度和内容hash为key，路径不同但内容相同的模型文件也共享一次加载，
+  // 同一路径的文件被替换后重新加载。最后一个引用释放时释放模型并清理缓存
+  // - 参数同Load
+  static int Acquire(const std::string &model_file,
+                     std::shared_ptr<PackedModel> &packed_model,
+                     bool use_mmap = false);
+
+  // 获取缓存中仍在使用的模型文件数
+  static size_t GetCachedCount();
+
+  hbPackedDNNHandle_t GetHandle() const { return packed_dnn_handle_; }
+
+  const std::string &GetFile() const { return model_file_; }
+
+  // 获取模型文件中的所有模型
+  const std::vector<Model *> &GetModels() const { return models_; }
+
+  // 根据模型名获取模型，不存在时返回nullptr
+  Model *GetModel(const std::string &model_name) const;
+
+ private:
+  PackedModel() = default;
+
+  // 加载后获取模型文件中的所有模型
+  int InitModels();
+
+  // 计算数据的FNV-1a hash，hash为上一次计算的结果
+  static void HashData(const void *data, size_t size, uint64_t &hash);
+
+  // 计算文件内容的hash，失败返回false
+  static bool HashFile(const std::string &file, uint64_t &hash);
+
+  // 从缓存中获取长度和hash对应的模型，不存在时使用loader加载
+  static int AcquireCached(
+      uint64_t size,
+      uint64_t hash,
+      const std::function<int(std::shared_ptr<PackedModel> &)> &loader,
+      std::shared_ptr<PackedModel> &packed_model);
+
+  // 模型已经释放并且没有正在加载时删除缓存中的entry
+  static void PruneCached(uint64_t size, uint64_t hash);
+
+  std::string model_file_;
+  hbPackedDNNHandle_t packed_dnn_handle_ = nullptr;
+  std::vector<Model *> models_;
+  // Mmap方式加载时的文件映射
+  void *mmap_addr_ = nullptr;
+  size_t mmap_size_ = 0;
+  // 通过缓存加载时缓存的key，释放时清理缓存
+  bool cached_ = false;
+  uint64_t cache_size_ = 0;
+  uint64_t cache_hash_ = 0;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // PACKED_MODEL_H_
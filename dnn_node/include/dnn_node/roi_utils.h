@@ -0,0 +1,45 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ROI_UTILS_H_
+#define ROI_UTILS_H_
+
+#include <vector>
+
+#include "dnn/hb_dnn.h"
+
+#include "dnn_node/dnn_node_data.h"
+
+namespace hobot {
+namespace dnn_node {
+
+// 按照约束规范化roi：以中心扩展，对齐，限制在图片内并过滤宽高超出范围的roi
+// - 参数
+//   - [in] src_rois 待规范化的roi，例如第一级模型解析出的检测框
+//   - [in] img_w img_h 输入图片的宽高
+//   - [in] constraint roi约束
+//   - [out] dst_rois 规范化后的roi
+//   - [out] src_index dst_rois中每个roi在src_rois中的序号
+// - 返回值
+//   - 规范化后的roi数，图片宽高无效时返回-1
+int NormalizeRois(const std::vector<hbDNNRoi> &src_rois,
+                  int32_t img_w,
+                  int32_t img_h,
+                  const DnnNodeRoiConstraint &constraint,
+                  std::vector<hbDNNRoi> &dst_rois,
+                  std::vector<int> &src_index);
+
+}  // namespace dnn_node
+}  // namespace hobot
+#endif  // ROI_UTILS_H_
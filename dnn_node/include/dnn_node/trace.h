@@ -0,0 +1,151 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DNN_NODE_TRACE_H_
+#define DNN_NODE_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hobot {
+namespace dnn_node {
+
+// 一个trace事件，时间使用单调时钟，单位ns
+struct TraceEvent {
+  // 事件名，必须是生命周期不短于进程的字符串，例如字符串常量
+  const char *name = nullptr;
+  int64_t start_ns = 0;
+  int64_t dur_ns = 0;
+  // 关联同一帧的id，一般为msg_header的时间戳（ns），0表示不关联
+  int64_t frame_stamp_ns = 0;
+  int32_t tid = 0;
+};
+
+// 单个线程的trace事件环形缓存，只有所属线程写入，写满后覆盖最早的事件
+class TraceRing {
+ public:
+  explicit TraceRing(size_t capacity);
+
+  void Push(const TraceEvent &event);
+
+  // 拷贝缓存中的事件，拷贝期间正在写入或者被覆盖的事件会被丢弃
+  void Snapshot(std::vector<TraceEvent> &events) const;
+
+  // 所属线程是否还在运行，线程退出后缓存可以被新线程复用
+  std::atomic<bool> owned{true};
+
+ private:
+  // 缓存中的一个事件，使用seqlock检测读取期间被写入线程覆盖的事件
+  // seq为奇数表示正在写入，写入完成后为2 * (写入序号 + 1)
+  struct Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<int64_t> start_ns{0};
+    std::atomic<int64_t> dur_ns{0};
+    std::atomic<int64_t> frame_stamp_ns{0};
+    std::atomic<int32_t> tid{0};
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t capacity_ = 0;
+  size_t mask_ = 0;
+  std::atomic<uint64_t> write_idx_{0};
+};
+
+// 收集所有线程的trace事件，导出为Chrome trace event格式的json文件，
+// 可以使用chrome://tracing或者Perfetto UI（ui.perfetto.dev）打开
+// 记录事件时只写入当前线程的环形缓存，不加锁
+class TraceCollector {
+ public:
+  // 每个线程缓存的事件数
+  static constexpr size_t kRingCapacity = 4096;
+
+  static TraceCollector &Instance();
+
+  // 记录一个从start到end的事件
+  void Record(const char *name,
+              const std::chrono::steady_clock::time_point &start,
+              const std::chrono::steady_clock::time_point &end,
+              int64_t frame_stamp_ns = 0);
+
+  // 导出所有线程缓存中的事件到file_name，返回0成功
+  int DumpChromeJson(const std::string &file_name);
+
+  // 清空所有线程缓存中的事件
+  void Clear();
+
+ private:
+  TraceCollector() = default;
+
+  // 获取当前线程的环形缓存，线程第一次记录事件时注册
+  TraceRing *GetThreadRing();
+
+  std::mutex rings_mtx_;
+  std::vector<std::shared_ptr<TraceRing>> rings_;
+  // Clear之后的事件才会被导出
+  std::atomic<int64_t> clear_ns_{0};
+};
+
+// 记录作用域的耗时
+class TraceScope {
+ public:
+  explicit TraceScope(const char *name, int64_t frame_stamp_ns = 0)
+      : name_(name),
+        frame_stamp_ns_(frame_stamp_ns),
+        start_(std::chrono::steady_clock::now()) {}
+
+  ~TraceScope() {
+    TraceCollector::Instance().Record(
+        name_, start_, std::chrono::steady_clock::now(), frame_stamp_ns_);
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+ private:
+  const char *name_;
+  int64_t frame_stamp_ns_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace dnn_node
+}  // namespace hobot
+
+// 编译时定义DNN_NODE_ENABLE_TRACE才记录trace事件（cmake选项DNN_NODE_ENABLE_TRACE），
+// 否则宏展开为空，没有运行时开销。name需要是字符串常量
+// 依赖dnn_node的包中的用户代码也可以使用这些宏，打开选项时宏定义随dnn_node导出
+#define DNN_TRACE_CONCAT_IMPL(a, b) a##b
+#define DNN_TRACE_CONCAT(a, b) DNN_TRACE_CONCAT_IMPL(a, b)
+#ifdef DNN_NODE_ENABLE_TRACE
+#define DNN_TRACE_SCOPE(name, frame_stamp_ns)                    \
+  hobot::dnn_node::TraceScope DNN_TRACE_CONCAT(dnn_trace_scope_, \
+                                               __LINE__)(name, frame_stamp_ns)
+#define DNN_TRACE_EVENT(name, start, end, frame_stamp_ns) \
+  hobot::dnn_node::TraceCollector::Instance().Record(     \
+      name, start, end, frame_stamp_ns)
+#else
+#define DNN_TRACE_SCOPE(name, frame_stamp_ns) \
+  do {                                        \
+  } while (0)
+#define DNN_TRACE_EVENT(name, start, end, frame_stamp_ns) \
+  do {                                                    \
+  } while (0)
+#endif
+
+#endif  // DNN_NODE_TRACE_H_
@@ -68,6 +68,12 @@ class Model {
    */
   int32_t GetBatchInputCount();
 
+  /**
+   * Get batch size, the first dimension of the first input
+   * @return batch size
+   */
+  int32_t GetBatchSize();
+
   /**
    * Get input source
    * @param[out] input_source
@@ -51,7 +51,7 @@ class ModelInferTask : public Task {
 
   int32_t WaitInferDone(int32_t timeout) override;
 
-  void Reset();
+  void Reset() override;
 
   /**
    *  Set all inputs
@@ -75,17 +75,31 @@ class ModelInferTask : public Task {
    */
   int32_t GetOutputTensors(
       std::vector<std::shared_ptr<DNNTensor>> &output_tensors);
+
+  /**
+   * Set caller owned output tensors which the BPU writes into directly,
+   * only valid for the next inference, they are dropped in Reset.
+   * Memory of each tensor must be allocated by hbSysAlloc*Mem or have a
+   * valid physical address, and be large enough for the output branch.
+   * Properties of the tensors are overwritten with the model output properties
+   * @param[in] output_tensors
+   * @return 0 if success, return defined error code otherwise
+   */
+  int32_t SetOutputTensors(
+      std::vector<std::shared_ptr<DNNTensor>> &output_tensors);
   
   /**
    * Prepare infer input tensor output tensor,
    * @return 0 if success, return defined error code otherwise
    */
-  int32_t PrepareInferInputOutput();
+  int32_t PrepareInferInputOutput() override;
 
  private:
   std::vector<std::shared_ptr<DNNInput>> inputs_;
   std::vector<std::shared_ptr<DNNTensor>> input_tensors_;
   std::vector<std::shared_ptr<DNNTensor>> output_tensors_;
+  // output_tensors_ are set by SetOutputTensors
+  bool user_output_{false};
 };
 }  // namespace easy_dnn
 }  // namespace hobot
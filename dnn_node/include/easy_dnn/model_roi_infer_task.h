@@ -60,7 +60,7 @@ class ModelRoiInferTask : public Task {
 
   int32_t WaitInferDone(int32_t timeout) override;
 
-  void Reset();
+  void Reset() override;
 
   /**
    * Set input rois (non-required)
@@ -105,7 +105,7 @@ class ModelRoiInferTask : public Task {
    * Prepare infer input tensor output tensor,
    * @return 0 if success, return defined error code otherwise
    */
-  int32_t PrepareInferInputOutput();
+  int32_t PrepareInferInputOutput() override;
 
  private:
 
@@ -0,0 +1,157 @@
+// Copyright (c) [2024] [Horizon Robotics].
+//
+// You can use this software according to the terms and conditions of
+// the Apache v2.0.
+// You may obtain a copy of Apache v2.0. at:
+//
+//     http: //www.apache.org/licenses/LICENSE-2.0
+//
+// THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+// See Apache v2.0 for more details.
+
+#ifndef _EASY_DNN_SYS_MEM_H_
+#define _EASY_DNN_SYS_MEM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "dnn/hb_sys.h"
+
+namespace hobot {
+namespace easy_dnn {
+
+/**
+ * Where the hbSysMem is allocated from
+ */
+enum class SysMemCategory : int32_t {
+  // output tensors cached in TensorPool
+  TENSOR_POOL = 0,
+  // output tensors of tasks without tensor pool
+  TASK_OUTPUT,
+  // images converted by ImageProc
+  IMAGE_PROC,
+  // dummy inputs of model warm up
+  WARMUP,
+  // allocated by users through SysMemAccounting
+  USER,
+  CATEGORY_NUM
+};
+
+struct SysMemStat {
+  // CATEGORY_NUM for the sum of all categories
+  SysMemCategory category{SysMemCategory::CATEGORY_NUM};
+  std::string name;
+  // memory not freed yet
+  uint64_t live_bytes{0};
+  uint64_t live_count{0};
+  // max of live_bytes since start
+  uint64_t peak_bytes{0};
+  // successful allocations and frees since start
+  uint64_t alloc_count{0};
+  uint64_t alloc_bytes{0};
+  uint64_t free_count{0};
+  // allocations failed by system or rejected by budget
+  uint64_t fail_count{0};
+  uint64_t over_budget_count{0};
+  // 0 if unlimited
+  uint64_t budget_bytes{0};
+  // allocation rate since last statistics, at least 1 second
+  double alloc_count_per_sec{0};
+  double alloc_bytes_per_sec{0};
+};
+
+/**
+ * Process wide accounting of hbSysMem allocations.
+ * Every allocation is counted in a category, allocations exceeding the
+ * budget of their category or the total budget fail fast without
+ * touching the system allocator, so one user can not exhaust the CMA
+ * shared by all nodes on the board.
+ */
+class SysMemAccounting {
+ public:
+  static SysMemAccounting &Instance();
+
+  /**
+   * Allocate memory by hbSysAllocCachedMem or hbSysAllocMem
+   * @param[out] mem
+   * @param[in] size, bytes to allocate
+   * @param[in] category, category the memory is counted in
+   * @param[in] cached, allocate cached memory if true
+   * @return 0 if success, HB_DNN_OUT_OF_MEMORY if over budget,
+   *    return error code of hbSysAlloc*Mem otherwise
+   */
+  int32_t Alloc(hbSysMem *mem,
+                uint32_t size,
+                SysMemCategory category,
+                bool cached = true);
+
+  /**
+   * Free memory allocated by Alloc
+   * @param[in] mem
+   * @param[in] category, must be the same as Alloc
+   * @return return code of hbSysFreeMem
+   */
+  int32_t Free(hbSysMem *mem, SysMemCategory category);
+
+  /**
+   * Set budget of a category, or the total budget if category is
+   * CATEGORY_NUM
+   * @param[in] category
+   * @param[in] budget_bytes, 0 if unlimited
+   */
+  void SetBudget(SysMemCategory category, uint64_t budget_bytes);
+
+  /**
+   * Get statistics of each category, followed by the total
+   * @return statistics in the order of SysMemCategory
+   */
+  std::vector<SysMemStat> GetStat();
+
+  static const char *GetCategoryName(SysMemCategory category);
+
+ private:
+  SysMemAccounting();
+
+  struct Counter {
+    std::atomic<uint64_t> live_bytes{0};
+    std::atomic<uint64_t> live_count{0};
+    std::atomic<uint64_t> peak_bytes{0};
+    std::atomic<uint64_t> alloc_count{0};
+    std::atomic<uint64_t> alloc_bytes{0};
+    std::atomic<uint64_t> free_count{0};
+    std::atomic<uint64_t> fail_count{0};
+    std::atomic<uint64_t> over_budget_count{0};
+    std::atomic<uint64_t> budget_bytes{0};
+  };
+
+  static constexpr size_t kCounterNum =
+      static_cast<size_t>(SysMemCategory::CATEGORY_NUM) + 1;
+
+  // reserve size in counter, return false if over budget
+  static bool Reserve(Counter &counter, uint64_t size);
+  static void Unreserve(Counter &counter, uint64_t size);
+  static void UpdatePeak(Counter &counter, uint64_t live_bytes);
+
+  // the last one is the total
+  std::array<Counter, kCounterNum> counters_;
+
+  // snapshot for allocation rate, guarded by rate_mtx_
+  std::mutex rate_mtx_;
+  std::chrono::steady_clock::time_point rate_tp_;
+  std::array<uint64_t, kCounterNum> rate_alloc_count_{};
+  std::array<uint64_t, kCounterNum> rate_alloc_bytes_{};
+  std::array<double, kCounterNum> alloc_count_per_sec_{};
+  std::array<double, kCounterNum> alloc_bytes_per_sec_{};
+};
+
+}  // namespace easy_dnn
+}  // namespace hobot
+
+#endif  // _EASY_DNN_SYS_MEM_H_
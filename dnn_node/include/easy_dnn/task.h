@@ -35,6 +35,7 @@
 
 #include "easy_dnn/data_structure.h"
 #include "easy_dnn/model.h"
+#include "easy_dnn/tensor_pool.h"
 
 namespace hobot {
 namespace easy_dnn {
@@ -66,6 +67,12 @@ class Task {
      */
     int32_t SetCtrlParam(hbDNNInferCtrlParam &ctrl_param);
 
+    /**
+     * Set pool which output tensors are allocated from
+     * @param[in] tensor_pool, allocate from system directly if nullptr
+     */
+    void SetTensorPool(std::shared_ptr<TensorPool> const &tensor_pool);
+
     std::shared_ptr<DNNTensor> AllocateTensor(
                 hbDNNTensorProperties const &tensor_properties);
 
@@ -75,6 +82,14 @@ class Task {
      */
     virtual int32_t ProcessInput() = 0;
 
+    /**
+     * Prepare input and output tensors of the inference, output tensors
+     * may be acquired from the tensor pool and block until one is released.
+     * RunInfer prepares them itself if this is not called before
+     * @return 0 if success, return defined error code otherwise
+     */
+    virtual int32_t PrepareInferInputOutput() = 0;
+
     /**
      * Run task
      * @return 0 if success, return defined error code otherwise
@@ -88,7 +103,28 @@ class Task {
      */
     virtual int32_t WaitInferDone(int32_t timeout) = 0;
 
-    void Reset();
+    /**
+     * Poll whether task infer is done, unlike WaitInferDone the task
+     * is kept running if it is not done within timeout
+     * @param[in] timeout, timeout of ms, 0 to check without waiting
+     * @return 0 if done, HB_DNN_TIMEOUT if still running,
+     *    return defined error code otherwise
+     */
+    int32_t PollInferDone(int32_t timeout);
+
+    /**
+     * Reset task for next inference, model binding, input descriptors
+     * and output buffers are kept to make the task reusable
+     */
+    virtual void Reset();
+
+    /**
+     * Cancel the inference and release the dnn task handle,
+     * the task can be reused after Reset
+     * @return 0 if success, HB_DNN_MODEL_IS_RUNNING if the task is being
+     *    waited by another thread and can not be canceled
+     */
+    int32_t Cancel();
 
     /**
      * Set model
@@ -99,6 +135,12 @@ class Task {
 
     void SetStatus(TaskStatus const status);
 
+    /**
+     * Get task status, thread safe
+     * @return current status of the task
+     */
+    TaskStatus GetStatus();
+
     Model *model_;
     TaskStatus task_status_;
     hbDNNTaskHandle_t task_handle_;
@@ -107,6 +149,9 @@ class Task {
     std::vector<hbDNNTensor> output_dnn_tensors_;
     std::mutex release_mtx_;
     std::mutex task_status_mutex_;
+    std::shared_ptr<TensorPool> tensor_pool_;
+    // PrepareInferInputOutput is done for the current inference
+    bool infer_io_prepared_{false};
 
 };
 
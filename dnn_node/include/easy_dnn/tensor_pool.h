@@ -0,0 +1,114 @@
+// Copyright (c) [2024] [Horizon Robotics].
+//
+// You can use this software according to the terms and conditions of
+// the Apache v2.0.
+// You may obtain a copy of Apache v2.0. at:
+//
+//     http: //www.apache.org/licenses/LICENSE-2.0
+//
+// THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+// See Apache v2.0 for more details.
+
+#ifndef _EASY_DNN_TENSOR_POOL_H_
+#define _EASY_DNN_TENSOR_POOL_H_
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "dnn/hb_dnn.h"
+
+#include "easy_dnn/data_structure.h"
+
+namespace hobot {
+namespace easy_dnn {
+
+struct TensorPoolStat {
+  // buffers allocated from system, include the ones held by users
+  int32_t total_count{0};
+  // buffers cached in pool and ready to use
+  int32_t free_count{0};
+  // acquire calls which had to wait for a buffer released by users
+  uint64_t wait_count{0};
+  // acquire calls which failed since no buffer was released in time
+  uint64_t timeout_count{0};
+};
+
+/**
+ * Slab pool of hbSysMem buffers, grouped by size class.
+ * Tensors acquired from the pool give their memory back to the pool
+ * when the last reference drops, so steady-state inference does not
+ * allocate any BPU memory.
+ */
+class TensorPool {
+ public:
+  /**
+   * @param[in] default_capacity, max buffers of a size class which is not
+   *    reserved, such as roi model outputs
+   * @param[in] wait_timeout_ms, time to wait for a buffer released by users
+   *    when the size class is exhausted, wait forever if less than 0
+   */
+  TensorPool(int32_t default_capacity, int32_t wait_timeout_ms);
+
+  ~TensorPool() = default;
+
+  /**
+   * Reserve buffers for tensor properties, reserving the same size class
+   * more than once accumulates its capacity
+   * @param[in] tensor_properties
+   * @param[in] capacity, max buffers added to the size class
+   * @param[in] prealloc_count, buffers allocated immediately
+   * @return 0 if success, return defined error code otherwise
+   */
+  int32_t Reserve(hbDNNTensorProperties const &tensor_properties,
+                  int32_t capacity,
+                  int32_t prealloc_count);
+
+  /**
+   * Acquire a tensor, block if the size class is exhausted
+   * @param[in] tensor_properties
+   * @return tensor if success, nullptr otherwise
+   */
+  std::shared_ptr<DNNTensor> Acquire(
+      hbDNNTensorProperties const &tensor_properties);
+
+  TensorPoolStat GetStat();
+
+  /**
+   * Get memory size of tensor, calculated with aligned shape
+   * @param[in] tensor_properties
+   * @return memory size in bytes
+   */
+  static uint32_t GetTensorMemSize(
+      hbDNNTensorProperties const &tensor_properties);
+
+ private:
+  struct Slab {
+    std::vector<hbSysMem> free_mems;
+    int32_t capacity{0};
+    int32_t alloc_count{0};
+  };
+
+  // shared with tensor deleters, so tensors can outlive the pool
+  struct State {
+    ~State();
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::map<uint32_t, Slab> slabs;
+    TensorPoolStat stat;
+  };
+
+  int32_t default_capacity_;
+  int32_t wait_timeout_ms_;
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace easy_dnn
+}  // namespace hobot
+
+#endif  // _EASY_DNN_TENSOR_POOL_H_
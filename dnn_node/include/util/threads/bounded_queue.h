@@ -0,0 +1,177 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_COMMON_BOUNDED_QUEUE_H_
+#define SRC_COMMON_BOUNDED_QUEUE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace hobot {
+
+// blocking FIFO queue with bounded capacity
+template <typename T>
+class BoundedQueue {
+ public:
+  explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+  // push an item, wait at most timeout_ms when the queue is full,
+  // wait forever if timeout_ms < 0 and never wait if timeout_ms == 0.
+  // return false if timeout or the queue is closed
+  bool Push(T item, int timeout_ms = -1) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    auto pred = [this]() { return closed_ || queue_.size() < capacity_; };
+    if (timeout_ms < 0) {
+      not_full_.wait(lck, pred);
+    } else if (!not_full_.wait_for(
+                   lck, std::chrono::milliseconds(timeout_ms), pred)) {
+      return false;
+    }
+    if (closed_) {
+      return false;
+    }
+    queue_.push_back(std::move(item));
+    lck.unlock();
+    not_empty_.notify_one();
+    return true;
+  }
+
+  // push an item, evict the oldest item into evicted if the queue is full.
+  // return false if the queue is closed
+  bool PushEvict(T item, T &evicted) {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      if (closed_) {
+        return false;
+      }
+      if (queue_.size() >= capacity_ && !queue_.empty()) {
+        evicted = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      queue_.push_back(std::move(item));
+    }
+    not_empty_.notify_one();
+    return true;
+  }
+
+  // push an item without waiting even if the queue is full, for producers
+  // that must not block and whose item count is bounded elsewhere.
+  // return false if the queue is closed
+  bool PushForce(T item) {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      if (closed_) {
+        return false;
+      }
+      queue_.push_back(std::move(item));
+    }
+    not_empty_.notify_one();
+    return true;
+  }
+
+  // pop an item without blocking, return false if the queue is empty
+  bool TryPop(T &item) {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      if (closed_ || queue_.empty()) {
+        return false;
+      }
+      item = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    not_full_.notify_one();
+    return true;
+  }
+
+  // remove all items matching pred, removed items are appended to removed.
+  // return the number of removed items
+  template <typename Pred>
+  size_t RemoveIf(Pred pred, std::vector<T> &removed) {
+    size_t count = 0;
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      for (auto it = queue_.begin(); it != queue_.end();) {
+        if (pred(*it)) {
+          removed.push_back(std::move(*it));
+          it = queue_.erase(it);
+          count++;
+        } else {
+          ++it;
+        }
+      }
+    }
+    if (count > 0) {
+      not_full_.notify_all();
+    }
+    return count;
+  }
+
+  // pop an item, block until the queue is not empty.
+  // return false if the queue is closed
+  bool Pop(T &item) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    not_empty_.wait(lck, [this]() { return closed_ || !queue_.empty(); });
+    if (closed_) {
+      return false;
+    }
+    item = std::move(queue_.front());
+    queue_.pop_front();
+    lck.unlock();
+    not_full_.notify_one();
+    return true;
+  }
+
+  // wake up all waiting threads, the queue can not be used any more
+  void Close() {
+    std::vector<T> dropped;
+    Close(dropped);
+  }
+
+  // same as Close(), but the queued items are moved into remaining so that
+  // the owner can complete them instead of dropping them silently
+  void Close(std::vector<T> &remaining) {
+    {
+      std::lock_guard<std::mutex> lck(mtx_);
+      closed_ = true;
+      for (auto &item : queue_) {
+        remaining.push_back(std::move(item));
+      }
+      queue_.clear();
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+  size_t Size() {
+    std::lock_guard<std::mutex> lck(mtx_);
+    return queue_.size();
+  }
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  std::deque<T> queue_;
+  const size_t capacity_;
+  bool closed_ = false;
+  std::mutex mtx_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+};
+
+}  // namespace hobot
+#endif  // SRC_COMMON_BOUNDED_QUEUE_H_
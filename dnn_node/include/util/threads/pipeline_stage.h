@@ -0,0 +1,89 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_COMMON_PIPELINE_STAGE_H_
+#define SRC_COMMON_PIPELINE_STAGE_H_
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "threads/bounded_queue.h"
+
+namespace hobot {
+
+// one stage of a pipeline: a bounded input queue and a set of threads
+// running the stage handler on every item popped from the queue
+template <typename T>
+class PipelineStage {
+ public:
+  typedef std::function<void(T &)> StageHandler;
+
+  PipelineStage(size_t queue_depth, int thread_num, StageHandler handler)
+      : queue_(queue_depth), handler_(std::move(handler)) {
+    for (int i = 0; i < thread_num; ++i) {
+      threads_.emplace_back(&PipelineStage::exec_loop, this);
+    }
+  }
+
+  ~PipelineStage() {
+    std::vector<T> dropped;
+    Stop(dropped);
+  }
+
+  // close the input queue and wait for the running handlers to finish,
+  // items not handled yet are moved into remaining. Push fails afterwards
+  void Stop(std::vector<T> &remaining) {
+    queue_.Close(remaining);
+    for (auto &thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  // push an item into the stage, timeout_ms has the same meaning as
+  // BoundedQueue::Push
+  bool Push(T item, int timeout_ms = -1) {
+    return queue_.Push(std::move(item), timeout_ms);
+  }
+
+  // push an item into the stage without waiting, see BoundedQueue::PushForce
+  bool PushForce(T item) { return queue_.PushForce(std::move(item)); }
+
+  // input queue of the stage
+  BoundedQueue<T> &Queue() { return queue_; }
+
+  size_t Size() { return queue_.Size(); }
+
+  size_t Capacity() const { return queue_.Capacity(); }
+
+ private:
+  void exec_loop() {
+    T item;
+    while (queue_.Pop(item)) {
+      handler_(item);
+      item = T();
+    }
+  }
+
+  BoundedQueue<T> queue_;
+  StageHandler handler_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace hobot
+#endif  // SRC_COMMON_PIPELINE_STAGE_H_
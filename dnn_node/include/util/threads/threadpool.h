@@ -15,53 +15,128 @@
 #ifndef SRC_COMMON_THREADPOOL_H_
 #define SRC_COMMON_THREADPOOL_H_
 
-#include <atomic>
-#include <condition_variable>
-#include <functional>
-#include <list>
-#include <memory>
-#include <mutex>
-#include <set>
-#include <thread>
-#include <vector>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace hobot {
-typedef std::function<void()> TaskFunction;
-struct Task {
-  TaskFunction func;
-  explicit Task(const TaskFunction &_task) : func(_task) {}
-};
 
-class CThreadPool {
+// move-only type-erased job. callables no larger than three pointers that
+// can be moved without throwing are stored inline, larger ones on the heap.
+// unlike std::function the callable does not need to be copyable and
+// moving a job between queues never copies its captures
+class Job {
  public:
-  CThreadPool();
-  virtual ~CThreadPool();
-  void CreatThread(int threadCount);
-  // post an async task
-  void PostTask(const TaskFunction &task);
-  int GetTaskNum();
-  void ClearTask();
-  void Stop() {}
-  void Start() {}
-
- protected:
-  void exec_loop();
+  Job() = default;
+  Job(std::nullptr_t) {}  // NOLINT
+  template <typename F,
+            typename D = typename std::decay<F>::type,
+            typename = typename std::enable_if<
+                !std::is_same<D, Job>::value &&
+                !std::is_same<D, std::nullptr_t>::value>::type>
+  Job(F &&f) {  // NOLINT
+    Init<D>(std::forward<F>(f), FitsInline<D>());
+  }
+  Job(Job &&other) noexcept { MoveFrom(other); }
+  Job &operator=(Job &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+  Job &operator=(std::nullptr_t) {
+    Reset();
+    return *this;
+  }
+  Job(const Job &) = delete;
+  Job &operator=(const Job &) = delete;
+  ~Job() { Reset(); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+  void operator()() { ops_->call(&storage_); }
 
  private:
-  typedef std::list<std::shared_ptr<Task> > TaskContainer;
-  TaskContainer m_setTaskQuenes;
-  mutable std::mutex m_mutThread;
-  // a mutex for task quene operations only
-  mutable std::mutex m_mutTaskQuene;
-
-  std::condition_variable m_varCondition;
-  std::atomic<int> m_nNumRunningThreads;
-  typedef std::shared_ptr<std::thread> CThreadPtr;
-
-  std::vector<CThreadPtr> m_vecThreads;
-  std::atomic<bool> stop_;
-  // cound set the value before starting the thread pool only
-  int m_nMaxThreads = 0;
+  struct Ops {
+    void (*call)(void *storage);
+    // move the callable into the empty dst and destroy it in src
+    void (*move)(void *dst, void *src);
+    void (*destroy)(void *storage);
+  };
+
+  typedef std::aligned_storage<3 * sizeof(void *)>::type Storage;
+
+  template <typename F>
+  using FitsInline = std::integral_constant<
+      bool, sizeof(F) <= sizeof(Storage) &&
+                alignof(Storage) % alignof(F) == 0 &&
+                std::is_nothrow_move_constructible<F>::value>;
+
+  template <typename F>
+  struct InlineOps {
+    static void Call(void *s) { (*static_cast<F *>(s))(); }
+    static void Move(void *dst, void *src) {
+      F *f = static_cast<F *>(src);
+      new (dst) F(std::move(*f));
+      f->~F();
+    }
+    static void Destroy(void *s) { static_cast<F *>(s)->~F(); }
+    static const Ops ops;
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F *&Ptr(void *s) { return *static_cast<F **>(s); }
+    static void Call(void *s) { (*Ptr(s))(); }
+    static void Move(void *dst, void *src) { new (dst) F *(Ptr(src)); }
+    static void Destroy(void *s) { delete Ptr(s); }
+    static const Ops ops;
+  };
+
+  template <typename F, typename A>
+  void Init(A &&f, std::true_type) {
+    new (&storage_) F(std::forward<A>(f));
+    ops_ = &InlineOps<F>::ops;
+  }
+  template <typename F, typename A>
+  void Init(A &&f, std::false_type) {
+    new (&storage_) F *(new F(std::forward<A>(f)));
+    ops_ = &HeapOps<F>::ops;
+  }
+
+  void MoveFrom(Job &other) {
+    if (other.ops_) {
+      other.ops_->move(&storage_, &other.storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+  void Reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  const Ops *ops_ = nullptr;
+  Storage storage_;
+};
+
+template <typename F>
+const Job::Ops Job::InlineOps<F>::ops = {&Job::InlineOps<F>::Call,
+                                         &Job::InlineOps<F>::Move,
+                                         &Job::InlineOps<F>::Destroy};
+
+template <typename F>
+const Job::Ops Job::HeapOps<F>::ops = {&Job::HeapOps<F>::Call,
+                                       &Job::HeapOps<F>::Move,
+                                       &Job::HeapOps<F>::Destroy};
+
+typedef Job TaskFunction;
+struct Task {
+  TaskFunction func;
+  explicit Task(TaskFunction _task) : func(std::move(_task)) {}
 };
 }  // namespace hobot
 #endif  // SRC_COMMON_THREADPOOL_H_
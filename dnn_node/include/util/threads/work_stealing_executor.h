@@ -0,0 +1,110 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_COMMON_WORK_STEALING_EXECUTOR_H_
+#define SRC_COMMON_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "threads/mpmc_ring.h"
+#include "threads/threadpool.h"
+
+namespace hobot {
+
+struct ExecutorConfig {
+  // executor name, also the prefix of thread names
+  std::string name = "dnn_exec";
+  int thread_num = 1;
+  // cpus the workers are pinned to, worker i runs on
+  // cpu_affinity[i % size], no pinning if empty
+  std::vector<int> cpu_affinity;
+  // use SCHED_FIFO with this priority (1-99) if positive,
+  // otherwise SCHED_OTHER with nice
+  int sched_priority = 0;
+  int nice = 0;
+  // capacity of the queue for tasks posted from non-worker threads
+  size_t queue_capacity = 1024;
+};
+
+// executor with one deque per worker. tasks posted from a worker go to
+// its own deque, tasks posted from other threads go to a shared lock-free
+// queue. idle workers take from their own deque, then the shared queue,
+// then steal from the other workers. every deque is consumed from the
+// front by both its owner and thieves, so tasks keep their post order.
+class WorkStealingExecutor {
+ public:
+  explicit WorkStealingExecutor(const ExecutorConfig &config);
+  ~WorkStealingExecutor();
+
+  WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+  WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+
+  // create and configure the workers, return 0 if success
+  int Start();
+
+  // post an async task, return false if the queue is full or stopped
+  bool PostTask(TaskFunction task);
+
+  // number of tasks waiting in the queues
+  int GetTaskNum();
+
+  const ExecutorConfig &GetConfig() const { return config_; }
+
+  // get the executor shared in process by config.name, created and started
+  // with config if not exist. the executor is destroyed with its last user
+  static std::shared_ptr<WorkStealingExecutor> GetShared(
+      const ExecutorConfig &config);
+
+ private:
+  enum WorkerState { WORKER_RUNNING = 0, WORKER_PARKED = 1 };
+
+  struct Worker {
+    std::mutex deque_mtx;
+    std::deque<TaskFunction> tasks;
+
+    std::atomic<int> state{WORKER_RUNNING};
+    // park permit, set by unpark and consumed by park
+    bool permit = false;
+    std::mutex park_mtx;
+    std::condition_variable park_cv;
+    std::shared_ptr<std::thread> thread;
+  };
+
+  void exec_loop(int worker_idx);
+  // apply name, affinity and scheduling policy to the calling worker
+  void ConfigThread(int worker_idx);
+  bool TakeTask(int worker_idx, TaskFunction &task);
+  void Park(Worker &worker);
+  void Unpark(Worker &worker);
+  void WakeOne();
+
+  ExecutorConfig config_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  MpmcRing<TaskFunction> inject_queue_;
+  std::atomic<int> task_num_{0};
+  std::atomic<unsigned int> wake_idx_{0};
+  std::atomic<bool> stop_{false};
+  bool started_ = false;
+  std::mutex start_mtx_;
+};
+
+}  // namespace hobot
+#endif  // SRC_COMMON_WORK_STEALING_EXECUTOR_H_
@@ -0,0 +1,116 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/bpu_arbiter.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "dnn/hb_dnn_status.h"
+
+namespace hobot {
+namespace dnn_node {
+
+BpuArbiter &BpuArbiter::Instance() {
+  static BpuArbiter arbiter;
+  return arbiter;
+}
+
+void BpuArbiter::Configure(int max_inflight, int aging_ms) {
+  std::lock_guard<std::mutex> lk(mtx_);
+  if (configured_) {
+    if (max_inflight != max_inflight_ || aging_ms != aging_ms_) {
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "BPU arbiter is configured with max inflight %d, aging %d "
+                  "ms, new config [%d, %d] is ignored",
+                  max_inflight_,
+                  aging_ms_,
+                  max_inflight,
+                  aging_ms);
+    }
+    return;
+  }
+  configured_ = true;
+  max_inflight_ = max_inflight > 0 ? max_inflight : 1;
+  aging_ms_ = aging_ms > 0 ? aging_ms : 1;
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "BPU arbiter max inflight: %d, aging: %d ms",
+              max_inflight_,
+              aging_ms_);
+}
+
+int BpuArbiter::Acquire(DnnPriorityClass priority,
+                        bool preempt,
+                        int timeout_ms) {
+  std::unique_lock<std::mutex> lk(mtx_);
+  if (preempt || (waiters_.empty() && inflight_ < max_inflight_)) {
+    inflight_++;
+    return 0;
+  }
+
+  Waiter waiter;
+  waiter.priority = static_cast<int>(priority);
+  waiter.enqueue_tp = std::chrono::steady_clock::now();
+  waiters_.push_back(&waiter);
+  auto pred = [&waiter]() { return waiter.granted; };
+  if (timeout_ms < 0) {
+    cv_.wait(lk, pred);
+  } else if (!cv_.wait_for(lk, std::chrono::milliseconds(timeout_ms), pred)) {
+    waiters_.remove(&waiter);
+    return HB_DNN_TIMEOUT;
+  }
+  return 0;
+}
+
+void BpuArbiter::Release() {
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (inflight_ > 0) {
+      inflight_--;
+    }
+    Dispatch();
+  }
+  cv_.notify_all();
+}
+
+void BpuArbiter::Dispatch() {
+  auto tp_now = std::chrono::steady_clock::now();
+  while (inflight_ < max_inflight_ && !waiters_.empty()) {
+    // 有效优先级相同时放行最早等待的任务
+    auto selected = waiters_.end();
+    int64_t selected_priority = 0;
+    for (auto it = waiters_.begin(); it != waiters_.end(); ++it) {
+      auto waited_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           tp_now - (*it)->enqueue_tp)
+                           .count();
+      int64_t effective_priority = (*it)->priority + waited_ms / aging_ms_;
+      if (selected == waiters_.end() ||
+          effective_priority > selected_priority) {
+        selected = it;
+        selected_priority = effective_priority;
+      }
+    }
+    (*selected)->granted = true;
+    waiters_.erase(selected);
+    inflight_++;
+  }
+}
+
+void BpuArbiter::GetLoad(int &waiting, int &inflight) {
+  std::lock_guard<std::mutex> lk(mtx_);
+  waiting = static_cast<int>(waiters_.size());
+  inflight = inflight_;
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
@@ -0,0 +1,141 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/bpu_core_scheduler.h"
+
+namespace hobot {
+namespace dnn_node {
+
+BpuCoreScheduler::BpuCoreScheduler(int core_num, float ewma_alpha)
+    : ewma_alpha_(ewma_alpha) {
+  if (core_num < 1) {
+    core_num = 1;
+  }
+  if (ewma_alpha_ <= 0 || ewma_alpha_ > 1) {
+    ewma_alpha_ = 0.2;
+  }
+  cores_.resize(core_num);
+  for (int idx = 0; idx < core_num; idx++) {
+    // BPU核的id依次为HB_BPU_CORE_0, HB_BPU_CORE_1
+    cores_[idx].core_id = HB_BPU_CORE_0 << idx;
+  }
+  start_tp_ = std::chrono::steady_clock::now();
+}
+
+int BpuCoreScheduler::CoreIndex(int32_t core_id) const {
+  for (size_t idx = 0; idx < cores_.size(); idx++) {
+    if (cores_[idx].core_id == core_id) {
+      return static_cast<int>(idx);
+    }
+  }
+  return -1;
+}
+
+int32_t BpuCoreScheduler::Acquire(int32_t pinned_core_id) {
+  std::lock_guard<std::mutex> lk(mtx_);
+  int selected = CoreIndex(pinned_core_id);
+  if (selected < 0) {
+    // 没有统计数据的核使用已有的平均推理耗时，都没有时只比较推理中的任务数
+    double known_sum = 0;
+    int known_num = 0;
+    for (const auto &core : cores_) {
+      if (core.ewma_service_us > 0) {
+        known_sum += core.ewma_service_us;
+        known_num++;
+      }
+    }
+    double default_service_us = known_num > 0 ? known_sum / known_num : 1.0;
+
+    double min_expected = 0;
+    for (size_t i = 0; i < cores_.size(); i++) {
+      size_t idx = (next_idx_ + i) % cores_.size();
+      const auto &core = cores_[idx];
+      double service_us =
+          core.ewma_service_us > 0 ? core.ewma_service_us : default_service_us;
+      double expected = (core.inflight + 1) * service_us;
+      if (selected < 0 || expected < min_expected) {
+        selected = static_cast<int>(idx);
+        min_expected = expected;
+      }
+    }
+    next_idx_ = (selected + 1) % cores_.size();
+  }
+
+  auto &core = cores_[selected];
+  if (core.inflight == 0) {
+    core.busy_start = std::chrono::steady_clock::now();
+  }
+  core.inflight++;
+  core.submit_count++;
+  return core.core_id;
+}
+
+void BpuCoreScheduler::Release(int32_t core_id,
+                               int64_t service_us,
+                               bool success) {
+  std::lock_guard<std::mutex> lk(mtx_);
+  int idx = CoreIndex(core_id);
+  if (idx < 0 || cores_[idx].inflight <= 0) {
+    return;
+  }
+  auto &core = cores_[idx];
+  core.inflight--;
+  if (core.inflight == 0) {
+    core.busy_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - core.busy_start)
+                        .count();
+  }
+  if (success) {
+    core.done_count++;
+    if (core.ewma_service_us <= 0) {
+      core.ewma_service_us = static_cast<double>(service_us);
+    } else {
+      core.ewma_service_us = ewma_alpha_ * service_us +
+                             (1 - ewma_alpha_) * core.ewma_service_us;
+    }
+  } else {
+    core.fail_count++;
+  }
+}
+
+std::vector<BpuCoreStat> BpuCoreScheduler::GetStat() {
+  std::lock_guard<std::mutex> lk(mtx_);
+  auto tp_now = std::chrono::steady_clock::now();
+  auto wall_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                     tp_now - start_tp_)
+                     .count();
+  std::vector<BpuCoreStat> stats;
+  for (const auto &core : cores_) {
+    BpuCoreStat stat;
+    stat.core_id = core.core_id;
+    stat.inflight = core.inflight;
+    stat.ewma_service_ms = static_cast<float>(core.ewma_service_us / 1000.0);
+    stat.submit_count = core.submit_count;
+    stat.done_count = core.done_count;
+    stat.fail_count = core.fail_count;
+    int64_t busy_us = core.busy_us;
+    if (core.inflight > 0) {
+      busy_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                     tp_now - core.busy_start)
+                     .count();
+    }
+    stat.utilization =
+        wall_us > 0 ? static_cast<float>(busy_us) / wall_us : 0.0f;
+    stats.push_back(stat);
+  }
+  return stats;
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
@@ -0,0 +1,162 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/bpu_util_sampler.h"
+
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace hobot {
+namespace dnn_node {
+
+// 查找的最大BPU核数
+static constexpr int kMaxBpuCoreNum = 8;
+
+BpuUtilSampler::BpuUtilSampler(const std::string &sysfs_root,
+                               int interval_ms,
+                               BpuUtilSampleCbType sample_cb)
+    : sysfs_root_(sysfs_root),
+      interval_ms_(interval_ms > 0 ? interval_ms : 1000),
+      sample_cb_(sample_cb) {}
+
+BpuUtilSampler::~BpuUtilSampler() {
+  {
+    std::lock_guard<std::mutex> lk(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (sample_thread_ && sample_thread_->joinable()) {
+    sample_thread_->join();
+  }
+}
+
+int BpuUtilSampler::Start() {
+  for (int idx = 0; idx < kMaxBpuCoreNum; idx++) {
+    std::string core_dir = sysfs_root_ + "/bpu" + std::to_string(idx);
+    CoreNode core;
+    core.core_id = idx;
+    core.ratio_file = core_dir + "/ratio";
+    if (access(core.ratio_file.c_str(), R_OK) != 0) {
+      continue;
+    }
+    // devfreq节点名和平台相关，使用devfreq目录下第一个包含cur_freq的节点
+    std::string devfreq_dir = core_dir + "/devfreq";
+    DIR *dir = opendir(devfreq_dir.c_str());
+    if (dir) {
+      struct dirent *entry = nullptr;
+      while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+          continue;
+        }
+        std::string freq_file =
+            devfreq_dir + "/" + entry->d_name + "/cur_freq";
+        if (access(freq_file.c_str(), R_OK) == 0) {
+          core.freq_file = freq_file;
+          break;
+        }
+      }
+      closedir(dir);
+    }
+    cores_.push_back(core);
+  }
+
+  if (cores_.empty()) {
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "No BPU core found in %s, BPU utilization sampler is disabled",
+                sysfs_root_.c_str());
+    return -1;
+  }
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "BPU utilization sampler started, sysfs root: %s, core num: "
+              "%zu, interval: %d ms",
+              sysfs_root_.c_str(),
+              cores_.size(),
+              interval_ms_);
+  sample_thread_ =
+      std::make_shared<std::thread>(&BpuUtilSampler::SampleLoop, this);
+  return 0;
+}
+
+std::vector<BpuUtilSample> BpuUtilSampler::GetLatest() {
+  std::lock_guard<std::mutex> lk(mtx_);
+  return latest_;
+}
+
+int64_t BpuUtilSampler::ReadInt(const std::string &file) {
+  if (file.empty()) {
+    return -1;
+  }
+  FILE *fp = fopen(file.c_str(), "r");
+  if (!fp) {
+    return -1;
+  }
+  char buf[64] = {0};
+  int64_t value = -1;
+  if (fgets(buf, sizeof(buf), fp)) {
+    char *end = nullptr;
+    int64_t parsed = strtoll(buf, &end, 10);
+    if (end != buf) {
+      value = parsed;
+    }
+  }
+  fclose(fp);
+  return value;
+}
+
+std::vector<BpuUtilSample> BpuUtilSampler::Sample() {
+  std::vector<BpuUtilSample> samples;
+  for (const auto &core : cores_) {
+    BpuUtilSample sample;
+    sample.core_id = core.core_id;
+    int64_t ratio = ReadInt(core.ratio_file);
+    if (ratio >= 0) {
+      sample.utilization = static_cast<float>(ratio);
+    }
+    sample.freq_hz = ReadInt(core.freq_file);
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+void BpuUtilSampler::SampleLoop() {
+  pthread_setname_np(pthread_self(), "dnn_bpu_sample");
+  while (true) {
+    auto samples = Sample();
+    {
+      std::lock_guard<std::mutex> lk(mtx_);
+      latest_ = samples;
+    }
+    if (sample_cb_) {
+      sample_cb_(samples);
+    }
+
+    std::unique_lock<std::mutex> lk(mtx_);
+    cv_.wait_for(lk, std::chrono::milliseconds(interval_ms_), [this]() {
+      return stop_;
+    });
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
@@ -14,18 +14,91 @@
 
 #include "dnn_node/dnn_node.h"
 
+#include <future>
+#include <iomanip>
 #include <memory>
 #include <queue>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "dnn_node/bpu_util_sampler.h"
 #include "dnn_node/dnn_node_impl.h"
+#include "std_srvs/srv/trigger.hpp"
 
 namespace hobot {
 namespace dnn_node {
 
+namespace {
+// 使用完成回调代替PostProcess提交异步推理请求
+int RunWithCallback(DnnNodeImpl *impl,
+                    std::vector<std::shared_ptr<DNNInput>> &dnn_inputs,
+                    std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
+                    InputType input_type,
+                    const std::shared_ptr<DnnNodeOutput> &output,
+                    const std::shared_ptr<std::vector<hbDNNRoi>> &rois,
+                    const DnnNodeRunCbType &callback,
+                    const int alloctask_timeout_ms,
+                    const int infer_timeout_ms) {
+  return impl->Run(
+      dnn_inputs,
+      tensor_inputs,
+      input_type,
+      output,
+      [callback](std::shared_ptr<DnnNodeOutput> &out) {
+        callback(out);
+        return 0;
+      },
+      rois,
+      false,
+      alloctask_timeout_ms,
+      infer_timeout_ms);
+}
+
+// 提交异步推理请求，请求未被接收时future立即就绪
+std::future<std::shared_ptr<DnnNodeOutput>> RunWithFuture(
+    DnnNodeImpl *impl,
+    std::vector<std::shared_ptr<DNNInput>> &dnn_inputs,
+    std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
+    InputType input_type,
+    const std::shared_ptr<DnnNodeOutput> &output,
+    const std::shared_ptr<std::vector<hbDNNRoi>> &rois,
+    const int alloctask_timeout_ms,
+    const int infer_timeout_ms) {
+  auto promise =
+      std::make_shared<std::promise<std::shared_ptr<DnnNodeOutput>>>();
+  auto future = promise->get_future();
+  auto dnn_output = output ? output : std::make_shared<DnnNodeOutput>();
+  int ret = -1;
+  if (impl) {
+    ret = RunWithCallback(
+        impl,
+        dnn_inputs,
+        tensor_inputs,
+        input_type,
+        dnn_output,
+        rois,
+        [promise](const std::shared_ptr<DnnNodeOutput> &out) {
+          promise->set_value(out);
+        },
+        alloctask_timeout_ms,
+        infer_timeout_ms);
+  }
+  if (ret != 0) {
+    bool dropped = ret == DNN_NODE_RUN_QUEUE_FULL ||
+                   ret == DNN_NODE_RUN_WAIT_TIMEOUT ||
+                   ret == DNN_NODE_RUN_QUEUE_CLOSED ||
+                   ret == DNN_NODE_NOT_READY;
+    dnn_output->status = dropped ? DnnNodeOutputStatus::DROPPED
+                                 : DnnNodeOutputStatus::INFER_FAILED;
+    promise->set_value(dnn_output);
+  }
+  return future;
+}
+}  // namespace
+
 DnnNode::DnnNode(const std::string &node_name, const NodeOptions &options)
     : rclcpp::Node(node_name, options) {
   dnn_node_para_ptr_ = std::make_shared<DnnNodePara>();
@@ -40,7 +113,12 @@ DnnNode::DnnNode(const std::string &node_name,
   dnn_node_impl_ = std::make_shared<DnnNodeImpl>(dnn_node_para_ptr_);
 }
 
-DnnNode::~DnnNode() {}
+DnnNode::~DnnNode() {
+  // 先停止采样线程，采样回调中会访问dnn_node_impl_
+  bpu_sampler_ = nullptr;
+  // 服务回调中会访问node，dnn_node_impl_可能晚于node释放
+  dnn_node_impl_->ClearTriggerServices();
+}
 
 int DnnNode::Init() {
   RCLCPP_INFO(rclcpp::get_logger("dnn"), "Node init.");
@@ -83,23 +161,92 @@ int DnnNode::Init() {
     }
   }
 
-  // 2. model init
-  ret = dnn_node_impl_->ModelInit();
-  if (ret != 0) {
-    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Model init failed!");
-    return ret;
+  // 模型初始化和预热时也会申请内存，需要在初始化之前设置预算
+  if (dnn_node_para_ptr_->sys_mem_budget_mb > 0) {
+    SetSysMemBudget(
+        SysMemCategory::CATEGORY_NUM,
+        static_cast<uint64_t>(dnn_node_para_ptr_->sys_mem_budget_mb) << 20);
   }
 
-  // 3. task init
-  ret = dnn_node_impl_->TaskInit();
-  if (ret != 0) {
-    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Task init failed!");
-    return ret;
+  // 2. model init, task init and warm up
+  // 使能async_init时在后台线程中执行
+  ret = dnn_node_impl_->Init();
+
+  if (ret == 0 && dnn_node_para_ptr_->enable_latency_service) {
+    CreateLatencyService();
+  }
+  if (ret == 0 && dnn_node_para_ptr_->enable_trace_service) {
+    CreateTraceService();
+  }
+  if (ret == 0 && dnn_node_para_ptr_->enable_task_table_service) {
+    CreateTaskTableService();
+  }
+  if (ret == 0 && dnn_node_para_ptr_->enable_sys_mem_service) {
+    CreateSysMemService();
+  }
+  if (ret == 0 && dnn_node_para_ptr_->bpu_sample_interval_ms > 0) {
+    StartBpuSampler();
   }
 
   return ret;
 }
 
+void DnnNode::CreateLatencyService() {
+  auto latency_stat_srv = this->create_service<std_srvs::srv::Trigger>(
+      "~/dnn_latency_stat",
+      [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+             std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        // 每个模型每个阶段输出一行，单位us
+        std::stringstream ss;
+        ss.setf(std::ios::fixed);
+        ss.precision(1);
+        ss << "model stage count mean p50 p90 p99 p999 max (us)\n";
+        for (const auto &model_name : dnn_node_impl_->GetModelNames()) {
+          for (const auto &stat : GetLatencyStat(model_name)) {
+            ss << model_name << " "
+               << LatencyRecorder::GetStageName(stat.stage) << " "
+               << stat.count << " " << stat.mean_us << " " << stat.p50_us
+               << " " << stat.p90_us << " " << stat.p99_us << " "
+               << stat.p999_us << " " << stat.max_us << "\n";
+          }
+        }
+        response->success = true;
+        response->message = ss.str();
+      });
+  dnn_node_impl_->AddTriggerService(latency_stat_srv);
+  auto latency_reset_srv = this->create_service<std_srvs::srv::Trigger>(
+      "~/dnn_latency_reset",
+      [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+             std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        ResetLatencyStat();
+        response->success = true;
+        response->message = "latency stat reset";
+      });
+  dnn_node_impl_->AddTriggerService(latency_reset_srv);
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Latency service created: ~/dnn_latency_stat, "
+              "~/dnn_latency_reset");
+}
+
+void DnnNode::CreateTraceService() {
+#ifndef DNN_NODE_ENABLE_TRACE
+  RCLCPP_WARN(rclcpp::get_logger("dnn"),
+              "Trace is not enabled at compile time, build with cmake option "
+              "DNN_NODE_ENABLE_TRACE=ON to record trace events");
+#endif
+  auto trace_dump_srv = this->create_service<std_srvs::srv::Trigger>(
+      "~/dnn_trace_dump",
+      [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+             std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        response->success = (DumpTrace() == 0);
+        response->message = dnn_node_para_ptr_->trace_file;
+      });
+  dnn_node_impl_->AddTriggerService(trace_dump_srv);
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Trace service created: ~/dnn_trace_dump, trace file: %s",
+              dnn_node_para_ptr_->trace_file.c_str());
+}
+
 int DnnNode::PostProcess(const std::shared_ptr<DnnNodeOutput> &output) {
   if (output) {
     RCLCPP_INFO(rclcpp::get_logger("dnn"), "Post process in dnn node");
@@ -113,6 +260,279 @@ int DnnNode::GetModelInputSize(int32_t input_index, int &w, int &h) {
   return dnn_node_impl_->GetModelInputSize(input_index, w, h);
 }
 
+Model *DnnNode::GetModel(const std::string &model_name) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    return nullptr;
+  }
+  return impl->GetModel();
+}
+
+int DnnNode::GetModelInputSize(const std::string &model_name,
+                               int32_t input_index,
+                               int &w,
+                               int &h) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return -1;
+  }
+  return impl->GetModelInputSize(input_index, w, h);
+}
+
+bool DnnNode::IsReady() { return dnn_node_impl_->IsReady(); }
+
+int DnnNode::WaitReady(int timeout_ms) {
+  return dnn_node_impl_->WaitReady(timeout_ms);
+}
+
+DnnNodeInitStat DnnNode::GetInitStat() {
+  return dnn_node_impl_->GetInitStat();
+}
+
+int DnnNode::GetCompletionEventFd() {
+  return dnn_node_impl_->GetCompletionEventFd();
+}
+
+int DnnNode::CancelPendingRuns(
+    const std::function<bool(const std::shared_ptr<DnnNodeOutput> &)> &pred) {
+  return dnn_node_impl_->CancelPendingRuns(pred);
+}
+
+DnnNodeAdmissionStat DnnNode::GetAdmissionStat() {
+  return dnn_node_impl_->GetAdmissionStat();
+}
+
+std::vector<BpuCoreStat> DnnNode::GetBpuCoreStat() {
+  return dnn_node_impl_->GetBpuCoreStat();
+}
+
+DnnNodeTaskStat DnnNode::GetTaskStat() {
+  return dnn_node_impl_->GetTaskStat();
+}
+
+std::vector<DnnNodeLatencyStat> DnnNode::GetLatencyStat(
+    const std::string &model_name) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return {};
+  }
+  return impl->GetLatencyStat();
+}
+
+void DnnNode::CreateTaskTableService() {
+  auto task_table_srv = this->create_service<std_srvs::srv::Trigger>(
+      "~/dnn_task_table",
+      [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+             std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        // 每个模型输出队列深度和每个task slot一行
+        std::stringstream ss;
+        for (const auto &model_name : dnn_node_impl_->GetModelNames()) {
+          auto table = GetTaskTable(model_name);
+          ss << "model: " << table.model_name
+             << ", pending: " << table.pending_run_num
+             << ", preprocess queue: " << table.preprocess_queue_depth
+             << ", infer queue: " << table.infer_queue_depth
+             << ", postprocess queue: " << table.postprocess_queue_depth
+             << ", bpu inflight: " << table.reactor_inflight_num << "\n";
+          ss << "task_id running status bpu_core age_ms frame_id "
+                "frame_stamp\n";
+          for (const auto &task : table.tasks) {
+            ss << task.task_id << " " << (task.running ? 1 : 0) << " "
+               << task.status << " " << task.bpu_core_id << " "
+               << task.age_ms << " "
+               << (task.frame_id.empty() ? "-" : task.frame_id) << " "
+               << task.frame_stamp_ns / 1000000000LL << "."
+               << std::setw(9) << std::setfill('0')
+               << task.frame_stamp_ns % 1000000000LL << std::setfill(' ')
+               << "\n";
+          }
+        }
+        response->success = true;
+        response->message = ss.str();
+      });
+  dnn_node_impl_->AddTriggerService(task_table_srv);
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Task table service created: ~/dnn_task_table");
+}
+
+void DnnNode::CreateSysMemService() {
+  auto sys_mem_srv = this->create_service<std_srvs::srv::Trigger>(
+      "~/dnn_sys_mem_stat",
+      [this](const std::shared_ptr<std_srvs::srv::Trigger::Request>,
+             std::shared_ptr<std_srvs::srv::Trigger::Response> response) {
+        // 每个类别一行，内存单位KB，预算为0表示不限制
+        std::stringstream ss;
+        ss.setf(std::ios::fixed);
+        ss.precision(1);
+        ss << "category live_kb live_count peak_kb budget_kb alloc_count "
+              "free_count fail_count over_budget_count alloc_per_sec "
+              "alloc_kb_per_sec\n";
+        for (const auto &stat : GetSysMemStat()) {
+          ss << stat.name << " " << stat.live_bytes / 1024 << " "
+             << stat.live_count << " " << stat.peak_bytes / 1024 << " "
+             << stat.budget_bytes / 1024 << " " << stat.alloc_count << " "
+             << stat.free_count << " " << stat.fail_count << " "
+             << stat.over_budget_count << " " << stat.alloc_count_per_sec
+             << " " << stat.alloc_bytes_per_sec / 1024 << "\n";
+        }
+        response->success = true;
+        response->message = ss.str();
+      });
+  dnn_node_impl_->AddTriggerService(sys_mem_srv);
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Sys mem service created: ~/dnn_sys_mem_stat");
+}
+
+void DnnNode::StartBpuSampler() {
+  if (dnn_node_para_ptr_->enable_bpu_stat_publisher) {
+    bpu_stat_pub_ =
+        this->create_publisher<std_msgs::msg::String>("~/dnn_bpu_stat", 10);
+  }
+  bpu_sampler_ = std::make_shared<BpuUtilSampler>(
+      dnn_node_para_ptr_->bpu_sysfs_root,
+      dnn_node_para_ptr_->bpu_sample_interval_ms,
+      [this](const std::vector<BpuUtilSample> &samples) {
+        OnBpuSample(samples);
+      });
+  if (bpu_sampler_->Start() != 0) {
+    bpu_sampler_ = nullptr;
+    bpu_stat_pub_ = nullptr;
+  }
+}
+
+void DnnNode::OnBpuSample(const std::vector<BpuUtilSample> &samples) {
+  auto stat = dnn_node_impl_->GetBpuStat();
+  stat.samples = samples;
+
+  // 所有读取成功的BPU核都低于阈值时认为BPU空闲
+  bool bpu_idle = false;
+  for (const auto &sample : samples) {
+    if (sample.utilization < 0) {
+      continue;
+    }
+    if (sample.utilization >= dnn_node_para_ptr_->bpu_idle_threshold) {
+      bpu_idle = false;
+      break;
+    }
+    bpu_idle = true;
+  }
+  auto admission_stat = dnn_node_impl_->GetAdmissionStat();
+  uint64_t drop_count = admission_stat.rejected + admission_stat.wait_timeout +
+                        admission_stat.dropped_oldest + admission_stat.expired;
+  bool backlog = stat.queue_depth > 0 || drop_count > last_drop_count_;
+  last_drop_count_ = drop_count;
+  stat.cpu_bound = bpu_idle && backlog;
+  cpu_bound_ = stat.cpu_bound;
+
+  std::stringstream ss;
+  ss.setf(std::ios::fixed);
+  ss.precision(1);
+  for (const auto &sample : stat.samples) {
+    ss << "bpu" << sample.core_id << " util: " << sample.utilization
+       << "% freq: " << sample.freq_hz << " Hz; ";
+  }
+  for (const auto &core_stat : stat.core_stats) {
+    ss << "core " << core_stat.core_id << " inflight: " << core_stat.inflight
+       << " node util: " << core_stat.utilization * 100 << "%; ";
+  }
+  ss << "input fps: " << stat.input_fps << " output fps: " << stat.output_fps
+     << " queue depth: " << stat.queue_depth
+     << " cpu bound: " << (stat.cpu_bound ? 1 : 0);
+
+  if (stat.cpu_bound) {
+    // 持续CPU瓶颈时限制告警频率
+    auto tp_now = std::chrono::steady_clock::now();
+    if (tp_now - last_cpu_bound_warn_tp_ > std::chrono::seconds(10)) {
+      last_cpu_bound_warn_tp_ = tp_now;
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "BPU is idle while requests are queued or dropped, the node "
+                  "is CPU bound and more task_num will not help. %s",
+                  ss.str().c_str());
+    }
+  }
+  if (bpu_stat_pub_) {
+    std_msgs::msg::String msg;
+    msg.data = ss.str();
+    bpu_stat_pub_->publish(msg);
+  }
+}
+
+DnnNodeBpuStat DnnNode::GetBpuStat() {
+  auto stat = dnn_node_impl_->GetBpuStat();
+  if (bpu_sampler_) {
+    stat.samples = bpu_sampler_->GetLatest();
+  }
+  stat.cpu_bound = cpu_bound_;
+  return stat;
+}
+
+std::vector<SysMemStat> DnnNode::GetSysMemStat() {
+  return hobot::easy_dnn::SysMemAccounting::Instance().GetStat();
+}
+
+void DnnNode::SetSysMemBudget(SysMemCategory category,
+                              uint64_t budget_bytes) {
+  hobot::easy_dnn::SysMemAccounting::Instance().SetBudget(category,
+                                                          budget_bytes);
+}
+
+DnnNodeTaskTable DnnNode::GetTaskTable(const std::string &model_name) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return DnnNodeTaskTable();
+  }
+  return impl->GetTaskTable();
+}
+
+int DnnNode::DumpTrace(const std::string &file_name) {
+  return TraceCollector::Instance().DumpChromeJson(
+      file_name.empty() ? dnn_node_para_ptr_->trace_file : file_name);
+}
+
+int DnnNode::DumpFlightRecord(const std::string &file_name,
+                              const std::string &model_name) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return -1;
+  }
+  return impl->DumpFlightRecord(file_name);
+}
+
+void DnnNode::ResetLatencyStat() {
+  for (const auto &model_name : dnn_node_impl_->GetModelNames()) {
+    auto impl = dnn_node_impl_->GetModelImpl(model_name);
+    if (impl) {
+      impl->ResetLatencyStat();
+    }
+  }
+}
+
+int DnnNode::SwapModel(const std::string &model_file,
+                       const std::string &file_model_name,
+                       const std::string &model_name,
+                       int drain_timeout_ms) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return -1;
+  }
+  return impl->SwapModel(model_file, file_model_name, drain_timeout_ms);
+}
+
 int DnnNode::Run(std::vector<std::shared_ptr<DNNInput>> &dnn_inputs,
                  const std::shared_ptr<DnnNodeOutput> &output,
                  const std::shared_ptr<std::vector<hbDNNRoi>> rois,
@@ -152,5 +572,230 @@ int DnnNode::Run(std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
       infer_timeout_ms);
 }
 
+int DnnNode::Run(std::vector<std::shared_ptr<DNNInput>> &dnn_inputs,
+                 const std::vector<std::shared_ptr<DNNTensor>> &output_tensors,
+                 const std::shared_ptr<DnnNodeOutput> &output,
+                 const bool is_sync_mode,
+                 const int alloctask_timeout_ms,
+                 const int infer_timeout_ms) {
+  std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+  InputType input_type = InputType::DNN_INPUT;
+  return dnn_node_impl_->Run(
+      dnn_inputs,
+      tensor_inputs,
+      input_type,
+      output,
+      std::bind(&DnnNode::PostProcess, this, std::placeholders::_1),
+      nullptr,
+      is_sync_mode,
+      alloctask_timeout_ms,
+      infer_timeout_ms,
+      output_tensors);
+}
+
+int DnnNode::Run(std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
+                 const std::vector<std::shared_ptr<DNNTensor>> &output_tensors,
+                 const std::shared_ptr<DnnNodeOutput> &output,
+                 const bool is_sync_mode,
+                 const int alloctask_timeout_ms,
+                 const int infer_timeout_ms) {
+  std::vector<std::shared_ptr<DNNInput>> dnn_inputs;
+  InputType input_type = InputType::DNN_TENSOR;
+  return dnn_node_impl_->Run(
+      dnn_inputs,
+      tensor_inputs,
+      input_type,
+      output,
+      std::bind(&DnnNode::PostProcess, this, std::placeholders::_1),
+      nullptr,
+      is_sync_mode,
+      alloctask_timeout_ms,
+      infer_timeout_ms,
+      output_tensors);
+}
+
+int DnnNode::Run(const std::string &model_name,
+                 std::vector<std::shared_ptr<DNNInput>> &dnn_inputs,
+                 const std::shared_ptr<DnnNodeOutput> &output,
+                 const std::shared_ptr<std::vector<hbDNNRoi>> rois,
+                 const bool is_sync_mode,
+                 const int alloctask_timeout_ms,
+                 const int infer_timeout_ms) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return -1;
+  }
+  std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+  InputType input_type = InputType::DNN_INPUT;
+  return impl->Run(
+      dnn_inputs,
+      tensor_inputs,
+      input_type,
+      output,
+      std::bind(&DnnNode::PostProcess, this, std::placeholders::_1),
+      rois,
+      is_sync_mode,
+      alloctask_timeout_ms,
+      infer_timeout_ms);
+}
+
+int DnnNode::Run(const std::string &model_name,
+                 std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
+                 const std::shared_ptr<DnnNodeOutput> &output,
+                 const bool is_sync_mode,
+                 const int alloctask_timeout_ms,
+                 const int infer_timeout_ms) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return -1;
+  }
+  std::vector<std::shared_ptr<DNNInput>> dnn_inputs;
+  InputType input_type = InputType::DNN_TENSOR;
+  return impl->Run(
+      dnn_inputs,
+      tensor_inputs,
+      input_type,
+      output,
+      std::bind(&DnnNode::PostProcess, this, std::placeholders::_1),
+      nullptr,
+      is_sync_mode,
+      alloctask_timeout_ms,
+      infer_timeout_ms);
+}
+
+std::future<std::shared_ptr<DnnNodeOutput>> DnnNode::RunAsync(
+    std::vector<std::shared_ptr<DNNInput>> &inputs,
+    const std::shared_ptr<DnnNodeOutput> &output,
+    const std::shared_ptr<std::vector<hbDNNRoi>> rois,
+    const std::string &model_name,
+    const int alloctask_timeout_ms,
+    const int infer_timeout_ms) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+  }
+  std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+  return RunWithFuture(impl,
+                       inputs,
+                       tensor_inputs,
+                       InputType::DNN_INPUT,
+                       output,
+                       rois,
+                       alloctask_timeout_ms,
+                       infer_timeout_ms);
+}
+
+std::future<std::shared_ptr<DnnNodeOutput>> DnnNode::RunAsync(
+    std::vector<std::shared_ptr<DNNTensor>> &inputs,
+    const std::shared_ptr<DnnNodeOutput> &output,
+    const std::string &model_name,
+    const int alloctask_timeout_ms,
+    const int infer_timeout_ms) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s is not managed by dnn node",
+                 model_name.c_str());
+  }
+  std::vector<std::shared_ptr<DNNInput>> dnn_inputs;
+  return RunWithFuture(impl,
+                       dnn_inputs,
+                       inputs,
+                       InputType::DNN_TENSOR,
+                       output,
+                       nullptr,
+                       alloctask_timeout_ms,
+                       infer_timeout_ms);
+}
+
+int DnnNode::RunAsync(std::vector<std::shared_ptr<DNNInput>> &inputs,
+                      const DnnNodeRunCbType &callback,
+                      const std::shared_ptr<DnnNodeOutput> &output,
+                      const std::shared_ptr<std::vector<hbDNNRoi>> rois,
+                      const std::string &model_name,
+                      const int alloctask_timeout_ms,
+                      const int infer_timeout_ms) {
+  auto impl = dnn_node_impl_->GetModelImpl(model_name);
+  if (!impl || !callback) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Invalid callback or model: %s is not managed by dnn node",
+                 model_name.c_str());
+    return -1;
+  }
+  std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+  return RunWithCallback(impl,
+                         inputs,
+                         tensor_inputs,
+                         InputType::DNN_INPUT,
+                         output,
+                         rois,
+                         callback,
+                         alloctask_timeout_ms,
+                         infer_timeout_ms);
+}
+
+std::vector<std::future<std::shared_ptr<DnnNodeOutput>>> DnnNode::RunBatch(
+    std::vector<std::vector<std::shared_ptr<DNNInput>>> &inputs_list,
+    const std::vector<std::shared_ptr<DnnNodeOutput>> &outputs,
+    const std::string &model_name,
+    const int alloctask_timeout_ms,
+    const int infer_timeout_ms) {
+  if (!outputs.empty() && outputs.size() != inputs_list.size()) {
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "RunBatch outputs size %zu is not equal to inputs size %zu",
+                outputs.size(),
+                inputs_list.size());
+  }
+  std::vector<std::future<std::shared_ptr<DnnNodeOutput>>> futures;
+  futures.reserve(inputs_list.size());
+  for (size_t idx = 0; idx < inputs_list.size(); idx++) {
+    futures.push_back(RunAsync(inputs_list[idx],
+                               idx < outputs.size() ? outputs[idx] : nullptr,
+                               nullptr,
+                               model_name,
+                               alloctask_timeout_ms,
+                               infer_timeout_ms));
+  }
+  return futures;
+}
+
+int DnnNode::RunCascade(const std::string &det_model_name,
+                        const std::string &roi_model_name,
+                        const std::shared_ptr<NV12PyramidInput> &pyramid,
+                        const CascadeRoiGenCbType &roi_gen,
+                        const std::shared_ptr<DnnNodeCascadeOutput> &output,
+                        const DnnNodeRoiConstraint &roi_constraint,
+                        const bool is_sync_mode,
+                        const int alloctask_timeout_ms,
+                        const int infer_timeout_ms) {
+  auto det_impl = dnn_node_impl_->GetModelImpl(det_model_name);
+  auto roi_impl = dnn_node_impl_->GetModelImpl(roi_model_name);
+  if (!det_impl || !roi_impl) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s or %s is not managed by dnn node",
+                 det_model_name.c_str(),
+                 roi_model_name.c_str());
+    return -1;
+  }
+  return det_impl->RunCascade(
+      roi_impl,
+      pyramid,
+      roi_gen,
+      roi_constraint,
+      output,
+      std::bind(&DnnNode::PostProcess, this, std::placeholders::_1),
+      is_sync_mode,
+      alloctask_timeout_ms,
+      infer_timeout_ms);
+}
+
 }  // namespace dnn_node
 }  // namespace hobot
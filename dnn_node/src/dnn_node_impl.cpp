@@ -14,18 +14,50 @@
 
 #include "dnn_node/dnn_node_impl.h"
 
+#include <pthread.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
 #include <memory>
 #include <queue>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "dnn_node/roi_utils.h"
 #include "rclcpp/rclcpp.hpp"
 
 namespace hobot {
 namespace dnn_node {
 
+static DnnNodeRunContextPtr CreateRunContext(
+    const std::string &model_name,
+    const std::vector<std::shared_ptr<DNNInput>> &inputs,
+    const std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
+    InputType input_type,
+    const std::shared_ptr<DnnNodeOutput> &output,
+    const PostProcessCbType &post_process,
+    const std::shared_ptr<std::vector<hbDNNRoi>> &rois,
+    const int alloctask_timeout_ms,
+    const int infer_timeout_ms) {
+  auto ctx = std::make_shared<DnnNodeRunContext>();
+  ctx->dnn_inputs = inputs;
+  ctx->tensor_inputs = tensor_inputs;
+  ctx->input_type = input_type;
+  // 没有传入，创建DnnNodeOutput，用于存储模型推理输出
+  ctx->output = output ? output : std::make_shared<DnnNodeOutput>();
+  ctx->output->model_name = model_name;
+  ctx->post_process = post_process;
+  ctx->rois = rois;
+  ctx->alloctask_timeout_ms = alloctask_timeout_ms;
+  ctx->infer_timeout_ms = infer_timeout_ms;
+  return ctx;
+}
+
 bool DnnNodeRunTimeFpsStat::Update() {
   std::unique_lock<std::mutex> lk(frame_stat_mtx);
   if (!last_frame_tp) {
@@ -59,12 +91,72 @@ DnnNodeImpl::DnnNodeImpl(std::shared_ptr<DnnNodePara> &dnn_node_para_ptr) {
   thread_pool_ = std::make_shared<ThreadPool>();
 }
 
+DnnNodeImpl::DnnNodeImpl(std::shared_ptr<DnnNodePara> &dnn_node_para_ptr,
+                         const std::shared_ptr<PackedModel> &packed_model)
+    : DnnNodeImpl(dnn_node_para_ptr) {
+  dnn_rt_para_->packed_model = packed_model;
+}
+
 DnnNodeImpl::~DnnNodeImpl() {
-  if (!dnn_rt_para_) {
-    std::unique_lock<std::mutex> lk(load_lock_);
-    dnn_rt_para_->models_load.clear();
-    hbDNNRelease(packed_dnn_handle_);
+  if (init_thread_ && init_thread_->joinable()) {
+    init_thread_->join();
+  }
+  if (watchdog_thread_) {
+    {
+      std::lock_guard<std::mutex> lk(watchdog_mtx_);
+      watchdog_stop_ = true;
+    }
+    watchdog_cv_.notify_all();
+    watchdog_thread_->join();
+  }
+  if (thread_pool_) {
+    // 停止时未处理的推理请求以DROPPED状态输出，保证每个请求的回调都执行一次
+    std::vector<DnnNodeRunContextPtr> remaining;
+    if (thread_pool_->pending_runs_) {
+      thread_pool_->pending_runs_->Close(remaining);
+      {
+        // 线程池可能被共享，等待处理当前dnn node推理请求的线程退出
+        std::unique_lock<std::mutex> lock(thread_pool_->msg_mutex_);
+        thread_pool_->drainer_cv_.wait(
+            lock, [this]() { return thread_pool_->drainer_num_ == 0; });
+      }
+      for (auto &ctx : remaining) {
+        DiscardRunContext(ctx, DnnNodeOutputStatus::DROPPED);
+      }
+      remaining.clear();
+    }
+    // 按照数据流向停止流水线，前一阶段的线程退出后再停止后一阶段
+    if (thread_pool_->preprocess_stage_) {
+      thread_pool_->preprocess_stage_->Stop(remaining);
+      for (auto &ctx : remaining) {
+        DiscardRunContext(ctx, DnnNodeOutputStatus::DROPPED);
+      }
+      remaining.clear();
+    }
+    if (thread_pool_->infer_stage_) {
+      thread_pool_->infer_stage_->Stop(remaining);
+      for (auto &ctx : remaining) {
+        DiscardInferStage(ctx);
+      }
+      remaining.clear();
+    }
+    if (thread_pool_->reactor_) {
+      thread_pool_->reactor_->Stop();
+    }
+    if (thread_pool_->postprocess_stage_) {
+      // 已经完成推理的请求在当前线程中执行后处理
+      thread_pool_->postprocess_stage_->Stop(remaining);
+      for (auto &ctx : remaining) {
+        RunPostProcessStage(ctx);
+      }
+      remaining.clear();
+    }
+    thread_pool_->preprocess_stage_.reset();
+    thread_pool_->infer_stage_.reset();
+    thread_pool_->postprocess_stage_.reset();
   }
+  // 先停止其他模型的推理，模型文件在最后一个引用释放时释放
+  sub_impls_.clear();
 }
 
 int DnnNodeImpl::ModelInit() {
@@ -74,10 +166,21 @@ int DnnNodeImpl::ModelInit() {
     return -1;
   }
 
+  if (!flight_recorder_ && dnn_node_para_ptr_->flight_recorder_frame_num > 0) {
+    flight_recorder_ = std::make_shared<FlightRecorder>(
+        dnn_node_para_ptr_->flight_recorder_frame_num,
+        dnn_node_para_ptr_->flight_recorder_dump_interval_ms);
+  }
+
   // 1. 加载模型hbm文件，一个hbm中可能包含多个模型
+  // 多模型模式下其他模型的实现使用已经加载的模型文件
   int ret = 0;
-  ret = LoadModels(dnn_rt_para_->models_load,
-                   dnn_node_para_ptr_->model_file);
+  if (dnn_rt_para_->packed_model) {
+    dnn_rt_para_->models_load = dnn_rt_para_->packed_model->GetModels();
+  } else {
+    ret = LoadModels(dnn_rt_para_->models_load,
+                     dnn_node_para_ptr_->model_file);
+  }
   if (0 != ret) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"),
                  "Load model: %s fail, ret: %d",
@@ -125,6 +228,8 @@ int DnnNodeImpl::ModelInit() {
     return -1;
   }
 
+  model_name_ = dnn_rt_para_->model_manage->GetName();
+
   // 3. 查询模型的输入信息
   for (int idx = 0; idx < dnn_rt_para_->model_manage->GetInputCount(); idx++) {
     hbDNNTensorProperties properties;
@@ -143,40 +248,495 @@ int DnnNodeImpl::ModelInit() {
   GetModel()->PrintModelInfo(ss);
   RCLCPP_INFO(
     rclcpp::get_logger("dnn"), "%s", ss.str().c_str());
+
+  // 5. 多模型模式，使用同一个模型文件初始化其他模型
+  for (const auto &sub_model : dnn_node_para_ptr_->sub_models) {
+    if (sub_model.model_name == model_name_ ||
+        sub_impls_.find(sub_model.model_name) != sub_impls_.end()) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Duplicated model name: %s in sub_models",
+                   sub_model.model_name.c_str());
+      return -1;
+    }
+    auto sub_para = std::make_shared<DnnNodePara>(*dnn_node_para_ptr_);
+    sub_para->model_name = sub_model.model_name;
+    sub_para->model_task_type = sub_model.model_task_type;
+    sub_para->task_num = sub_model.task_num;
+    sub_para->bpu_core_ids = sub_model.bpu_core_ids;
+    sub_para->sub_models.clear();
+    auto sub_impl = std::make_shared<DnnNodeImpl>(
+        sub_para, dnn_rt_para_->packed_model);
+    ret = sub_impl->ModelInit();
+    if (ret != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Sub model: %s init fail, ret: %d",
+                   sub_model.model_name.c_str(),
+                   ret);
+      return ret;
+    }
+    sub_impls_[sub_model.model_name] = sub_impl;
+  }
   return 0;
 }
 
-int DnnNodeImpl::LoadModels(std::vector<Model *> &models,
-                               const std::string &model_file) {
-  const char *file{model_file.c_str()};
-  int ret = 0;
-  //第一步加载模型
-  ret = hbDNNInitializeFromFiles(&packed_dnn_handle_, static_cast<const char **>(&file), 1);
+DnnNodeImpl *DnnNodeImpl::GetModelImpl(const std::string &model_name) {
+  if (!init_done_.load(std::memory_order_acquire)) {
+    // 初始化完成前其他模型还未创建，只能使用model_name对应的模型
+    if (model_name.empty() || model_name == dnn_node_para_ptr_->model_name) {
+      return this;
+    }
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "Model: %s is not ready",
+                model_name.c_str());
+    return nullptr;
+  }
+  if (model_name.empty() || model_name == model_name_) {
+    return this;
+  }
+  auto sub_impl = sub_impls_.find(model_name);
+  if (sub_impl == sub_impls_.end()) {
+    return nullptr;
+  }
+  return sub_impl->second.get();
+}
+
+void DnnNodeImpl::AddTriggerService(
+    const rclcpp::Service<std_srvs::srv::Trigger>::SharedPtr &service) {
+  trigger_services_.push_back(service);
+}
+
+void DnnNodeImpl::ClearTriggerServices() { trigger_services_.clear(); }
+
+int DnnNodeImpl::Init() {
+  init_start_tp_ = std::chrono::steady_clock::now();
+  if (!dnn_node_para_ptr_->async_init) {
+    int ret = InitImpl();
+    SetInitDone(ret);
+    return ret;
+  }
+  RCLCPP_INFO(rclcpp::get_logger("dnn"), "Start async init.");
+  init_thread_ = std::make_shared<std::thread>([this]() {
+    pthread_setname_np(pthread_self(), "dnn_init");
+    SetInitDone(InitImpl());
+  });
+  return 0;
+}
+
+int DnnNodeImpl::InitImpl() {
+  auto tp_start = std::chrono::steady_clock::now();
+  int ret = ModelInit();
   if (ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Model init failed!");
     return ret;
   }
+  auto tp_loaded = std::chrono::steady_clock::now();
 
-  // 第二步获取模型名称
-  const char **model_names;
-  int32_t model_count = 0;
-  ret = hbDNNGetModelNameList(&model_names, &model_count, packed_dnn_handle_);
+  ret = TaskInit();
   if (ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Task init failed!");
     return ret;
   }
+  auto tp_task_inited = std::chrono::steady_clock::now();
+
+  // 预热失败不影响初始化结果，记录在初始化统计中
+  int warmup_ret = Warmup(dnn_rt_para_);
+  for (auto &sub_impl : sub_impls_) {
+    int sub_warmup_ret =
+        sub_impl.second->Warmup(sub_impl.second->dnn_rt_para_);
+    {
+      std::lock_guard<std::mutex> lk(sub_impl.second->init_mtx_);
+      sub_impl.second->init_stat_.warmup_ret = sub_warmup_ret;
+    }
+    if (warmup_ret == 0) {
+      warmup_ret = sub_warmup_ret;
+    }
+  }
+  auto tp_warmed_up = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lk(init_mtx_);
+  init_stat_.warmup_ret = warmup_ret;
+  init_stat_.load_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           tp_loaded - tp_start)
+                           .count();
+  init_stat_.task_init_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(tp_task_inited -
+                                                            tp_loaded)
+          .count();
+  init_stat_.warmup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             tp_warmed_up - tp_task_inited)
+                             .count();
+  return 0;
+}
 
-  // 第三步获取dnn_handle
-  {
-    for (int32_t i{0}; i < model_count; i++) {
-      hbDNNHandle_t dnn_handle{nullptr};
-      ret = hbDNNGetModelHandle(&dnn_handle, packed_dnn_handle_, model_names[i]);
+int DnnNodeImpl::Warmup(const std::shared_ptr<DnnNodeRunTimePara> &rt_para) {
+  int warmup_num = dnn_node_para_ptr_->warmup_num;
+  auto model = rt_para->model_manage;
+  if (warmup_num <= 0 || !model) {
+    return 0;
+  }
+
+  // 输入全部为图片时使用pyramid输入，全部为tensor时使用tensor输入
+  int input_count = model->GetInputCount();
+  std::vector<hbDNNTensorProperties> input_properties(input_count);
+  int image_input_count = 0;
+  for (int i = 0; i < input_count; i++) {
+    model->GetInputTensorProperties(input_properties[i], i);
+    if (input_properties[i].tensorType <= HB_DNN_IMG_TYPE_NV12_SEPARATE) {
+      image_input_count++;
+    }
+  }
+  bool is_roi_task =
+      dnn_node_para_ptr_->model_task_type == ModelTaskType::ModelRoiInferType;
+  if ((image_input_count != 0 && image_input_count != input_count) ||
+      (is_roi_task && image_input_count == 0)) {
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "Model: %s inputs are not supported by warm up, skip it",
+                model_name_.c_str());
+    return DNN_NODE_WARMUP_UNSUPPORTED;
+  }
+
+  std::vector<std::shared_ptr<DNNInput>> dnn_inputs;
+  std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+  std::shared_ptr<std::vector<hbDNNRoi>> rois = nullptr;
+  // 预热输入的内存，按照WARMUP类别统计，预热结束后释放
+  std::vector<hbSysMem> input_mems;
+  int ret = 0;
+  for (int i = 0; i < input_count && ret == 0; i++) {
+    hbSysMem mem;
+    if (image_input_count == 0) {
+      ret = SysMemAccounting::Instance().Alloc(
+          &mem,
+          TensorPool::GetTensorMemSize(input_properties[i]),
+          SysMemCategory::WARMUP);
       if (ret != 0) {
-        return ret;
+        break;
+      }
+      input_mems.push_back(mem);
+      auto tensor = std::make_shared<DNNTensor>();
+      tensor->properties = input_properties[i];
+      tensor->sysMem[0] = mem;
+      tensor_inputs.push_back(tensor);
+    } else {
+      // nv12图片的layout为NCHW
+      int w = input_properties[i].validShape.dimensionSize[3];
+      int h = input_properties[i].validShape.dimensionSize[2];
+      int stride = (w + 15) & ~15;
+      ret = SysMemAccounting::Instance().Alloc(
+          &mem, stride * h * 3 / 2, SysMemCategory::WARMUP);
+      if (ret != 0) {
+        break;
+      }
+      input_mems.push_back(mem);
+      auto pyramid = std::make_shared<NV12PyramidInput>();
+      pyramid->width = w;
+      pyramid->height = h;
+      pyramid->y_stride = stride;
+      pyramid->uv_stride = stride;
+      pyramid->y_phy_addr = mem.phyAddr;
+      pyramid->y_vir_addr = mem.virAddr;
+      pyramid->uv_phy_addr = mem.phyAddr + stride * h;
+      pyramid->uv_vir_addr =
+          reinterpret_cast<uint8_t *>(mem.virAddr) + stride * h;
+      // batch模型的pyramid输入按照输入branch排列，每个样本使用同一个输入
+      int batch_size = is_roi_task ? 1 : std::max(model->GetBatchSize(), 1);
+      for (int sample = 0; sample < batch_size; sample++) {
+        dnn_inputs.push_back(pyramid);
+      }
+      if (is_roi_task && !rois) {
+        rois = std::make_shared<std::vector<hbDNNRoi>>();
+        rois->push_back({0, 0, w - 1, h - 1});
+      }
+    }
+    memset(mem.virAddr, 0, mem.memSize);
+    hbSysFlushMem(&mem, HB_SYS_MEM_CACHE_CLEAN);
+  }
+
+  InputType input_type =
+      image_input_count == 0 ? InputType::DNN_TENSOR : InputType::DNN_INPUT;
+  // 不经过动态batch，直接使用rt_para中的模型推理
+  for (int i = 0; i < warmup_num && ret == 0; i++) {
+    auto ctx = CreateRunContext(model_name_,
+                                dnn_inputs,
+                                tensor_inputs,
+                                input_type,
+                                nullptr,
+                                nullptr,
+                                rois,
+                                -1,
+                                20000);
+    ctx->rt_para = rt_para;
+    if (RunPreProcessStage(ctx)) {
+      RunInferStage(ctx);
+    }
+    ret = ctx->ret;
+    if (ret == 0 && ctx->output->status != DnnNodeOutputStatus::SUCCESS) {
+      ret = -1;
+    }
+  }
+  for (auto &mem : input_mems) {
+    SysMemAccounting::Instance().Free(&mem, SysMemCategory::WARMUP);
+  }
+  if (ret != 0) {
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "Model: %s warm up failed, ret: %d",
+                model_name_.c_str(),
+                ret);
+    return ret;
+  }
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Model: %s warm up %d times done",
+              model_name_.c_str(),
+              warmup_num);
+  return 0;
+}
+
+void DnnNodeImpl::SetInitDone(int ret) {
+  std::vector<DnnNodeRunContextPtr> queued_ctxs;
+  {
+    std::lock_guard<std::mutex> lk(init_mtx_);
+    init_ret_ = ret;
+    init_stat_.done = true;
+    init_stat_.ret = ret;
+    init_stat_.ready_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - init_start_tp_)
+            .count();
+    queued_ctxs.swap(not_ready_runs_);
+    init_done_.store(true, std::memory_order_release);
+  }
+  init_cv_.notify_all();
+  if (ret == 0) {
+    RCLCPP_INFO(rclcpp::get_logger("dnn"),
+                "Model: %s is ready, time to ready: %ld ms (load: %ld ms, "
+                "task init: %ld ms, warm up: %ld ms, warm up ret: %d)",
+                model_name_.c_str(),
+                static_cast<long>(init_stat_.ready_ms),
+                static_cast<long>(init_stat_.load_ms),
+                static_cast<long>(init_stat_.task_init_ms),
+                static_cast<long>(init_stat_.warmup_ms),
+                init_stat_.warmup_ret);
+  }
+  for (auto &sub_impl : sub_impls_) {
+    sub_impl.second->init_start_tp_ = init_start_tp_;
+    sub_impl.second->SetInitDone(ret);
+  }
+
+  for (auto &ctx : queued_ctxs) {
+    if (ret != 0) {
+      DiscardRunContext(ctx, DnnNodeOutputStatus::INFER_FAILED);
+      continue;
+    }
+    ctx->output->model_name = model_name_;
+    int admit_ret = AdmitRunContext(ctx);
+    if (admit_ret == DNN_NODE_RUN_QUEUE_FULL ||
+        admit_ret == DNN_NODE_RUN_WAIT_TIMEOUT) {
+      // 排队时Run已经返回成功，保证每个推理请求都有输出
+      DiscardRunContext(ctx, DnnNodeOutputStatus::DROPPED);
+    }
+  }
+}
+
+bool DnnNodeImpl::IsReady() {
+  return init_done_.load(std::memory_order_acquire) && init_ret_ == 0;
+}
+
+int DnnNodeImpl::WaitReady(int timeout_ms) {
+  std::unique_lock<std::mutex> lk(init_mtx_);
+  auto pred = [this]() { return init_done_.load(); };
+  if (timeout_ms < 0) {
+    init_cv_.wait(lk, pred);
+  } else if (!init_cv_.wait_for(
+                 lk, std::chrono::milliseconds(timeout_ms), pred)) {
+    return DNN_NODE_NOT_READY;
+  }
+  return init_ret_;
+}
+
+DnnNodeInitStat DnnNodeImpl::GetInitStat() {
+  std::lock_guard<std::mutex> lk(init_mtx_);
+  return init_stat_;
+}
+
+std::shared_ptr<DnnNodeRunTimePara> DnnNodeImpl::GetRunTimePara() {
+  return std::atomic_load(&dnn_rt_para_);
+}
+
+int DnnNodeImpl::CheckModelCompatible(Model *old_model, Model *new_model) {
+  auto same_properties = [](const hbDNNTensorProperties &lhs,
+                            const hbDNNTensorProperties &rhs) {
+    if (lhs.tensorType != rhs.tensorType ||
+        lhs.tensorLayout != rhs.tensorLayout ||
+        lhs.validShape.numDimensions != rhs.validShape.numDimensions) {
+      return false;
+    }
+    for (int i = 0; i < lhs.validShape.numDimensions; i++) {
+      if (lhs.validShape.dimensionSize[i] != rhs.validShape.dimensionSize[i]) {
+        return false;
       }
-      Model* model = new Model(dnn_handle, model_names[i]);
-      models.push_back(model);
     }
+    return true;
+  };
+
+  if (old_model->GetInputCount() != new_model->GetInputCount() ||
+      old_model->GetOutputCount() != new_model->GetOutputCount()) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s has %d inputs and %d outputs, but model: %s has "
+                 "%d inputs and %d outputs",
+                 new_model->GetName().c_str(),
+                 new_model->GetInputCount(),
+                 new_model->GetOutputCount(),
+                 old_model->GetName().c_str(),
+                 old_model->GetInputCount(),
+                 old_model->GetOutputCount());
+    return -1;
+  }
+  // 量化参数可以不同，后处理从输出tensor的properties中获取
+  for (int idx = 0; idx < old_model->GetInputCount(); idx++) {
+    hbDNNTensorProperties old_properties, new_properties;
+    old_model->GetInputTensorProperties(old_properties, idx);
+    new_model->GetInputTensorProperties(new_properties, idx);
+    if (!same_properties(old_properties, new_properties)) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Input %d of model: %s is not compatible",
+                   idx,
+                   new_model->GetName().c_str());
+      return -1;
+    }
+  }
+  for (int idx = 0; idx < old_model->GetOutputCount(); idx++) {
+    hbDNNTensorProperties old_properties, new_properties;
+    old_model->GetOutputTensorProperties(old_properties, idx);
+    new_model->GetOutputTensorProperties(new_properties, idx);
+    if (!same_properties(old_properties, new_properties)) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Output %d of model: %s is not compatible",
+                   idx,
+                   new_model->GetName().c_str());
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int DnnNodeImpl::SwapModel(const std::string &model_file,
+                           const std::string &model_name,
+                           int drain_timeout_ms) {
+  if (!IsReady()) {
+    return DNN_NODE_NOT_READY;
+  }
+  // 同一时间只能进行一次替换
+  std::lock_guard<std::mutex> swap_lk(swap_mtx_);
+  auto old_rt_para = GetRunTimePara();
+  auto new_rt_para = std::make_shared<DnnNodeRunTimePara>();
+  auto tp_start = std::chrono::steady_clock::now();
+
+  // 1. 加载模型文件，推理继续使用旧模型
+  int ret = PackedModel::Acquire(
+      model_file,
+      new_rt_para->packed_model,
+      dnn_node_para_ptr_->model_load_mode == ModelLoadMode::Mmap);
+  if (ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Load model: %s for swap fail, ret: %d",
+                 model_file.c_str(),
+                 ret);
+    return ret;
+  }
+  new_rt_para->models_load = new_rt_para->packed_model->GetModels();
+  if (model_name.empty() && new_rt_para->models_load.size() == 1) {
+    new_rt_para->model_manage = new_rt_para->models_load.at(0);
+  } else {
+    new_rt_para->model_manage = new_rt_para->packed_model->GetModel(
+        model_name.empty() ? model_name_ : model_name);
+  }
+  if (!new_rt_para->model_manage) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Find model: %s in %s for swap fail!",
+                 model_name.empty() ? model_name_.c_str() : model_name.c_str(),
+                 model_file.c_str());
+    return -1;
+  }
+
+  // 2. 校验模型输入输出，保证前后处理不需要修改
+  ret = CheckModelCompatible(old_rt_para->model_manage,
+                             new_rt_para->model_manage);
+  if (ret != 0) {
+    return ret;
+  }
+
+  // 3. 创建task并预热
+  ret = RunTimeParaInit(new_rt_para);
+  if (ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Init tasks of model: %s for swap fail, ret: %d",
+                 model_file.c_str(),
+                 ret);
+    return ret;
+  }
+  ret = Warmup(new_rt_para);
+  if (ret == DNN_NODE_WARMUP_UNSUPPORTED) {
+    ret = 0;
+  } else if (ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Warm up model: %s for swap fail, ret: %d, keep the old model",
+                 model_file.c_str(),
+                 ret);
+    return ret;
+  }
+
+  // 4. 切换，之后申请task的推理请求使用新模型
+  std::atomic_store(&dnn_rt_para_, new_rt_para);
+
+  // 5. 等待旧模型上推理中的任务完成，最后一个引用释放时释放旧模型
+  bool drained = false;
+  {
+    std::unique_lock<std::mutex> lg(old_rt_para->task_mtx);
+    drained = old_rt_para->task_cv.wait_for(
+        lg, std::chrono::milliseconds(drain_timeout_ms), [&old_rt_para]() {
+          return old_rt_para->running_tasks.empty();
+        });
+  }
+  if (!drained) {
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "Running tasks of the old model are not finished in %d ms, "
+                "it will be released after they finish",
+                drain_timeout_ms);
   }
+  old_rt_para.reset();
 
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Model: %s is swapped to %s in %s, cost: %ld ms",
+              model_name_.c_str(),
+              new_rt_para->model_manage->GetName().c_str(),
+              new_rt_para->packed_model->GetFile().c_str(),
+              static_cast<long>(
+                  std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now() - tp_start)
+                      .count()));
+  return 0;
+}
+
+int DnnNodeImpl::LoadModels(std::vector<Model *> &models,
+                               const std::string &model_file) {
+  int ret = 0;
+  switch (dnn_node_para_ptr_->model_load_mode) {
+    case ModelLoadMode::File:
+      ret = PackedModel::Acquire(model_file, dnn_rt_para_->packed_model);
+      break;
+    case ModelLoadMode::Mmap:
+      ret = PackedModel::Acquire(model_file, dnn_rt_para_->packed_model, true);
+      break;
+    case ModelLoadMode::Memory:
+      // 模型引用调用者的内存，不在node之间共享
+      ret = PackedModel::LoadFromMemory(dnn_node_para_ptr_->model_data,
+                                        dnn_node_para_ptr_->model_data_size,
+                                        dnn_rt_para_->packed_model);
+      break;
+  }
+  if (ret != 0) {
+    return ret;
+  }
+  models = dnn_rt_para_->packed_model->GetModels();
   return ret;
 }
 
@@ -200,79 +760,214 @@ int DnnNodeImpl::TaskInit() {
     return -1;
   }
 
-  // 1. 为每个模型创建task
-  // 此处只创建空的task，AllocTask才真正创建task，ReleaseTask时释放task
-  // 原因是目前一个task不支持多次预测，即每次预测都要申请一个新的task
-  // todo 20220305 需要easy dnn支持task复用
-  dnn_rt_para_->tasks.resize(dnn_node_para_ptr_->task_num);
+  // 1. 创建task、输出内存池和BPU核调度器
+  int ret = RunTimeParaInit(dnn_rt_para_);
+  if (ret != 0) {
+    return ret;
+  }
 
-  // 2. 创建idle running task
-  {
-    int task_num = dnn_rt_para_->tasks.size();
-    auto bpu_core_id = HB_BPU_CORE_0;
-    std::unique_lock<std::mutex> lg(dnn_rt_para_->task_mtx);
-    if (static_cast<int>(dnn_node_para_ptr_->bpu_core_ids.size()) == task_num) {
-      // 用户指定了BPU核
-      for (int idx = 0; idx < task_num; idx++) {
-        auto node_task = std::make_shared<DnnNodeTask>(idx);
-        if (dnn_node_para_ptr_->bpu_core_ids.at(idx) !=
-            HB_BPU_CORE_ANY) {
-          // 指定的是BPU 0或1
-          node_task->SetBPUCoreID(dnn_node_para_ptr_->bpu_core_ids.at(idx));
-          dnn_rt_para_->idle_tasks[node_task->task_id] = node_task;
-        } else {
-          // 指定的是BPU_CORE_ANY，选择BPU 0或1
-          node_task->SetBPUCoreID(bpu_core_id);
-          dnn_rt_para_->idle_tasks[node_task->task_id] = node_task;
-          if (idx == task_num - 1) {
-            break;
-          }
-          // 更新bpu_core_id，保证每个task交替使用不同的BPU核
-          if (HB_BPU_CORE_0 == bpu_core_id) {
-            bpu_core_id = HB_BPU_CORE_1;
-          } else if (HB_BPU_CORE_1 == bpu_core_id) {
-            bpu_core_id = HB_BPU_CORE_0;
-          } else {
-            bpu_core_id = HB_BPU_CORE_0;
-          }
-        }
-      }
+  // 动态batch
+  if (dnn_node_para_ptr_->enable_dynamic_batch) {
+    int batch_size = dnn_rt_para_->model_manage->GetBatchSize();
+    if (ModelTaskType::ModelInferType != dnn_node_para_ptr_->model_task_type ||
+        dnn_node_para_ptr_->enable_pipeline || batch_size <= 1) {
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Dynamic batch is only supported by batch model (batch size "
+                  "%d) of ModelInferType without pipeline, disable it",
+                  batch_size);
     } else {
-      // 没有指定BPU核，为每个task指定初始BPU核
-      for (int idx = 0; idx < task_num; idx++) {
-        auto node_task = std::make_shared<DnnNodeTask>(idx);
-        node_task->SetBPUCoreID(bpu_core_id);
-        dnn_rt_para_->idle_tasks[node_task->task_id] = node_task;
-        if (idx == task_num - 1) {
-          break;
-        }
-        // 更新bpu_core_id，保证每个task交替使用不同的BPU核
-        if (HB_BPU_CORE_0 == bpu_core_id) {
-          bpu_core_id = HB_BPU_CORE_1;
-        } else if (HB_BPU_CORE_1 == bpu_core_id) {
-          bpu_core_id = HB_BPU_CORE_0;
-        } else {
-          bpu_core_id = HB_BPU_CORE_0;
-        }
+      batch_size_ = batch_size;
+      int pool_size = dnn_node_para_ptr_->output_tensor_pool_size;
+      if (pool_size <= 0) {
+        pool_size = 2 * dnn_node_para_ptr_->task_num;
       }
+      batch_input_pool_ = std::make_shared<TensorPool>(
+          pool_size, dnn_node_para_ptr_->output_tensor_pool_timeout_ms);
+      RCLCPP_INFO(rclcpp::get_logger("dnn"),
+                  "Dynamic batch enabled, batch size: %d, max wait: %d ms",
+                  batch_size_,
+                  dnn_node_para_ptr_->batch_max_wait_ms);
     }
   }
 
-  thread_pool_->msg_handle_.CreatThread(dnn_node_para_ptr_->task_num);
+  if (dnn_node_para_ptr_->enable_bpu_arbiter) {
+    BpuArbiter::Instance().Configure(
+        dnn_node_para_ptr_->bpu_arbiter_max_inflight,
+        dnn_node_para_ptr_->bpu_arbiter_aging_ms);
+  }
+
+  if (dnn_node_para_ptr_->enable_pipeline) {
+    ret = PipelineInit();
+    if (ret != 0) {
+      return ret;
+    }
+  } else {
+    if (dnn_node_para_ptr_->msg_limit_count < 1) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Invalid msg_limit_count: %d, should be positive",
+                   dnn_node_para_ptr_->msg_limit_count);
+      return -1;
+    }
+    thread_pool_->pending_runs_ =
+        std::make_shared<hobot::BoundedQueue<DnnNodeRunContextPtr>>(
+            dnn_node_para_ptr_->msg_limit_count);
+    thread_pool_->drainer_limit_ = dnn_node_para_ptr_->task_num;
+
+    hobot::ExecutorConfig executor_config;
+    executor_config.name = dnn_node_para_ptr_->executor_name;
+    executor_config.thread_num = dnn_node_para_ptr_->executor_thread_num;
+    if (executor_config.thread_num <= 0) {
+      executor_config.thread_num = dnn_node_para_ptr_->task_num;
+    }
+    executor_config.cpu_affinity = dnn_node_para_ptr_->executor_cpu_affinity;
+    executor_config.sched_priority =
+        dnn_node_para_ptr_->executor_sched_priority;
+    executor_config.nice = dnn_node_para_ptr_->executor_nice;
+    if (dnn_node_para_ptr_->executor_shared) {
+      thread_pool_->msg_handle_ =
+          hobot::WorkStealingExecutor::GetShared(executor_config);
+    } else {
+      thread_pool_->msg_handle_ =
+          std::make_shared<hobot::WorkStealingExecutor>(executor_config);
+      thread_pool_->msg_handle_->Start();
+    }
+    if (!thread_pool_->msg_handle_) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Create executor [%s] failed",
+                   executor_config.name.c_str());
+      return -1;
+    }
+  }
   RCLCPP_INFO(rclcpp::get_logger("dnn"),
               "Set task_num [%d]",
               dnn_node_para_ptr_->task_num);
 
+  if (dnn_node_para_ptr_->task_watchdog_timeout_ms > 0) {
+    if (dnn_node_para_ptr_->task_watchdog_interval_ms <= 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Invalid task_watchdog_interval_ms: %d, should be positive",
+                   dnn_node_para_ptr_->task_watchdog_interval_ms);
+      return -1;
+    }
+    watchdog_thread_ =
+        std::make_shared<std::thread>(&DnnNodeImpl::WatchdogLoop, this);
+  }
+
+  for (auto &sub_impl : sub_impls_) {
+    ret = sub_impl.second->TaskInit();
+    if (ret != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Sub model: %s task init fail, ret: %d",
+                   sub_impl.first.c_str(),
+                   ret);
+      return ret;
+    }
+  }
+
+  return 0;
+}
+
+int DnnNodeImpl::RunTimeParaInit(
+    const std::shared_ptr<DnnNodeRunTimePara> &rt_para) {
+  // 1. 为每个task slot创建task
+  // task只在初始化时创建一次，ReleaseTask时Reset后复用，
+  // 保留模型绑定、输入描述和输出内存，避免每次推理重新创建task
+  rt_para->tasks.resize(dnn_node_para_ptr_->task_num);
+  for (auto &task : rt_para->tasks) {
+    task = CreateTask(rt_para);
+    if (!task) {
+      return -1;
+    }
+  }
+
+  // 2. 创建模型输出tensor内存池，稳态推理时不再申请BPU内存
+  int pool_size = dnn_node_para_ptr_->output_tensor_pool_size;
+  if (pool_size <= 0) {
+    pool_size = 2 * dnn_node_para_ptr_->task_num;
+  }
+  rt_para->output_tensor_pool = std::make_shared<TensorPool>(
+      pool_size, dnn_node_para_ptr_->output_tensor_pool_timeout_ms);
+  if (ModelTaskType::ModelInferType == dnn_node_para_ptr_->model_task_type) {
+    // 输出size固定，按照task_num预申请内存
+    // roi模型的输出size和roi数量相关，在推理时按需申请
+    auto model = rt_para->model_manage;
+    for (int idx = 0; idx < model->GetOutputCount(); idx++) {
+      hbDNNTensorProperties properties;
+      model->GetOutputTensorProperties(properties, idx);
+      int ret = rt_para->output_tensor_pool->Reserve(
+          properties, pool_size, dnn_node_para_ptr_->task_num);
+      if (ret != 0) {
+        RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                     "Reserve output tensor pool fail, ret[%d]", ret);
+        return ret;
+      }
+    }
+  }
+  for (auto &task : rt_para->tasks) {
+    task->SetTensorPool(rt_para->output_tensor_pool);
+  }
+
+  // 3. 创建idle running task
+  {
+    int task_num = rt_para->tasks.size();
+    std::unique_lock<std::mutex> lg(rt_para->task_mtx);
+    for (int idx = 0; idx < task_num; idx++) {
+      auto node_task = std::make_shared<DnnNodeTask>(idx);
+      if (static_cast<int>(dnn_node_para_ptr_->bpu_core_ids.size()) ==
+          task_num) {
+        // 用户指定了BPU核
+        node_task->SetBPUCoreID(dnn_node_para_ptr_->bpu_core_ids.at(idx));
+      }
+      rt_para->idle_tasks[node_task->task_id] = node_task;
+    }
+  }
+
+  // 4. 创建BPU核调度器，X5只有一个BPU核，不配置task参数，只统计负载
+#ifdef PLATFORM_X5
+  en_set_task_para_ = false;
+#endif
+  rt_para->core_scheduler =
+      std::make_shared<BpuCoreScheduler>(en_set_task_para_ ? 2 : 1);
+
   return 0;
 }
 
+std::shared_ptr<Task> DnnNodeImpl::CreateTask(
+    const std::shared_ptr<DnnNodeRunTimePara> &rt_para) {
+  std::shared_ptr<Task> task = nullptr;
+  // 根据模型类型选择接口创建task,为task添加model
+  int ret = 0;
+  if (ModelTaskType::ModelInferType == dnn_node_para_ptr_->model_task_type) {
+    auto infer_task = std::make_shared<ModelInferTask>();
+    ret = infer_task->SetModel(rt_para->model_manage);
+    task = infer_task;
+  } else if (ModelTaskType::ModelRoiInferType ==
+             dnn_node_para_ptr_->model_task_type) {
+    auto infer_task = std::make_shared<ModelRoiInferTask>();
+    ret = infer_task->SetModel(rt_para->model_manage);
+    task = infer_task;
+  } else {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Invalid model task type [%d]",
+                 static_cast<int>(dnn_node_para_ptr_->model_task_type));
+    return nullptr;
+  }
+
+  if (ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Task set model fail, ret[%d]", ret);
+    return nullptr;
+  }
+  return task;
+}
+
 int DnnNodeImpl::PreProcess(
     std::vector<std::shared_ptr<DNNInput>> &inputs,
     std::vector<std::shared_ptr<DNNTensor>> &tensor_inputs,
     InputType input_type,
-    const TaskId &task_id,
+    const std::shared_ptr<Task> &task,
     const std::shared_ptr<std::vector<hbDNNRoi>> rois) {
-  if (task_id < 0 || !dnn_node_para_ptr_) {
+  if (!task || !dnn_node_para_ptr_) {
     return -1;
   }
   uint32_t ret = 0;
@@ -284,7 +979,7 @@ int DnnNodeImpl::PreProcess(
     }
 
     std::shared_ptr<ModelRoiInferTask> infer_task =
-        std::dynamic_pointer_cast<ModelRoiInferTask>(GetTask(task_id));
+        std::dynamic_pointer_cast<ModelRoiInferTask>(task);
     if (!infer_task) {
       RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid infer task");
       return -1;
@@ -314,7 +1009,7 @@ int DnnNodeImpl::PreProcess(
              dnn_node_para_ptr_->model_task_type) {
 
     std::shared_ptr<ModelInferTask> infer_task =
-        std::dynamic_pointer_cast<ModelInferTask>(GetTask(task_id));
+        std::dynamic_pointer_cast<ModelInferTask>(task);
         
     if (!infer_task) {
       RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid infer task");
@@ -338,11 +1033,14 @@ int DnnNodeImpl::PreProcess(
   return ret;
 }
 
-int DnnNodeImpl::RunProcessInput(const TaskId &task_id,
-                   InputType input_type) {
-  auto task = std::dynamic_pointer_cast<Task>(GetTask(task_id));
-
-  int ret = 0;
+int DnnNodeImpl::RunProcessInput(const std::shared_ptr<Task> &task,
+                                 InputType input_type) {
+  if (!task) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid infer task");
+    return -1;
+  }
+
+  int ret = 0;
   if (input_type == InputType::DNN_INPUT) {
     ret = task->ProcessInput();
     if (ret != 0) {
@@ -354,19 +1052,104 @@ int DnnNodeImpl::RunProcessInput(const TaskId &task_id,
   return 0;
 }
 
-int DnnNodeImpl::RunInferTask(std::shared_ptr<DnnNodeOutput> node_output,
-                          const std::shared_ptr<Task> &node_task,
-                          const int timeout_ms) {
-  if (!dnn_node_para_ptr_ || !node_output || !node_task) {
+int DnnNodeImpl::RunInferTask(const DnnNodeRunContextPtr &ctx) {
+  int ret = SubmitInferTask(ctx);
+  if (ret != 0) {
+    return ret;
+  }
+
+  ret = ctx->task->WaitInferDone(ctx->infer_timeout_ms);
+  if (ret != 0) {
+    RCLCPP_ERROR(
+        rclcpp::get_logger("dnn"), "Failed to wait infer done, ret[%d]", ret);
+    return ret;
+  }
+
+  return GetInferOutput(ctx);
+}
+
+int DnnNodeImpl::SubmitInferTask(const DnnNodeRunContextPtr &ctx) {
+  auto task = ctx->task;
+  if (!dnn_node_para_ptr_ || !ctx->output || !task) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid node task\n");
     return -1;
   }
+  auto submit_start_tp = std::chrono::steady_clock::now();
 
-  auto tp_now = std::chrono::system_clock::now();
-  struct timespec timespec_now = {0, 0};
-  clock_gettime(CLOCK_REALTIME, &timespec_now);
+  // 选择期望完成时间最短的BPU核，用户指定了BPU核时使用指定的BPU核
+  int32_t pinned_core_id = HB_BPU_CORE_ANY;
+  if (static_cast<int>(dnn_node_para_ptr_->bpu_core_ids.size()) ==
+          dnn_node_para_ptr_->task_num &&
+      ctx->task_id < dnn_node_para_ptr_->task_num) {
+    pinned_core_id = dnn_node_para_ptr_->bpu_core_ids.at(ctx->task_id);
+  }
+  if (!ctx->node_task) {
+    // 申请到的task在记录slot之前已经被watchdog回收，占用的BPU资源只能由推理请求释放
+    ctx->node_task = std::make_shared<DnnNodeTask>(ctx->task_id);
+  }
+  auto &node_task = ctx->node_task;
+  ctx->bpu_core_id = ctx->rt_para->core_scheduler->Acquire(pinned_core_id);
+  node_task->infer_core_id = ctx->bpu_core_id;
+  node_task->core_acquired = ctx->bpu_core_id >= 0;
+
+  // 推理请求没有指定优先级时使用dnn node的优先级
+  auto priority = ctx->output->priority;
+  if (DnnPriorityClass::Default == priority) {
+    priority = dnn_node_para_ptr_->priority;
+  }
+  bool preempt = dnn_node_para_ptr_->allow_preemption && ctx->output->preempt;
+
+  // 只有配置了非默认的优先级或者抢占时才修改task的优先级，
+  // 否则保持hbDNN的默认优先级，不影响没有配置优先级的其他模型
+  bool set_priority = en_set_task_priority_ &&
+                      (preempt || DnnPriorityClass::Normal != priority);
+  if (en_set_task_para_ || set_priority) {
+    // 允许配置task参数
+    hbDNNInferCtrlParam ctrl_param;
+    HB_DNN_INITIALIZE_INFER_CTRL_PARAM(&ctrl_param);
+    if (en_set_task_para_) {
+      ctrl_param.bpuCoreId = ctx->bpu_core_id;
+    }
+    if (set_priority && preempt) {
+      ctrl_param.priority = HB_DNN_PRIORITY_PREEMP;
+    } else if (set_priority) {
+      // 非抢占的优先级必须低于HB_DNN_PRIORITY_PREEMP，每一级间隔64
+      ctrl_param.priority =
+          HB_DNN_PRIORITY_LOWEST + static_cast<int>(priority) * 64;
+    }
+    RCLCPP_DEBUG(rclcpp::get_logger("dnn"),
+                 "task id: %d set bpu core: %d, priority: %d",
+                 ctx->task_id,
+                 ctrl_param.bpuCoreId,
+                 ctrl_param.priority);
+    task->SetCtrlParam(ctrl_param);
+  }
+
+  // 在等待仲裁器之前准备输出tensor，避免占用仲裁器名额时阻塞在TensorPool中
+  int prepare_ret = task->PrepareInferInputOutput();
+  if (prepare_ret != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Failed to prepare infer input output, ret[%d]",
+                 prepare_ret);
+    return prepare_ret;
+  }
+
+  // 按照优先级等待BPU仲裁器放行
+  if (dnn_node_para_ptr_->enable_bpu_arbiter) {
+    int ret = BpuArbiter::Instance().Acquire(
+        priority, preempt, ctx->infer_timeout_ms);
+    if (ret != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Wait for BPU arbiter timeout, task id: %d",
+                   ctx->task_id);
+      return DNN_NODE_ARBITER_TIMEOUT;
+    }
+    node_task->arbiter_granted = true;
+  }
+
+  ctx->infer_start_tp = std::chrono::steady_clock::now();
+  clock_gettime(CLOCK_REALTIME, &ctx->infer_start_timespec);
 
-  auto &task = node_task;
   int ret = 0;
 
   ret = task->RunInfer();
@@ -388,57 +1171,73 @@ int DnnNodeImpl::RunInferTask(std::shared_ptr<DnnNodeOutput> node_output,
                     "Run infer success after reset dnn infer ctrl param. Task "
                     "para set will be enable!");
         en_set_task_para_ = false;
+        en_set_task_priority_ = false;
       }
     }
-    if (ret != 0) {
-      return ret;
-    }
   }
+  // 提交耗时包括选择BPU核和等待仲裁器放行
+  ctx->submit_done_tp = std::chrono::steady_clock::now();
+  latency_recorder_.Record(
+      DnnNodeLatencyStage::Submit, submit_start_tp, ctx->submit_done_tp);
+  DNN_TRACE_EVENT("submit",
+                  submit_start_tp,
+                  ctx->submit_done_tp,
+                  ctx->frame_stamp_ns);
+  return ret;
+}
 
-  ret = task->WaitInferDone(timeout_ms);
-  if (ret != 0) {
-    RCLCPP_ERROR(
-        rclcpp::get_logger("dnn"), "Failed to wait infer done, ret[%d]", ret);
-    return ret;
+int DnnNodeImpl::GetInferOutput(const DnnNodeRunContextPtr &ctx) {
+  auto &node_output = ctx->output;
+  auto task = ctx->task;
+  if (!dnn_node_para_ptr_ || !node_output || !task) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid node task\n");
+    return -1;
   }
 
+  // reactor在推理完成时已经记录了推理完成时间
+  if (ctx->infer_done_tp == std::chrono::steady_clock::time_point()) {
+    MarkInferDone(ctx);
+  }
+
+  auto tp_now = std::chrono::steady_clock::now();
+  struct timespec timespec_now = {0, 0};
   if (node_output->rt_stat) {
     node_output->rt_stat->infer_time_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now() - tp_now)
+            ctx->infer_done_tp - ctx->infer_start_tp)
             .count();
-    node_output->rt_stat->infer_timespec_start = timespec_now;
+    node_output->rt_stat->infer_timespec_start = ctx->infer_start_timespec;
     clock_gettime(CLOCK_REALTIME, &timespec_now);
     node_output->rt_stat->infer_timespec_end = timespec_now;
-
-    tp_now = std::chrono::system_clock::now();
-    clock_gettime(CLOCK_REALTIME, &timespec_now);
     node_output->rt_stat->parse_timespec_start = timespec_now;
   }
 
+  int ret = 0;
   if (ModelTaskType::ModelInferType == dnn_node_para_ptr_->model_task_type) {
     auto model_task = std::dynamic_pointer_cast<ModelInferTask>(task);
 
     // 获取解析前的DNNTensor
-    model_task->GetOutputTensors(node_output->output_tensors);
-  
-  } 
-  else if (ModelTaskType::ModelRoiInferType ==
+    ret = model_task->GetOutputTensors(node_output->output_tensors);
+  } else if (ModelTaskType::ModelRoiInferType ==
              dnn_node_para_ptr_->model_task_type) {
     auto model_task = std::dynamic_pointer_cast<ModelRoiInferTask>(task);
-    
+
     // 解析DNNTensor，内部会为算法的每个branch输出调用自定义的Parse接口进行解析
-    model_task->GetOutputTensors(node_output->output_tensors);
+    ret = model_task->GetOutputTensors(node_output->output_tensors);
   }
 
   if (node_output->rt_stat) {
     node_output->rt_stat->parse_time_ms =
         std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now() - tp_now)
+            std::chrono::steady_clock::now() - tp_now)
             .count();
     clock_gettime(CLOCK_REALTIME, &timespec_now);
     node_output->rt_stat->parse_timespec_end = timespec_now;
   }
+  ctx->parse_done_tp = std::chrono::steady_clock::now();
+  latency_recorder_.Record(
+      DnnNodeLatencyStage::Parse, tp_now, ctx->parse_done_tp);
+  DNN_TRACE_EVENT("parse", tp_now, ctx->parse_done_tp, ctx->frame_stamp_ns);
 
   if (ret != 0) {
     RCLCPP_ERROR(
@@ -448,192 +1247,161 @@ int DnnNodeImpl::RunInferTask(std::shared_ptr<DnnNodeOutput> node_output,
   return ret;
 }
 
-TaskId DnnNodeImpl::AllocTask(int timeout_ms) {
+TaskId DnnNodeImpl::AllocTask(int timeout_ms,
+                              std::shared_ptr<DnnNodeRunTimePara> rt_para,
+                              uint64_t *lease) {
   RCLCPP_DEBUG(rclcpp::get_logger("dnn"), "Alloc task");
   TaskId task_id = -1;
-  int32_t bpu_core_id = HB_BPU_CORE_0;
-  if (!dnn_rt_para_) {
-    return task_id;
-  }
-
-  // 真正创建task
-  std::shared_ptr<Task> task = nullptr;
-  // 根据模型类型选择接口创建task,为task添加model
-  if (ModelTaskType::ModelInferType == dnn_node_para_ptr_->model_task_type) {
-
-    task = std::make_shared<hobot::easy_dnn::ModelInferTask>();    
-
-    if (!task) {
-      RCLCPP_ERROR(rclcpp::get_logger("dnn"), "GetModelInferTask fail");
-      return task_id;
-    }
-    std::dynamic_pointer_cast<ModelInferTask>(task)->SetModel(
-        dnn_rt_para_->model_manage);
-
-  }
-  else if (ModelTaskType::ModelRoiInferType ==
-             dnn_node_para_ptr_->model_task_type) {
-
-    task = std::make_shared<hobot::easy_dnn::ModelRoiInferTask>();
-    if (!task) {
-      RCLCPP_ERROR(rclcpp::get_logger("dnn"), "GetModelRoiInferTask fail");
-      return task_id;
-    }
-    std::dynamic_pointer_cast<ModelRoiInferTask>(task)->SetModel(
-        dnn_rt_para_->model_manage);
+  if (!rt_para) {
+    rt_para = GetRunTimePara();
   }
-  else {
-    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
-                 "Invalid model task type [%d]",
-                 static_cast<int>(dnn_node_para_ptr_->model_task_type));
+  if (!rt_para) {
     return task_id;
   }
 
-  auto alloc_task = [this, &task_id, &bpu_core_id]() {
-    auto idle_task = dnn_rt_para_->idle_tasks.begin();
-    idle_task->second->alloc_tp = std::chrono::system_clock::now();
+  auto alloc_task = [&rt_para, &task_id, lease]() {
+    auto idle_task = rt_para->idle_tasks.begin();
+    idle_task->second->alloc_tp = std::chrono::steady_clock::now();
+    idle_task->second->lease = ++rt_para->lease_seq;
+    if (lease) {
+      *lease = idle_task->second->lease;
+    }
     task_id = idle_task->first;
-    bpu_core_id = idle_task->second->bpuCoreId;
-    dnn_rt_para_->running_tasks[task_id] = idle_task->second;
-    dnn_rt_para_->idle_tasks.erase(task_id);
+    rt_para->running_tasks[task_id] = idle_task->second;
+    rt_para->idle_tasks.erase(task_id);
   };
 
-  std::unique_lock<std::mutex> lg(dnn_rt_para_->task_mtx);
-  if (!dnn_rt_para_->idle_tasks.empty()) {
+  std::unique_lock<std::mutex> lg(rt_para->task_mtx);
+  if (!rt_para->idle_tasks.empty()) {
     alloc_task();
   } else {
     // wait for idle task
     if (timeout_ms > 0) {
-      dnn_rt_para_->task_cv.wait_for(
+      rt_para->task_cv.wait_for(
           lg, std::chrono::milliseconds(timeout_ms), [&]() {
-            return !dnn_rt_para_->idle_tasks.empty() || !rclcpp::ok();
+            return !rt_para->idle_tasks.empty() || !rclcpp::ok();
           });
     } else {
-      dnn_rt_para_->task_cv.wait(lg, [&]() {
-        return !dnn_rt_para_->idle_tasks.empty() || !rclcpp::ok();
+      rt_para->task_cv.wait(lg, [&]() {
+        return !rt_para->idle_tasks.empty() || !rclcpp::ok();
       });
     }
     if (!rclcpp::ok()) {
       return task_id;
     }
-    if (!dnn_rt_para_->idle_tasks.empty()) {
+    if (!rt_para->idle_tasks.empty()) {
       alloc_task();
     }
   }
 
   RCLCPP_DEBUG(rclcpp::get_logger("dnn"), "Alloc task id: %d", task_id);
-  if (task_id < 0 || task_id >= static_cast<int>(dnn_rt_para_->tasks.size())) {
+  if (task_id < 0 || task_id >= static_cast<int>(rt_para->tasks.size()) ||
+      !rt_para->tasks[task_id]) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid task id: %d", task_id);
     return -1;
   }
 
-#ifdef PLATFORM_X5
-  en_set_task_para_ = false;
-#endif
-
-  if (en_set_task_para_) {
-    // 允许配置task参数
-    hbDNNInferCtrlParam ctrl_param;
-    HB_DNN_INITIALIZE_INFER_CTRL_PARAM(&ctrl_param);
-    ctrl_param.bpuCoreId = bpu_core_id;
-    RCLCPP_INFO(rclcpp::get_logger("dnn"),
-                "task id: %d set bpu core: %d",
-                task_id,
-                ctrl_param.bpuCoreId);
-    task->SetCtrlParam(ctrl_param);
-  }
-
-  dnn_rt_para_->tasks[task_id] = std::move(task);
-
+  // 推理使用的BPU核在提交推理任务时根据负载选择
   return task_id;
 }
 
-int DnnNodeImpl::ReleaseTask(const TaskId &task_id) {
+int DnnNodeImpl::ReleaseTask(const TaskId &task_id,
+                             std::shared_ptr<DnnNodeRunTimePara> rt_para,
+                             uint64_t lease) {
   RCLCPP_DEBUG(rclcpp::get_logger("dnn"), "Release task id: %d", task_id);
 
-  if (!dnn_rt_para_ || task_id < 0) {
-    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid task_id: %d", task_id);
-    return -1;
+  if (!rt_para) {
+    rt_para = GetRunTimePara();
   }
-
-  auto node_task = std::make_shared<DnnNodeTask>(task_id);
-  std::unique_lock<std::mutex> lg(dnn_rt_para_->task_mtx);
-  if (dnn_rt_para_->running_tasks.find(task_id) ==
-      dnn_rt_para_->running_tasks.end()) {
-    RCLCPP_ERROR(
-        rclcpp::get_logger("dnn"), "Task id: %d is not running", task_id);
+  if (!rt_para || task_id < 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid task_id: %d", task_id);
     return -1;
   }
 
-  // 上一次推理任务使用的BPU核
-  auto last_bpu_core_id = dnn_rt_para_->running_tasks[task_id]->bpuCoreId;
-  // 本次推理任务使用的BPU核
-  auto present_bpu_core_id = last_bpu_core_id;
-  if (static_cast<int>(dnn_node_para_ptr_->bpu_core_ids.size()) ==
-          dnn_node_para_ptr_->task_num &&
-      task_id < dnn_node_para_ptr_->task_num &&
-      dnn_node_para_ptr_->bpu_core_ids.at(task_id) !=
-          HB_BPU_CORE_ANY) {
-    // 用户指定的是BPU 0或1，本次推理直接使用上一次推理任务使用的BPU核
-    present_bpu_core_id = last_bpu_core_id;
-  } else {
-    // 交替使用BPU核
-    if (HB_BPU_CORE_0 == last_bpu_core_id) {
-      present_bpu_core_id = HB_BPU_CORE_1;
-    } else if (HB_BPU_CORE_1 == last_bpu_core_id) {
-      present_bpu_core_id = HB_BPU_CORE_0;
+  std::unique_lock<std::mutex> lg(rt_para->task_mtx);
+  auto running_task = rt_para->running_tasks.find(task_id);
+  if (running_task == rt_para->running_tasks.end() ||
+      (lease != 0 && running_task->second->lease != lease)) {
+    if (lease != 0) {
+      // task已经被watchdog回收，可能已经被其他推理请求重新申请，不能释放
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Task id: %d has been reclaimed by watchdog",
+                  task_id);
     } else {
-      present_bpu_core_id = HB_BPU_CORE_0;
+      RCLCPP_ERROR(
+          rclcpp::get_logger("dnn"), "Task id: %d is not running", task_id);
     }
+    return -1;
+  }
+  auto node_task = running_task->second;
+  node_task->frame_id.clear();
+  node_task->frame_stamp_ns = 0;
+  node_task->infer_core_id = -1;
+
+  // 重置task，保留模型绑定和输出内存，供下一次推理复用
+  if (rt_para->tasks[task_id]) {
+    rt_para->tasks[task_id]->Reset();
   }
 
-  // 设置本次推理任务使用的BPU核
-  node_task->SetBPUCoreID(present_bpu_core_id);
-
-  dnn_rt_para_->idle_tasks[node_task->task_id] = node_task;
-  dnn_rt_para_->running_tasks.erase(task_id);
-  dnn_rt_para_->tasks[task_id] = nullptr;
-  dnn_rt_para_->task_cv.notify_one();
+  rt_para->idle_tasks[node_task->task_id] = node_task;
+  rt_para->running_tasks.erase(task_id);
+  // 等待的可能是申请task的请求，也可能是等待旧模型推理完成的SwapModel
+  rt_para->task_cv.notify_all();
   lg.unlock();
   RCLCPP_DEBUG(rclcpp::get_logger("dnn"),
                "idle_tasks size: %zu, running_tasks size: %zu",
-               dnn_rt_para_->idle_tasks.size(),
-               dnn_rt_para_->running_tasks.size());
+               rt_para->idle_tasks.size(),
+               rt_para->running_tasks.size());
   return 0;
 }
 
-std::shared_ptr<Task> DnnNodeImpl::GetTask(const TaskId &task_id) {
+std::shared_ptr<Task> DnnNodeImpl::GetTask(
+    const TaskId &task_id, std::shared_ptr<DnnNodeRunTimePara> rt_para) {
   std::shared_ptr<Task> task = nullptr;
-  if (!dnn_rt_para_ || task_id < 0 ||
-      task_id >= static_cast<int>(dnn_rt_para_->tasks.size())) {
+  if (!rt_para) {
+    rt_para = GetRunTimePara();
+  }
+  if (!rt_para || task_id < 0 ||
+      task_id >= static_cast<int>(rt_para->tasks.size())) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid task_id: %d", task_id);
     return task;
   }
-  task = dnn_rt_para_->tasks.at(task_id);
+  // watchdog回收task时会替换tasks中的元素，需要持有task_mtx读取
+  std::lock_guard<std::mutex> lg(rt_para->task_mtx);
+  task = rt_para->tasks.at(task_id);
 
   return task;
 }
 
+int DnnNodeImpl::GetCompletionEventFd() {
+  if (thread_pool_ && thread_pool_->reactor_) {
+    return thread_pool_->reactor_->GetEventFd();
+  }
+  return -1;
+}
+
 Model *DnnNodeImpl::GetModel() {
-  if (dnn_rt_para_) {
-    return dnn_rt_para_->model_manage;
+  auto rt_para = GetRunTimePara();
+  if (rt_para) {
+    return rt_para->model_manage;
   }
   return nullptr;
 }
 
 int DnnNodeImpl::GetModelInputSize(int32_t input_index, int &w, int &h) {
-  if (!dnn_rt_para_ || !dnn_rt_para_->model_manage) {
+  auto rt_para = GetRunTimePara();
+  if (!rt_para || !rt_para->model_manage) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid input model");
     return -1;
   }
-  if (input_index >= dnn_rt_para_->model_manage->GetInputCount()) {
+  if (input_index >= rt_para->model_manage->GetInputCount()) {
     RCLCPP_ERROR(
         rclcpp::get_logger("dnn"), "Invalid input index: %d", input_index);
     return -1;
   }
 
   hbDNNTensorProperties properties;
-  dnn_rt_para_->model_manage->GetInputTensorProperties(properties, input_index);
+  rt_para->model_manage->GetInputTensorProperties(properties, input_index);
   if (properties.tensorLayout == HB_DNN_LAYOUT_NHWC) {
     w = properties.validShape.dimensionSize[2];
     h = properties.validShape.dimensionSize[1];
@@ -653,7 +1421,60 @@ int DnnNodeImpl::Run(
     const std::shared_ptr<std::vector<hbDNNRoi>> rois,
     const bool is_sync_mode,
     const int alloctask_timeout_ms,
-    const int infer_timeout_ms) {
+    const int infer_timeout_ms,
+    const std::vector<std::shared_ptr<DNNTensor>> &output_tensors) {
+  if (!output_tensors.empty() &&
+      (ModelTaskType::ModelInferType != dnn_node_para_ptr_->model_task_type ||
+       dnn_node_para_ptr_->enable_dynamic_batch)) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Output tensors provided by user are only supported by "
+                 "ModelInferType without dynamic batch");
+    return HB_DNN_INVALID_ARGUMENT;
+  }
+  if (!init_done_.load(std::memory_order_acquire)) {
+    std::unique_lock<std::mutex> lk(init_mtx_);
+    if (!init_done_) {
+      if (dnn_node_para_ptr_->not_ready_policy == NotReadyPolicy::Reject) {
+        RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                    "Dnn node is not ready, reject run");
+        return DNN_NODE_NOT_READY;
+      }
+      if (!is_sync_mode) {
+        if (static_cast<int>(not_ready_runs_.size()) >=
+            dnn_node_para_ptr_->msg_limit_count) {
+          return DNN_NODE_RUN_QUEUE_FULL;
+        }
+        input_stat_.Update();
+        auto ctx = CreateRunContext(dnn_node_para_ptr_->model_name,
+                                    inputs,
+                                    tensor_inputs,
+                                    input_type,
+                                    output,
+                                    post_process,
+                                    rois,
+                                    alloctask_timeout_ms,
+                                    infer_timeout_ms);
+        ctx->output_tensors = output_tensors;
+        not_ready_runs_.push_back(ctx);
+        return 0;
+      }
+      auto pred = [this]() { return init_done_.load(); };
+      if (alloctask_timeout_ms < 0) {
+        init_cv_.wait(lk, pred);
+      } else if (!init_cv_.wait_for(
+                     lk, std::chrono::milliseconds(alloctask_timeout_ms),
+                     pred)) {
+        return DNN_NODE_NOT_READY;
+      }
+    }
+  }
+  if (init_ret_ != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Dnn node init failed, ret: %d",
+                 init_ret_);
+    return DNN_NODE_NOT_READY;
+  }
+
   // 统计输入fps
   input_stat_.Update();
   if (is_sync_mode) {
@@ -664,44 +1485,524 @@ int DnnNodeImpl::Run(
                    post_process,
                    rois,
                    alloctask_timeout_ms,
-                   infer_timeout_ms);
+                   infer_timeout_ms,
+                   output_tensors);
   } else {
-    std::lock_guard<std::mutex> lock(thread_pool_->msg_mutex_);
-    if (thread_pool_->msg_handle_.GetTaskNum() >=
-        thread_pool_->msg_limit_count_) {
-      RCLCPP_INFO(rclcpp::get_logger("dnn"),
-                  "Task Size: %d exceeds limit: %d. Prediction "
-                  "time(rt_stat.infer_time_ms in DnnNodeOutput) is too long "
-                  "for this model!",
-                  thread_pool_->msg_handle_.GetTaskNum(),
-                  thread_pool_->msg_limit_count_);
-      // todo [20220622] 返回错误码告知用户推理失败原因
-      return -1;
+    auto ctx = CreateRunContext(model_name_,
+                                inputs,
+                                tensor_inputs,
+                                input_type,
+                                output,
+                                post_process,
+                                rois,
+                                alloctask_timeout_ms,
+                                infer_timeout_ms);
+    ctx->output_tensors = output_tensors;
+    return AdmitRunContext(ctx);
+  }
+  return 0;
+}
+
+int DnnNodeImpl::RunCascade(
+    DnnNodeImpl *roi_impl,
+    const std::shared_ptr<NV12PyramidInput> &pyramid,
+    const CascadeRoiGenCbType &roi_gen,
+    const DnnNodeRoiConstraint &roi_constraint,
+    const std::shared_ptr<DnnNodeCascadeOutput> &output,
+    PostProcessCbType post_process,
+    const bool is_sync_mode,
+    const int alloctask_timeout_ms,
+    const int infer_timeout_ms) {
+  auto roi_model = roi_impl ? roi_impl->GetModel() : nullptr;
+  if (!roi_model || !pyramid || !roi_gen) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid para in RunCascade");
+    return HB_DNN_INVALID_ARGUMENT;
+  }
+  if (roi_impl->dnn_node_para_ptr_->model_task_type !=
+      ModelTaskType::ModelRoiInferType) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Model: %s for cascade roi infer should be ModelRoiInferType",
+                 roi_impl->model_name_.c_str());
+    return HB_DNN_INVALID_ARGUMENT;
+  }
+
+  auto cascade_output =
+      output ? output : std::make_shared<DnnNodeCascadeOutput>();
+  auto det_output = cascade_output->det_output
+                        ? cascade_output->det_output
+                        : std::make_shared<DnnNodeOutput>();
+  det_output->msg_header = cascade_output->msg_header;
+  det_output->priority = cascade_output->priority;
+  det_output->preempt = cascade_output->preempt;
+  det_output->deadline_ns = cascade_output->deadline_ns;
+  det_output->deadline_budget_ms = cascade_output->deadline_budget_ms;
+  cascade_output->model_name = roi_impl->model_name_;
+
+  // 同步推理时第二级推理在第一级的后处理中执行，通过cascade_ret返回第二级推理结果
+  auto cascade_ret = std::make_shared<int>(0);
+  auto input_count = roi_model->GetInputCount();
+  PostProcessCbType det_post_process =
+      [roi_impl,
+       pyramid,
+       roi_gen,
+       roi_constraint,
+       cascade_output,
+       post_process,
+       is_sync_mode,
+       alloctask_timeout_ms,
+       infer_timeout_ms,
+       cascade_ret,
+       input_count](std::shared_ptr<DnnNodeOutput> &det_out) -> int {
+    cascade_output->det_output = det_out;
+    std::shared_ptr<DnnNodeOutput> out = cascade_output;
+    if (det_out->status != DnnNodeOutputStatus::SUCCESS ||
+        det_out->output_tensors.empty()) {
+      // 第一级推理失败或者请求被丢弃，不执行第二级推理
+      out->status = det_out->status == DnnNodeOutputStatus::SUCCESS
+                        ? DnnNodeOutputStatus::INFER_FAILED
+                        : det_out->status;
+      out->rt_stat = det_out->rt_stat;
+      *cascade_ret = -1;
+      return post_process ? post_process(out) : 0;
+    }
+
+    std::vector<hbDNNRoi> det_rois;
+    auto rois = std::make_shared<std::vector<hbDNNRoi>>();
+    if (roi_gen(det_out, det_rois) != 0 ||
+        NormalizeRois(det_rois,
+                      pyramid->width,
+                      pyramid->height,
+                      roi_constraint,
+                      *rois,
+                      cascade_output->roi_index) < 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Generate cascade rois failed");
+      out->status = DnnNodeOutputStatus::INFER_FAILED;
+      out->rt_stat = det_out->rt_stat;
+      *cascade_ret = -1;
+      return post_process ? post_process(out) : 0;
+    }
+
+    // 每个roi的每个输入都使用同一帧pyramid，不拷贝图片
+    std::vector<std::shared_ptr<DNNInput>> roi_inputs(
+        rois->size() * static_cast<size_t>(input_count), pyramid);
+    std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+    int ret = roi_impl->Run(roi_inputs,
+                            tensor_inputs,
+                            InputType::DNN_INPUT,
+                            out,
+                            post_process,
+                            rois,
+                            is_sync_mode,
+                            alloctask_timeout_ms,
+                            infer_timeout_ms);
+    if (ret == DNN_NODE_RUN_EXPIRED) {
+      // 同步推理超过截止时间，已经执行了后处理
+      *cascade_ret = ret;
+      return 0;
+    }
+    if (ret != 0) {
+      // 第二级推理请求未被接收或者推理失败，保证每个推理输入都有输出
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Run cascade roi model: %s failed, ret: %d",
+                  out->model_name.c_str(),
+                  ret);
+      bool dropped = ret == DNN_NODE_RUN_QUEUE_FULL ||
+                     ret == DNN_NODE_RUN_WAIT_TIMEOUT ||
+                     ret == DNN_NODE_RUN_QUEUE_CLOSED;
+      out->status = dropped ? DnnNodeOutputStatus::DROPPED
+                            : DnnNodeOutputStatus::INFER_FAILED;
+      out->rois = rois;
+      if (!out->rt_stat) {
+        out->rt_stat = det_out->rt_stat;
+      }
+      *cascade_ret = ret;
+      return post_process ? post_process(out) : 0;
     }
+    return 0;
+  };
+
+  std::vector<std::shared_ptr<DNNInput>> det_inputs{pyramid};
+  std::vector<std::shared_ptr<DNNTensor>> tensor_inputs;
+  int ret = Run(det_inputs,
+                tensor_inputs,
+                InputType::DNN_INPUT,
+                det_output,
+                det_post_process,
+                nullptr,
+                is_sync_mode,
+                alloctask_timeout_ms,
+                infer_timeout_ms);
+  if (ret != 0) {
+    return ret;
+  }
+  return is_sync_mode ? *cascade_ret : 0;
+}
 
-    auto infer_task = [this,
-                       inputs,
-                       tensor_inputs,
-                       input_type,
-                       output,
-                       post_process,
-                       rois,
-                       alloctask_timeout_ms,
-                       infer_timeout_ms]() {
-      RunImpl(inputs,
-              tensor_inputs,
-              input_type,
-              output,
-              post_process,
-              rois,
-              alloctask_timeout_ms,
-              infer_timeout_ms);
-    };
-
-    thread_pool_->msg_handle_.PostTask(infer_task);
+hobot::BoundedQueue<DnnNodeRunContextPtr> *DnnNodeImpl::GetRunQueue() {
+  if (thread_pool_->preprocess_stage_) {
+    return &thread_pool_->preprocess_stage_->Queue();
   }
+  return thread_pool_->pending_runs_.get();
+}
 
-  return 0;
+int DnnNodeImpl::AdmitRunContext(const DnnNodeRunContextPtr &ctx) {
+  auto run_queue = GetRunQueue();
+  if (!run_queue) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Run queue is not initialized");
+    return DNN_NODE_RUN_QUEUE_CLOSED;
+  }
+  if (ctx->output->msg_header) {
+    ctx->stream_id = ctx->output->msg_header->frame_id;
+  }
+
+  int ret = 0;
+  std::vector<DnnNodeRunContextPtr> coalesced_ctxs;
+  DnnNodeRunContextPtr evicted_ctx = nullptr;
+  switch (dnn_node_para_ptr_->admission_policy) {
+    case RunAdmissionPolicy::RejectNew:
+      if (!run_queue->Push(ctx, 0)) {
+        ret = DNN_NODE_RUN_QUEUE_FULL;
+      }
+      break;
+    case RunAdmissionPolicy::BoundedWait:
+      if (!run_queue->Push(ctx, dnn_node_para_ptr_->admission_wait_ms)) {
+        ret = DNN_NODE_RUN_WAIT_TIMEOUT;
+      }
+      break;
+    case RunAdmissionPolicy::LatestOnly:
+      // 同一数据流中只保留最新的推理请求，没有数据流标识的请求不合并
+      if (!ctx->stream_id.empty()) {
+        run_queue->RemoveIf(
+            [&ctx](const DnnNodeRunContextPtr &pending) {
+              return pending->stream_id == ctx->stream_id;
+            },
+            coalesced_ctxs);
+      }
+      // fall through
+    case RunAdmissionPolicy::DropOldest:
+      if (!run_queue->PushEvict(ctx, evicted_ctx)) {
+        ret = DNN_NODE_RUN_QUEUE_CLOSED;
+      }
+      break;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(admission_mtx_);
+    if (ret == 0) {
+      admission_stat_.accepted++;
+    } else if (ret == DNN_NODE_RUN_QUEUE_FULL) {
+      admission_stat_.rejected++;
+    } else if (ret == DNN_NODE_RUN_WAIT_TIMEOUT) {
+      admission_stat_.wait_timeout++;
+    }
+    admission_stat_.coalesced += coalesced_ctxs.size();
+    if (evicted_ctx) {
+      admission_stat_.dropped_oldest++;
+    }
+  }
+
+  if (ret == 0 && !thread_pool_->preprocess_stage_) {
+    ScheduleDrainer();
+  }
+
+  for (auto &dropped_ctx : coalesced_ctxs) {
+    DiscardRunContext(dropped_ctx, DnnNodeOutputStatus::DROPPED);
+  }
+  if (evicted_ctx) {
+    DiscardRunContext(evicted_ctx, DnnNodeOutputStatus::DROPPED);
+  }
+
+  if (ret == DNN_NODE_RUN_QUEUE_FULL || ret == DNN_NODE_RUN_WAIT_TIMEOUT) {
+    RCLCPP_INFO(rclcpp::get_logger("dnn"),
+                "Run queue size: %zu reaches limit: %zu, ret: %d. Prediction "
+                "time(rt_stat.infer_time_ms in DnnNodeOutput) is too long "
+                "for this model!",
+                run_queue->Size(),
+                run_queue->Capacity(),
+                ret);
+  }
+  return ret;
+}
+
+void DnnNodeImpl::ScheduleDrainer() {
+  std::lock_guard<std::mutex> lock(thread_pool_->msg_mutex_);
+  if (thread_pool_->drainer_num_ >= thread_pool_->drainer_limit_) {
+    // 正在处理的线程取完当前请求后会继续处理队列中的请求
+    return;
+  }
+  auto drain = [this]() {
+    while (true) {
+      DnnNodeRunContextPtr ctx = nullptr;
+      {
+        // 取请求和退出在同一把锁内，保证队列中的请求总有线程处理
+        std::lock_guard<std::mutex> lock(thread_pool_->msg_mutex_);
+        if (!thread_pool_->pending_runs_->TryPop(ctx)) {
+          thread_pool_->drainer_num_--;
+          thread_pool_->drainer_cv_.notify_all();
+          return;
+        }
+      }
+      if (batch_size_ > 1) {
+        RunBatched(ctx, false);
+      } else if (RunPreProcessStage(ctx)) {
+        RunInferStage(ctx);
+        RunPostProcessStage(ctx);
+      }
+    }
+  };
+  if (thread_pool_->msg_handle_->PostTask(drain)) {
+    thread_pool_->drainer_num_++;
+  } else {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Post run task failed");
+  }
+}
+
+void DnnNodeImpl::OnRunFailed(const DnnNodeRunContextPtr &ctx) {
+  if (!ctx->is_sync_mode) {
+    DiscardRunContext(ctx, DnnNodeOutputStatus::INFER_FAILED);
+  }
+}
+
+void DnnNodeImpl::DiscardRunContext(const DnnNodeRunContextPtr &ctx,
+                                    DnnNodeOutputStatus status) {
+  auto &dnn_output = ctx->output;
+  if (!dnn_output->rt_stat) {
+    dnn_output->rt_stat = std::make_shared<DnnNodeRunTimeStat>();
+  }
+  dnn_output->rt_stat->input_fps = input_stat_.Get();
+  dnn_output->rt_stat->output_fps = output_stat_.Get();
+  dnn_output->rois = ctx->rois;
+  dnn_output->status = status;
+  // 被丢弃的请求也要将对应的（空）结果输出，保证每个推理输入都有输出
+  RunPostProcessStage(ctx);
+}
+
+void DnnNodeImpl::WatchdogLoop() {
+  pthread_setname_np(pthread_self(), "dnn_watchdog");
+  std::unique_lock<std::mutex> lk(watchdog_mtx_);
+  while (!watchdog_stop_) {
+    watchdog_cv_.wait_for(
+        lk,
+        std::chrono::milliseconds(dnn_node_para_ptr_->task_watchdog_interval_ms),
+        [this]() { return watchdog_stop_; });
+    if (watchdog_stop_) {
+      break;
+    }
+    lk.unlock();
+    ReclaimStuckTasks(GetRunTimePara());
+    lk.lock();
+  }
+}
+
+int DnnNodeImpl::ReclaimStuckTasks(
+    const std::shared_ptr<DnnNodeRunTimePara> &rt_para) {
+  if (!rt_para) {
+    return 0;
+  }
+  // 1. 找出占用时间过长的task
+  std::vector<std::pair<TaskId, uint64_t>> stuck_tasks;
+  auto tp_now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lg(rt_para->task_mtx);
+    for (const auto &running_task : rt_para->running_tasks) {
+      auto age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        tp_now - running_task.second->alloc_tp)
+                        .count();
+      if (age_ms > dnn_node_para_ptr_->task_watchdog_timeout_ms) {
+        stuck_tasks.emplace_back(running_task.first,
+                                 running_task.second->lease);
+      }
+    }
+  }
+
+  int reclaimed = 0;
+  for (const auto &stuck_task : stuck_tasks) {
+    TaskId task_id = stuck_task.first;
+    // 2. 创建新的task替换卡住的task，原来的task由推理请求持有，推理请求结束后释放
+    auto new_task = CreateTask(rt_para);
+    if (!new_task) {
+      continue;
+    }
+    new_task->SetTensorPool(rt_para->output_tensor_pool);
+
+    std::shared_ptr<Task> old_task = nullptr;
+    std::shared_ptr<DnnNodeTask> old_node_task = nullptr;
+    {
+      std::lock_guard<std::mutex> lg(rt_para->task_mtx);
+      auto running_task = rt_para->running_tasks.find(task_id);
+      if (running_task == rt_para->running_tasks.end() ||
+          running_task->second->lease != stuck_task.second) {
+        // 检查之后已经被正常释放
+        continue;
+      }
+      old_task = rt_para->tasks[task_id];
+      old_node_task = running_task->second;
+      rt_para->tasks[task_id] = new_task;
+      // 清除租约，之后推理请求使用旧租约释放task无效
+      // 使用新的slot，推理请求持有的旧slot不再影响task状态查询
+      running_task->second->lease = 0;
+      auto node_task = std::make_shared<DnnNodeTask>(task_id);
+      node_task->bpuCoreId = running_task->second->bpuCoreId;
+      rt_para->idle_tasks[task_id] = node_task;
+      rt_para->running_tasks.erase(running_task);
+      rt_para->task_cv.notify_all();
+    }
+
+    // 3. 尽可能取消BPU推理任务，正在等待推理完成的任务无法取消
+    bool canceled = old_task && old_task->Cancel() == 0;
+
+    // 4. 释放推理请求占用的BPU核和仲裁器名额，避免卡住的推理长期占用导致其他请求无法提交，
+    // 推理请求结束时不再重复释放
+    if (old_node_task->core_acquired.exchange(false)) {
+      rt_para->core_scheduler->Release(old_node_task->infer_core_id, 0, false);
+    }
+    if (old_node_task->arbiter_granted.exchange(false)) {
+      BpuArbiter::Instance().Release();
+    }
+    reclaimed++;
+    {
+      std::lock_guard<std::mutex> lk(task_stat_mtx_);
+      task_stat_.reclaimed++;
+      if (canceled) {
+        task_stat_.canceled++;
+      }
+    }
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "Task id: %d of model: %s is running for more than %d ms, "
+                "reclaimed by watchdog, infer canceled: %d",
+                task_id,
+                model_name_.c_str(),
+                dnn_node_para_ptr_->task_watchdog_timeout_ms,
+                canceled);
+  }
+  return reclaimed;
+}
+
+DnnNodeTaskStat DnnNodeImpl::GetTaskStat() {
+  std::lock_guard<std::mutex> lk(task_stat_mtx_);
+  return task_stat_;
+}
+
+std::vector<DnnNodeLatencyStat> DnnNodeImpl::GetLatencyStat() {
+  return latency_recorder_.GetStat();
+}
+
+void DnnNodeImpl::ResetLatencyStat() { latency_recorder_.Reset(); }
+
+std::vector<std::string> DnnNodeImpl::GetModelNames() {
+  if (!init_done_.load(std::memory_order_acquire)) {
+    // 初始化完成前其他模型还未创建
+    return {dnn_node_para_ptr_->model_name};
+  }
+  std::vector<std::string> model_names{model_name_};
+  for (const auto &sub_impl : sub_impls_) {
+    model_names.push_back(sub_impl.first);
+  }
+  return model_names;
+}
+
+void DnnNodeImpl::SetRunDeadline(const DnnNodeRunContextPtr &ctx) {
+  const auto &dnn_output = ctx->output;
+  if (dnn_output->deadline_ns > 0) {
+    ctx->deadline_ns = dnn_output->deadline_ns;
+    return;
+  }
+  int budget_ms = dnn_output->deadline_budget_ms > 0
+                      ? dnn_output->deadline_budget_ms
+                      : dnn_node_para_ptr_->deadline_budget_ms;
+  if (budget_ms <= 0 || !dnn_output->msg_header) {
+    ctx->deadline_ns = 0;
+    return;
+  }
+  const auto &stamp = dnn_output->msg_header->stamp;
+  ctx->deadline_ns = static_cast<int64_t>(stamp.sec) * 1000000000LL +
+                     static_cast<int64_t>(stamp.nanosec) +
+                     static_cast<int64_t>(budget_ms) * 1000000LL;
+}
+
+int64_t DnnNodeImpl::GetDeadlineRemainMs(const DnnNodeRunContextPtr &ctx) {
+  if (ctx->deadline_ns <= 0) {
+    return -1;
+  }
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  if (now_ns >= ctx->deadline_ns) {
+    return 0;
+  }
+  // 向上取整，未超时时剩余时间至少为1ms
+  return (ctx->deadline_ns - now_ns + 999999) / 1000000;
+}
+
+bool DnnNodeImpl::IsRunExpired(const DnnNodeRunContextPtr &ctx) {
+  return GetDeadlineRemainMs(ctx) == 0;
+}
+
+void DnnNodeImpl::MarkRunExpired(const DnnNodeRunContextPtr &ctx) {
+  // batch超时时按照batch中的请求统计
+  if (!ctx->is_batch) {
+    std::lock_guard<std::mutex> lk(admission_mtx_);
+    admission_stat_.expired++;
+  }
+  RCLCPP_DEBUG(rclcpp::get_logger("dnn"),
+               "Run of model: %s expired, deadline: %ld ns",
+               model_name_.c_str(),
+               static_cast<long>(ctx->deadline_ns));
+  auto &dnn_output = ctx->output;
+  if (!dnn_output->rt_stat) {
+    dnn_output->rt_stat = std::make_shared<DnnNodeRunTimeStat>();
+  }
+  dnn_output->rt_stat->input_fps = input_stat_.Get();
+  dnn_output->rt_stat->output_fps = output_stat_.Get();
+  dnn_output->rois = ctx->rois;
+  dnn_output->output_tensors.clear();
+  dnn_output->status = DnnNodeOutputStatus::EXPIRED;
+  ctx->task_id = -1;
+  ctx->ret = DNN_NODE_RUN_EXPIRED;
+}
+
+int DnnNodeImpl::CancelPendingRuns(
+    const std::function<bool(const std::shared_ptr<DnnNodeOutput> &)> &pred) {
+  auto run_queue = GetRunQueue();
+  if (!run_queue || !pred) {
+    return 0;
+  }
+  std::vector<DnnNodeRunContextPtr> canceled_ctxs;
+  run_queue->RemoveIf(
+      [&pred](const DnnNodeRunContextPtr &pending) {
+        return pred(pending->output);
+      },
+      canceled_ctxs);
+  {
+    std::lock_guard<std::mutex> lk(admission_mtx_);
+    admission_stat_.canceled += canceled_ctxs.size();
+  }
+  for (auto &ctx : canceled_ctxs) {
+    DiscardRunContext(ctx, DnnNodeOutputStatus::CANCELED);
+  }
+  return static_cast<int>(canceled_ctxs.size());
+}
+
+std::vector<BpuCoreStat> DnnNodeImpl::GetBpuCoreStat() {
+  auto rt_para = GetRunTimePara();
+  if (!rt_para || !rt_para->core_scheduler) {
+    return {};
+  }
+  return rt_para->core_scheduler->GetStat();
+}
+
+DnnNodeBpuStat DnnNodeImpl::GetBpuStat() {
+  DnnNodeBpuStat stat;
+  stat.core_stats = GetBpuCoreStat();
+  stat.input_fps = input_stat_.Get();
+  stat.output_fps = output_stat_.Get();
+  stat.queue_depth = GetQueueDepth();
+  return stat;
+}
+
+DnnNodeAdmissionStat DnnNodeImpl::GetAdmissionStat() {
+  std::lock_guard<std::mutex> lk(admission_mtx_);
+  return admission_stat_;
 }
 
 int DnnNodeImpl::RunImpl(
@@ -712,93 +2013,829 @@ int DnnNodeImpl::RunImpl(
     PostProcessCbType post_process,
     const std::shared_ptr<std::vector<hbDNNRoi>> rois,
     const int alloctask_timeout_ms,
-    const int infer_timeout_ms) {
+    const int infer_timeout_ms,
+    const std::vector<std::shared_ptr<DNNTensor>> &output_tensors) {
   
   // 检查参数是否正确
-  if (!dnn_rt_para_) {
+  if (!GetRunTimePara()) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid Para In Run, ret[%d]", HB_DNN_INVALID_ARGUMENT);
     return HB_DNN_INVALID_ARGUMENT;
   }
 
-  // 1. dnn_output用于存储模型推理输出
-  std::shared_ptr<DnnNodeOutput> dnn_output = nullptr;
-  if (output) {
-    // 使用传入的DnnNodeOutput
-    dnn_output = output;
+  auto ctx = CreateRunContext(model_name_,
+                              inputs,
+                              tensor_inputs,
+                              input_type,
+                              output,
+                              post_process,
+                              rois,
+                              alloctask_timeout_ms,
+                              infer_timeout_ms);
+  ctx->output_tensors = output_tensors;
+  ctx->is_sync_mode = true;
+
+  if (batch_size_ > 1) {
+    return RunBatched(ctx, true);
+  }
+
+  if (!RunPreProcessStage(ctx)) {
+    return ctx->ret;
+  }
+  RunInferStage(ctx);
+  RunPostProcessStage(ctx);
+
+  // 推理失败通过输出状态返回，超过截止时间时返回DNN_NODE_RUN_EXPIRED
+  if (DnnNodeOutputStatus::EXPIRED == ctx->output->status) {
+    return DNN_NODE_RUN_EXPIRED;
+  }
+  return 0;
+}
+
+int DnnNodeImpl::RunBatched(const DnnNodeRunContextPtr &ctx, bool wait_done) {
+  // 排队时已经超过截止时间的请求不加入batch
+  SetRunDeadline(ctx);
+  if (IsRunExpired(ctx)) {
+    MarkRunExpired(ctx);
+    RunPostProcessStage(ctx);
+    return ctx->ret;
+  }
+
+  std::unique_lock<std::mutex> lk(batch_mtx_);
+  auto batch = open_batch_;
+  if (batch && batch->input_type != ctx->input_type) {
+    // 输入类型不同的请求不能合并，提前结束正在收集的batch
+    open_batch_ = nullptr;
+    batch_cv_.notify_all();
+    batch = nullptr;
+  }
+  bool is_leader = false;
+  if (!batch) {
+    batch = std::make_shared<DnnNodeBatch>();
+    batch->input_type = ctx->input_type;
+    batch->deadline =
+        std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(dnn_node_para_ptr_->batch_max_wait_ms);
+    open_batch_ = batch;
+    is_leader = true;
+  }
+  batch->members.push_back(ctx);
+  if (static_cast<int>(batch->members.size()) >= batch_size_) {
+    open_batch_ = nullptr;
+    batch_cv_.notify_all();
+  }
+
+  if (is_leader) {
+    batch_cv_.wait_until(
+        lk, batch->deadline, [this, &batch]() { return open_batch_ != batch; });
+    if (open_batch_ == batch) {
+      open_batch_ = nullptr;
+    }
+    lk.unlock();
+    RunBatch(batch);
+    lk.lock();
+    batch->done = true;
+    batch_cv_.notify_all();
+  } else if (wait_done) {
+    batch_cv_.wait(lk, [&batch]() { return batch->done; });
+  }
+  return ctx->ret;
+}
+
+void DnnNodeImpl::RunBatch(const std::shared_ptr<DnnNodeBatch> &batch) {
+  auto &members = batch->members;
+  // 收集期间已经超过截止时间的请求不参与推理，batch使用其余请求中最早的截止时间
+  int64_t deadline_ns = 0;
+  for (auto member = members.begin(); member != members.end();) {
+    if (IsRunExpired(*member)) {
+      MarkRunExpired(*member);
+      RunPostProcessStage(*member);
+      member = members.erase(member);
+      continue;
+    }
+    if ((*member)->deadline_ns > 0 &&
+        (deadline_ns <= 0 || (*member)->deadline_ns < deadline_ns)) {
+      deadline_ns = (*member)->deadline_ns;
+    }
+    ++member;
+  }
+  if (members.empty()) {
+    return;
+  }
+
+  const auto &first = members.front();
+  auto batch_ctx = CreateRunContext(model_name_,
+                                    {},
+                                    {},
+                                    batch->input_type,
+                                    nullptr,
+                                    nullptr,
+                                    nullptr,
+                                    first->alloctask_timeout_ms,
+                                    first->infer_timeout_ms);
+  batch_ctx->output->priority = first->output->priority;
+  batch_ctx->output->preempt = first->output->preempt;
+  batch_ctx->output->deadline_ns = deadline_ns;
+  batch_ctx->is_batch = true;
+  batch_ctx->rt_para = GetRunTimePara();
+
+  // 1 合并输入，不足batch size时使用最后一个请求补齐
+  // pyramid batch模型的输入按照输入branch排列，第i个输入为第i / batch_size个branch的
+  // 第i % batch_size个样本
+  int ret = 0;
+  int input_count = batch_ctx->rt_para->model_manage->GetInputCount();
+  if (InputType::DNN_INPUT == batch->input_type) {
+    for (int idx = 0; idx < input_count && ret == 0; idx++) {
+      for (int sample = 0; sample < batch_size_; sample++) {
+        const auto &member =
+            members[std::min(sample, static_cast<int>(members.size()) - 1)];
+        if (static_cast<int>(member->dnn_inputs.size()) != input_count) {
+          RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                       "Batch member inputs size %zu is not equal to model "
+                       "input count %d",
+                       member->dnn_inputs.size(),
+                       input_count);
+          ret = HB_DNN_INVALID_ARGUMENT;
+          break;
+        }
+        batch_ctx->dnn_inputs.push_back(member->dnn_inputs[idx]);
+      }
+    }
+  } else {
+    ret = BuildBatchTensorInputs(batch, batch_ctx);
+  }
+
+  // 2 推理
+  bool infer = ret == 0 && RunPreProcessStage(batch_ctx);
+  if (infer) {
+    RunInferStage(batch_ctx);
+  }
+  if (DNN_NODE_RUN_EXPIRED == batch_ctx->ret) {
+    // 等待task或者推理前超过了最早的截止时间，batch中的请求都按照超时输出
+    for (auto &member : members) {
+      MarkRunExpired(member);
+      RunPostProcessStage(member);
+    }
+    return;
+  }
+  if (!infer) {
+    // 和非batch推理一致，前处理失败时同步推理不执行后处理
+    for (auto &member : members) {
+      member->ret = ret != 0 ? ret : batch_ctx->ret;
+      OnRunFailed(member);
+    }
+    return;
+  }
+
+  // 3 按照batch拆分输出，输出的第一维为batch
+  auto &batch_output = batch_ctx->output;
+  for (size_t sample = 0; sample < members.size(); sample++) {
+    auto &member = members[sample];
+    auto &dnn_output = member->output;
+    dnn_output->output_tensors.clear();
+    for (const auto &tensor : batch_output->output_tensors) {
+      auto slice = std::make_shared<hobot::easy_dnn::DNNTensorSlice>();
+      slice->tensor = tensor;
+      auto &properties = slice->properties;
+      properties = tensor->properties;
+      properties.validShape.dimensionSize[0] /= batch_size_;
+      properties.alignedShape.dimensionSize[0] /= batch_size_;
+      properties.alignedByteSize /= batch_size_;
+      auto &sys_mem = slice->sysMem[0];
+      sys_mem = tensor->sysMem[0];
+      sys_mem.memSize = static_cast<uint32_t>(properties.alignedByteSize);
+      const uint32_t offset =
+          static_cast<uint32_t>(properties.alignedByteSize * sample);
+      sys_mem.phyAddr += offset;
+      sys_mem.virAddr = reinterpret_cast<uint8_t *>(sys_mem.virAddr) + offset;
+      dnn_output->output_tensors.push_back(slice);
+    }
+    if (!dnn_output->rt_stat) {
+      dnn_output->rt_stat = std::make_shared<DnnNodeRunTimeStat>();
+    }
+    *dnn_output->rt_stat = *batch_output->rt_stat;
+    if (sample > 0 && DnnNodeOutputStatus::SUCCESS == batch_output->status) {
+      // batch推理只统计了一帧输出
+      dnn_output->rt_stat->fps_updated = output_stat_.Update();
+      dnn_output->rt_stat->output_fps = output_stat_.Get();
+    }
+    dnn_output->status = batch_output->status;
+    member->ret = 0;
+    RunPostProcessStage(member);
+  }
+}
+
+int DnnNodeImpl::BuildBatchTensorInputs(
+    const std::shared_ptr<DnnNodeBatch> &batch,
+    const DnnNodeRunContextPtr &batch_ctx) {
+  auto &members = batch->members;
+  auto model = batch_ctx->rt_para->model_manage;
+  int input_count = model->GetInputCount();
+  for (auto &member : members) {
+    if (static_cast<int>(member->tensor_inputs.size()) != input_count) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Batch member tensor inputs size %zu is not equal to model "
+                   "input count %d",
+                   member->tensor_inputs.size(),
+                   input_count);
+      return HB_DNN_INVALID_ARGUMENT;
+    }
+  }
+
+  for (int idx = 0; idx < input_count; idx++) {
+    hbDNNTensorProperties properties;
+    model->GetInputTensorProperties(properties, idx);
+    auto batch_tensor = batch_input_pool_->Acquire(properties);
+    if (!batch_tensor) {
+      return HB_DNN_OUT_OF_MEMORY;
+    }
+    auto &batch_mem = batch_tensor->sysMem[0];
+    const uint32_t sample_size = TensorPool::GetTensorMemSize(properties) /
+                                 static_cast<uint32_t>(batch_size_);
+    for (int sample = 0; sample < batch_size_; sample++) {
+      const auto &member =
+          members[std::min(sample, static_cast<int>(members.size()) - 1)];
+      const auto &src_mem = member->tensor_inputs[idx]->sysMem[0];
+      memcpy(reinterpret_cast<uint8_t *>(batch_mem.virAddr) +
+                 sample_size * sample,
+             src_mem.virAddr,
+             std::min(sample_size, src_mem.memSize));
+    }
+    hbSysFlushMem(&batch_mem, HB_SYS_MEM_CACHE_CLEAN);
+    batch_ctx->tensor_inputs.push_back(batch_tensor);
+  }
+  return 0;
+}
+
+bool DnnNodeImpl::RunPreProcessStage(const DnnNodeRunContextPtr &ctx) {
+  // 从创建请求到开始处理的排队耗时
+  ctx->preprocess_start_tp = std::chrono::steady_clock::now();
+  latency_recorder_.Record(DnnNodeLatencyStage::QueueWait,
+                           ctx->create_tp,
+                           ctx->preprocess_start_tp);
+  if (flight_recorder_) {
+    ctx->queue_depth = GetQueueDepth();
   }
-  if (!dnn_output) {
+
+  // 1. dnn_output用于存储模型推理输出
+  if (!ctx->output) {
     // 没有传入，创建DnnNodeOutput
-    dnn_output = std::make_shared<DnnNodeOutput>();
+    ctx->output = std::make_shared<DnnNodeOutput>();
+  }
+  auto &dnn_output = ctx->output;
+  if (dnn_output->msg_header) {
+    const auto &stamp = dnn_output->msg_header->stamp;
+    ctx->frame_stamp_ns = static_cast<int64_t>(stamp.sec) * 1000000000LL +
+                          static_cast<int64_t>(stamp.nanosec);
   }
+  DNN_TRACE_EVENT("queue_wait",
+                  ctx->create_tp,
+                  ctx->preprocess_start_tp,
+                  ctx->frame_stamp_ns);
   if (!dnn_output->rt_stat) {
     dnn_output->rt_stat = std::make_shared<DnnNodeRunTimeStat>();
   }
   // 统计输入fps
   dnn_output->rt_stat->input_fps = input_stat_.Get();
-  dnn_output->rois = rois;
+  dnn_output->rois = ctx->rois;
 
   // 对于roi
   // infer，如果当前帧中无roi，不需要推理，更新统计信息后直接执行用户定义的后处理
   if (dnn_node_para_ptr_ &&
       ModelTaskType::ModelRoiInferType == dnn_node_para_ptr_->model_task_type &&
-      (!rois || rois->empty())) {
+      (!ctx->rois || ctx->rois->empty())) {
     // 统计输出fps
     dnn_output->rt_stat->fps_updated = output_stat_.Update();
     dnn_output->rt_stat->output_fps = output_stat_.Get();
-    if (post_process) {
-      post_process(dnn_output);
-    }
-    return 0;
+    ctx->skip_infer = true;
+    return true;
   }
 
   // 需要推理
+  // 排队时已经超过截止时间的请求不再申请task
+  SetRunDeadline(ctx);
+  if (IsRunExpired(ctx)) {
+    MarkRunExpired(ctx);
+    RunPostProcessStage(ctx);
+    return false;
+  }
 
   // 1 申请推理task
-  auto task_id = AllocTask(alloctask_timeout_ms);
-  if (task_id < 0) {
-    return -1;
+  // 确定推理使用的模型，模型热替换后已经申请task的请求继续使用旧模型
+  if (!ctx->rt_para) {
+    ctx->rt_para = GetRunTimePara();
+  }
+  // 等待task的时间不超过截止时间
+  int alloctask_timeout_ms = ctx->alloctask_timeout_ms;
+  int64_t remain_ms = GetDeadlineRemainMs(ctx);
+  if (remain_ms > 0 &&
+      (alloctask_timeout_ms <= 0 || remain_ms < alloctask_timeout_ms)) {
+    alloctask_timeout_ms = static_cast<int>(remain_ms);
+  }
+  auto alloc_start_tp = std::chrono::steady_clock::now();
+  ctx->task_id =
+      AllocTask(alloctask_timeout_ms, ctx->rt_para, &ctx->task_lease);
+  ctx->alloc_done_tp = std::chrono::steady_clock::now();
+  latency_recorder_.Record(
+      DnnNodeLatencyStage::AllocWait, alloc_start_tp, ctx->alloc_done_tp);
+  DNN_TRACE_EVENT("alloc_task",
+                  alloc_start_tp,
+                  ctx->alloc_done_tp,
+                  ctx->frame_stamp_ns);
+  if (ctx->task_id < 0) {
+    if (IsRunExpired(ctx)) {
+      MarkRunExpired(ctx);
+      RunPostProcessStage(ctx);
+      return false;
+    }
+    ctx->ret = -1;
+    OnRunFailed(ctx);
+    return false;
+  }
+
+  {
+    // 记录占用task的帧，用于查询task状态
+    std::lock_guard<std::mutex> lg(ctx->rt_para->task_mtx);
+    auto running_task = ctx->rt_para->running_tasks.find(ctx->task_id);
+    if (running_task != ctx->rt_para->running_tasks.end()) {
+      ctx->node_task = running_task->second;
+      ctx->node_task->frame_id =
+          dnn_output->msg_header ? dnn_output->msg_header->frame_id : "";
+      ctx->node_task->frame_stamp_ns = ctx->frame_stamp_ns;
+      ctx->node_task->infer_core_id = -1;
+    }
+    ctx->running_task_num =
+        static_cast<int>(ctx->rt_para->running_tasks.size());
   }
 
   // 检查任务是否正常
-  auto infer_task = std::dynamic_pointer_cast<Task>(GetTask(task_id));
-  if (!infer_task) {
+  ctx->task = GetTask(ctx->task_id, ctx->rt_para);
+  if (!ctx->task) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Invalid infer task");
-    return -1;
+    ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+    ctx->ret = -1;
+    OnRunFailed(ctx);
+    return false;
   }
 
   // 2 将准备好的模型输入数据inputs通过前处理接口输入给模型
   // 并通过推理任务的task_id指定推理任务
-  if (PreProcess(inputs, tensor_inputs, input_type, task_id, rois) != 0) {
+  if (PreProcess(ctx->dnn_inputs,
+                 ctx->tensor_inputs,
+                 ctx->input_type,
+                 ctx->task,
+                 ctx->rois) != 0) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Run PreProcess failed!");
-    return -1;
+    ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+    ctx->ret = -1;
+    OnRunFailed(ctx);
+    return false;
   }
 
   // 3 进行预处理
-  int ret = 0;
-  ret = RunProcessInput(task_id, input_type);
-  if (ret != 0) {
-    return ret;
+  ctx->ret = RunProcessInput(ctx->task, ctx->input_type);
+  if (ctx->ret != 0) {
+    ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+    OnRunFailed(ctx);
+    return false;
+  }
+
+  // 4 使用用户提供的输出tensor，BPU直接写入，推理后原样通过output_tensors输出
+  if (!ctx->output_tensors.empty()) {
+    auto model_task = std::dynamic_pointer_cast<ModelInferTask>(ctx->task);
+    ctx->ret = model_task ? model_task->SetOutputTensors(ctx->output_tensors)
+                          : HB_DNN_INVALID_ARGUMENT;
+    if (ctx->ret != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Set output tensors failed, ret[%d]",
+                   ctx->ret);
+      ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+      OnRunFailed(ctx);
+      return false;
+    }
+  }
+  ctx->preprocess_done_tp = std::chrono::steady_clock::now();
+  latency_recorder_.Record(DnnNodeLatencyStage::PreProcess,
+                           ctx->alloc_done_tp,
+                           ctx->preprocess_done_tp);
+  DNN_TRACE_EVENT("preprocess",
+                  ctx->alloc_done_tp,
+                  ctx->preprocess_done_tp,
+                  ctx->frame_stamp_ns);
+  return true;
+}
+
+void DnnNodeImpl::RunInferStage(const DnnNodeRunContextPtr &ctx) {
+  if (ctx->skip_infer) {
+    return;
+  }
+
+  // 前处理和排队后已经超过截止时间的请求不再提交推理
+  if (IsRunExpired(ctx)) {
+    ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+    MarkRunExpired(ctx);
+    return;
   }
 
   // 4 执行模型推理
-  ret = RunInferTask(dnn_output, GetTask(task_id), infer_timeout_ms);
-  if (ret != 0) {
+  ctx->ret = RunInferTask(ctx);
+  FinishInferStage(ctx);
+}
+
+void DnnNodeImpl::MarkInferDone(const DnnNodeRunContextPtr &ctx) {
+  ctx->infer_done_tp = std::chrono::steady_clock::now();
+  latency_recorder_.Record(
+      DnnNodeLatencyStage::BpuExec, ctx->submit_done_tp, ctx->infer_done_tp);
+  // 同步推理在推理线程中等待，异步推理在reactor线程中等待
+  DNN_TRACE_EVENT("wait_infer_done",
+                  ctx->submit_done_tp,
+                  ctx->infer_done_tp,
+                  ctx->frame_stamp_ns);
+}
+
+void DnnNodeImpl::ReleaseBpuResource(const DnnNodeRunContextPtr &ctx) {
+  auto &node_task = ctx->node_task;
+  if (!node_task) {
+    return;
+  }
+  // task被watchdog回收时BPU资源可能已经被watchdog释放
+  if (node_task->core_acquired.exchange(false)) {
+    auto service_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - ctx->infer_start_tp)
+                          .count();
+    ctx->rt_para->core_scheduler->Release(
+        ctx->bpu_core_id, service_us, ctx->ret == 0);
+  }
+  if (node_task->arbiter_granted.exchange(false)) {
+    BpuArbiter::Instance().Release();
+  }
+}
+
+void DnnNodeImpl::FinishInferStage(const DnnNodeRunContextPtr &ctx) {
+  ReleaseBpuResource(ctx);
+  if (ctx->ret == HB_DNN_TIMEOUT) {
+    std::lock_guard<std::mutex> lk(task_stat_mtx_);
+    task_stat_.infer_timeout++;
+  } else if (ctx->ret == DNN_NODE_ARBITER_TIMEOUT) {
+    std::lock_guard<std::mutex> lk(task_stat_mtx_);
+    task_stat_.arbiter_timeout++;
+  }
+  if (ctx->ret != 0) {
     RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Run infer fail\n");
+    ctx->output->status = DnnNodeOutputStatus::INFER_FAILED;
   } else {
     // 统计输出fps
-    dnn_output->rt_stat->fps_updated = output_stat_.Update();
-    dnn_output->rt_stat->output_fps = output_stat_.Get();
+    ctx->output->rt_stat->fps_updated = output_stat_.Update();
+    ctx->output->rt_stat->output_fps = output_stat_.Get();
   }
 
   // 5 推理任务资源释放
-  ReleaseTask(task_id);
-  
+  ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+}
+
+void DnnNodeImpl::SubmitInferStage(const DnnNodeRunContextPtr &ctx) {
+  if (IsRunExpired(ctx)) {
+    ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+    MarkRunExpired(ctx);
+    PushPostProcessStage(ctx);
+    return;
+  }
+
+  // 4 提交推理任务，推理完成后reactor只释放BPU资源并转交给后处理阶段，
+  // 获取输出和释放task在后处理阶段执行，避免阻塞reactor线程
+  ctx->ret = SubmitInferTask(ctx);
+  if (ctx->ret == 0) {
+    ctx->ret = thread_pool_->reactor_->Submit(
+        ctx->task,
+        ctx->infer_timeout_ms,
+        [this, ctx](int32_t code) {
+          ctx->ret = code;
+          MarkInferDone(ctx);
+          ReleaseBpuResource(ctx);
+          ctx->finish_in_postprocess = true;
+          // 推理中的请求数不超过task_num，不等待后处理队列的空位
+          if (!thread_pool_->postprocess_stage_->PushForce(ctx)) {
+            RunPostProcessStage(ctx);
+          }
+        });
+    if (ctx->ret == 0) {
+      return;
+    }
+  }
+  FinishInferStage(ctx);
+  PushPostProcessStage(ctx);
+}
+
+void DnnNodeImpl::DiscardInferStage(const DnnNodeRunContextPtr &ctx) {
+  if (ctx->skip_infer) {
+    // 不需要推理的请求直接输出
+    RunPostProcessStage(ctx);
+    return;
+  }
+  // 等待推理的请求已经申请了task
+  ReleaseTask(ctx->task_id, ctx->rt_para, ctx->task_lease);
+  DiscardRunContext(ctx, DnnNodeOutputStatus::DROPPED);
+}
+
+void DnnNodeImpl::PushPostProcessStage(const DnnNodeRunContextPtr &ctx) {
+  // 后处理阶段已经停止时在当前线程中执行后处理，保证每个请求都有输出
+  if (!thread_pool_->postprocess_stage_->Push(ctx)) {
+    RunPostProcessStage(ctx);
+  }
+}
+
+void DnnNodeImpl::RunPostProcessStage(const DnnNodeRunContextPtr &ctx) {
+  // 5 reactor完成的推理在后处理线程中获取输出并释放task
+  if (ctx->finish_in_postprocess) {
+    ctx->finish_in_postprocess = false;
+    if (ctx->ret == 0) {
+      ctx->ret = GetInferOutput(ctx);
+    }
+    FinishInferStage(ctx);
+  }
+
   // 6 执行模型后处理
   // 即使推理失败，也要将对应的（空）结果输出，保证每个推理输入都有输出。
-  if (post_process) {
-    post_process(dnn_output);
+  auto postprocess_start_tp = std::chrono::steady_clock::now();
+  auto postprocess_end_tp = postprocess_start_tp;
+  if (ctx->post_process) {
+    ctx->post_process(ctx->output);
+    postprocess_end_tp = std::chrono::steady_clock::now();
+    latency_recorder_.Record(DnnNodeLatencyStage::PostProcess,
+                             postprocess_start_tp,
+                             postprocess_end_tp);
+    DNN_TRACE_EVENT("postprocess",
+                    postprocess_start_tp,
+                    postprocess_end_tp,
+                    ctx->frame_stamp_ns);
+  }
+
+  // 端到端耗时从消息的时间戳开始计算，时间戳是系统时间
+  if (ctx->frame_stamp_ns > 0) {
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    latency_recorder_.Record(DnnNodeLatencyStage::EndToEnd,
+                             now_ns - ctx->frame_stamp_ns);
   }
 
+  if (flight_recorder_) {
+    RecordFlight(ctx, postprocess_start_tp, postprocess_end_tp);
+  }
+}
+
+int DnnNodeImpl::GetQueueDepth() {
+  if (!thread_pool_) {
+    return 0;
+  }
+  size_t depth = 0;
+  if (thread_pool_->pending_runs_) {
+    depth += thread_pool_->pending_runs_->Size();
+  }
+  if (thread_pool_->preprocess_stage_) {
+    depth += thread_pool_->preprocess_stage_->Size();
+  }
+  if (thread_pool_->infer_stage_) {
+    depth += thread_pool_->infer_stage_->Size();
+  }
+  return static_cast<int>(depth);
+}
+
+void DnnNodeImpl::RecordFlight(
+    const DnnNodeRunContextPtr &ctx,
+    const std::chrono::steady_clock::time_point &postprocess_start_tp,
+    const std::chrono::steady_clock::time_point &postprocess_done_tp) {
+  // 相对于请求创建的时刻，没有经过的阶段为-1
+  auto since_create_us =
+      [&ctx](const std::chrono::steady_clock::time_point &tp) -> int64_t {
+    if (tp.time_since_epoch().count() == 0) {
+      return -1;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               tp - ctx->create_tp)
+        .count();
+  };
+
+  FlightRecord record;
+  record.frame_stamp_ns = ctx->frame_stamp_ns;
+  record.stream_id = ctx->stream_id;
+  record.task_id = ctx->task_id;
+  record.bpu_core_id = ctx->bpu_core_id;
+  record.ret = ctx->ret;
+  if (ctx->output) {
+    record.status = static_cast<int>(ctx->output->status);
+  }
+  record.preprocess_start_us = since_create_us(ctx->preprocess_start_tp);
+  record.alloc_done_us = since_create_us(ctx->alloc_done_tp);
+  record.preprocess_done_us = since_create_us(ctx->preprocess_done_tp);
+  record.submit_done_us = since_create_us(ctx->submit_done_tp);
+  record.infer_done_us = since_create_us(ctx->infer_done_tp);
+  record.parse_done_us = since_create_us(ctx->parse_done_tp);
+  record.postprocess_start_us = since_create_us(postprocess_start_tp);
+  record.postprocess_done_us = since_create_us(postprocess_done_tp);
+  if (ctx->frame_stamp_ns > 0) {
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    record.end_to_end_us = (now_ns - ctx->frame_stamp_ns) / 1000;
+  } else {
+    // 没有时间戳时从创建请求开始计算，不包含消息到达dnn node之前的耗时
+    record.end_to_end_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - ctx->create_tp)
+            .count();
+  }
+  record.queue_depth = ctx->queue_depth;
+  record.running_task_num = ctx->running_task_num;
+  if (ctx->rt_para && ctx->rt_para->output_tensor_pool) {
+    auto pool_stat = ctx->rt_para->output_tensor_pool->GetStat();
+    record.tensor_alloc_count = pool_stat.total_count;
+    record.tensor_wait_count = pool_stat.wait_count;
+  }
+  flight_recorder_->Add(record);
+
+  int threshold_ms = dnn_node_para_ptr_->flight_recorder_threshold_ms;
+  if (threshold_ms <= 0 || record.end_to_end_us <= threshold_ms * 1000LL) {
+    return;
+  }
+  // 以触发导出的帧的时间戳命名，没有时间戳时使用当前的系统时间
+  int64_t name_stamp_ns = ctx->frame_stamp_ns;
+  if (name_stamp_ns <= 0) {
+    name_stamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+  }
+  char stamp[32] = {0};
+  snprintf(stamp,
+           sizeof(stamp),
+           "%" PRId64 ".%09" PRId64,
+           static_cast<int64_t>(name_stamp_ns / 1000000000LL),
+           static_cast<int64_t>(name_stamp_ns % 1000000000LL));
+  std::string file_name = dnn_node_para_ptr_->flight_recorder_dir +
+                          "/dnn_flight_" + model_name_ + "_" + stamp + ".csv";
+  std::stringstream title;
+  title << "model: " << model_name_ << ", frame stamp: " << stamp
+        << ", end to end: " << record.end_to_end_us
+        << " us, threshold: " << threshold_ms << " ms";
+  if (flight_recorder_->DumpAsync(file_name, title.str())) {
+    RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                "Model: %s end to end latency %" PRId64
+                " us exceeds %d ms, dump flight records",
+                model_name_.c_str(),
+                record.end_to_end_us,
+                threshold_ms);
+  }
+}
+
+static const char *GetTaskStatusName(TaskStatus status) {
+  switch (status) {
+    case TaskStatus::ALLOCATED:
+      return "ALLOCATED";
+    case TaskStatus::INPUT_PROCESS_DONE:
+      return "INPUT_PROCESS_DONE";
+    case TaskStatus::INFERRING:
+      return "INFERRING";
+    case TaskStatus::INFERENCE_TIMEOUT:
+      return "INFERENCE_TIMEOUT";
+    case TaskStatus::INFERENCE_DONE:
+      return "INFERENCE_DONE";
+    case TaskStatus::OUTPUT_PARSE_DONE:
+      return "OUTPUT_PARSE_DONE";
+    case TaskStatus::TERMINATED:
+      return "TERMINATED";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+DnnNodeTaskTable DnnNodeImpl::GetTaskTable() {
+  DnnNodeTaskTable table;
+  table.model_name = model_name_;
+  auto rt_para = GetRunTimePara();
+  if (rt_para) {
+    auto tp_now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lg(rt_para->task_mtx);
+    for (size_t idx = 0; idx < rt_para->tasks.size(); idx++) {
+      DnnNodeTaskInfo info;
+      info.task_id = static_cast<TaskId>(idx);
+      if (rt_para->tasks[idx]) {
+        info.status = GetTaskStatusName(rt_para->tasks[idx]->GetStatus());
+      }
+      auto running_task = rt_para->running_tasks.find(info.task_id);
+      if (running_task != rt_para->running_tasks.end()) {
+        const auto &node_task = running_task->second;
+        info.running = true;
+        info.bpu_core_id = node_task->infer_core_id;
+        info.age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          tp_now - node_task->alloc_tp)
+                          .count();
+        info.frame_id = node_task->frame_id;
+        info.frame_stamp_ns = node_task->frame_stamp_ns;
+      }
+      table.tasks.push_back(info);
+    }
+  }
+
+  if (thread_pool_) {
+    if (thread_pool_->pending_runs_) {
+      table.pending_run_num =
+          static_cast<int>(thread_pool_->pending_runs_->Size());
+    }
+    if (thread_pool_->preprocess_stage_) {
+      table.preprocess_queue_depth =
+          static_cast<int>(thread_pool_->preprocess_stage_->Size());
+    }
+    if (thread_pool_->infer_stage_) {
+      table.infer_queue_depth =
+          static_cast<int>(thread_pool_->infer_stage_->Size());
+    }
+    if (thread_pool_->postprocess_stage_) {
+      table.postprocess_queue_depth =
+          static_cast<int>(thread_pool_->postprocess_stage_->Size());
+    }
+    if (thread_pool_->reactor_) {
+      table.reactor_inflight_num = thread_pool_->reactor_->GetInflightNum();
+    }
+  }
+  return table;
+}
+
+int DnnNodeImpl::DumpFlightRecord(const std::string &file_name) {
+  if (!flight_recorder_) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Flight recorder is disabled, flight_recorder_frame_num: %d",
+                 dnn_node_para_ptr_->flight_recorder_frame_num);
+    return -1;
+  }
+  return flight_recorder_->Dump(file_name, "model: " + model_name_);
+}
+
+int DnnNodeImpl::PipelineInit() {
+  int infer_thread_num = dnn_node_para_ptr_->infer_thread_num;
+  if (infer_thread_num <= 0) {
+    infer_thread_num = dnn_node_para_ptr_->task_num;
+  }
+  if (dnn_node_para_ptr_->preprocess_queue_depth < 1 ||
+      dnn_node_para_ptr_->infer_queue_depth < 1 ||
+      dnn_node_para_ptr_->postprocess_queue_depth < 1 ||
+      dnn_node_para_ptr_->preprocess_thread_num < 1 ||
+      dnn_node_para_ptr_->postprocess_thread_num < 1) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Invalid pipeline para, queue depth and thread num of each "
+                 "stage should be positive");
+    return -1;
+  }
+
+  // 按照数据流向的逆序创建，保证前一阶段创建时后一阶段已经可用
+  thread_pool_->postprocess_stage_ =
+      std::make_shared<hobot::PipelineStage<DnnNodeRunContextPtr>>(
+          dnn_node_para_ptr_->postprocess_queue_depth,
+          dnn_node_para_ptr_->postprocess_thread_num,
+          [this](DnnNodeRunContextPtr &ctx) { RunPostProcessStage(ctx); });
+  if (dnn_node_para_ptr_->enable_completion_reactor) {
+    // BPU推理阶段的线程只提交推理任务，由reactor等待推理完成
+    thread_pool_->reactor_ = std::make_shared<InferCompletionReactor>(
+        dnn_node_para_ptr_->reactor_poll_timeout_ms,
+        dnn_node_para_ptr_->reactor_busy_poll);
+    if (thread_pool_->reactor_->Start() != 0) {
+      return -1;
+    }
+    if (dnn_node_para_ptr_->infer_thread_num <= 0) {
+      infer_thread_num = 1;
+    }
+  }
+  thread_pool_->infer_stage_ =
+      std::make_shared<hobot::PipelineStage<DnnNodeRunContextPtr>>(
+          dnn_node_para_ptr_->infer_queue_depth,
+          infer_thread_num,
+          [this](DnnNodeRunContextPtr &ctx) {
+            if (thread_pool_->reactor_ && !ctx->skip_infer) {
+              SubmitInferStage(ctx);
+              return;
+            }
+            RunInferStage(ctx);
+            PushPostProcessStage(ctx);
+          });
+  thread_pool_->preprocess_stage_ =
+      std::make_shared<hobot::PipelineStage<DnnNodeRunContextPtr>>(
+          dnn_node_para_ptr_->preprocess_queue_depth,
+          dnn_node_para_ptr_->preprocess_thread_num,
+          [this](DnnNodeRunContextPtr &ctx) {
+            if (RunPreProcessStage(ctx) &&
+                !thread_pool_->infer_stage_->Push(ctx)) {
+              // 推理阶段已经停止
+              DiscardInferStage(ctx);
+            }
+          });
+
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Pipeline enabled, queue depth [%d, %d, %d], thread num [%d, "
+              "%d, %d]",
+              dnn_node_para_ptr_->preprocess_queue_depth,
+              dnn_node_para_ptr_->infer_queue_depth,
+              dnn_node_para_ptr_->postprocess_queue_depth,
+              dnn_node_para_ptr_->preprocess_thread_num,
+              infer_thread_num,
+              dnn_node_para_ptr_->postprocess_thread_num);
   return 0;
 }
 
@@ -46,6 +46,8 @@ int32_t Model::GetInputCount() { return input_count_; }
 
 int32_t Model::GetBatchInputCount() { return batch_input_count_; }
 
+int32_t Model::GetBatchSize() { return batch_size_; }
+
 int32_t Model::GetInputTensorProperties(
     hbDNNTensorProperties &tensor_properties, int32_t input_index) {
   RETURN_IF_FAILED(hbDNNGetInputTensorProperties(
@@ -76,8 +76,11 @@ int32_t ModelInferTask::SetInputs(
     }
     inputs_[i] = inputs[i];
   }
-  input_tensors_.resize(static_cast<size_t>(batch_input_count));
-  input_dnn_tensors_.resize(static_cast<size_t>(batch_input_count));
+  if (input_dnn_tensors_.size() != static_cast<size_t>(batch_input_count)) {
+    // input_dnn_tensors_ may be reallocated, drop tensors referring to it
+    input_tensors_.assign(static_cast<size_t>(batch_input_count), nullptr);
+    input_dnn_tensors_.resize(static_cast<size_t>(batch_input_count));
+  }
   return HB_DNN_SUCCESS;
 }
 
@@ -103,11 +106,58 @@ int32_t ModelInferTask::GetOutputTensors(
   return HB_DNN_SUCCESS;
 }
 
+int32_t ModelInferTask::SetOutputTensors(
+    std::vector<std::shared_ptr<DNNTensor>> &output_tensors) {
+  auto const output_count{model_->GetOutputCount()};
+  if (output_tensors.size() != static_cast<size_t>(output_count)) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Output tensors size %zu != model output count %d",
+                 output_tensors.size(),
+                 output_count);
+    return HB_DNN_INVALID_ARGUMENT;
+  }
+  for (int32_t i{0}; i < output_count; i++) {
+    auto &tensor = output_tensors[i];
+    hbDNNTensorProperties properties;
+    model_->GetOutputTensorProperties(properties, i);
+    uint32_t const mem_size{TensorPool::GetTensorMemSize(properties)};
+    if (tensor == nullptr || tensor->sysMem[0].virAddr == nullptr ||
+        tensor->sysMem[0].memSize < mem_size) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Invalid output tensor for branch: %d, mem size %u is "
+                   "needed",
+                   i,
+                   mem_size);
+      return HB_DNN_INVALID_ARGUMENT;
+    }
+  }
+  for (int32_t i{0}; i < output_count; i++) {
+    auto &tensor = output_tensors[i];
+    model_->GetOutputTensorProperties(tensor->properties, i);
+    output_tensors_[i] = tensor;
+    output_dnn_tensors_[i] = *tensor;
+  }
+  user_output_ = true;
+  return HB_DNN_SUCCESS;
+}
+
 void ModelInferTask::Reset() {
   Task::Reset();
-  inputs_.clear();
-  input_tensors_.clear();
-  output_tensors_.clear();
+  if (user_output_) {
+    // caller owned output tensors are used once, alloc from pool next time
+    std::fill(output_tensors_.begin(), output_tensors_.end(), nullptr);
+    user_output_ = false;
+  }
+  std::fill(inputs_.begin(), inputs_.end(), nullptr);
+  // keep input tensors which only describe internal input_dnn_tensors_,
+  // release the ones set by user with SetInputTensors
+  for (size_t i{0U}; i < input_tensors_.size(); i++) {
+    if (i >= input_dnn_tensors_.size() ||
+        input_tensors_[i].get() != &input_dnn_tensors_[i]) {
+      input_tensors_[i] = nullptr;
+    }
+  }
+  // output_tensors_ are kept and reused in PrepareInferInputOutput
 }
 
 int32_t ModelInferTask::ProcessInput() {
@@ -115,7 +165,9 @@ int32_t ModelInferTask::ProcessInput() {
   // and do batch separate infer
   auto const input_tensor_size{1};
   auto const model_input_count{model_->GetInputCount()};
-  auto const batch_size{1};
+  // pyramid batch inputs are separate, inputs_[i] is sample i % batch_size
+  // of input branch i / batch_size
+  auto const batch_size{std::max(model_->GetBatchSize(), 1)};
   if (model_input_count != input_tensor_size) {
     int32_t index{input_tensor_size - 1};
     for (int32_t i{model_input_count - 1}; i >= 0; i--) {
@@ -148,7 +200,9 @@ int32_t ModelInferTask::ProcessInput() {
       std::shared_ptr<CropProcessor> input_processor = std::make_shared<CropProcessor>();
 
       hbDNNTensorProperties tensor_properties;
-      hbDNNGetInputTensorProperties(&tensor_properties, model_->GetDNNHandle(), i);
+      hbDNNGetInputTensorProperties(&tensor_properties,
+                                    model_->GetDNNHandle(),
+                                    static_cast<int32_t>(i) / batch_size);
       if (tensor_properties.tensorLayout == HB_DNN_LAYOUT_NHWC) {
         input_conf->width = tensor_properties.validShape.dimensionSize[2];
         input_conf->height = tensor_properties.validShape.dimensionSize[1];
@@ -177,7 +231,9 @@ int32_t ModelInferTask::ProcessInput() {
 
 int32_t ModelInferTask::RunInfer() {
 
-  RETURN_IF_FAILED(PrepareInferInputOutput());
+  if (!infer_io_prepared_) {
+    RETURN_IF_FAILED(PrepareInferInputOutput());
+  }
   ctrl_param_.more = false;
   auto *output_ptr{output_dnn_tensors_.data()};
 
@@ -232,7 +288,10 @@ int32_t ModelInferTask::PrepareInferInputOutput() {
   output_dnn_tensors_.resize(static_cast<size_t>(output_count));
 
   for (int32_t i{0}; i < output_count; i++) {
-    if (output_tensors_[i] == nullptr) {
+    // output tensor of last inference is still held by user, alloc a new one
+    // caller owned output tensors are always held by user and used directly
+    if (!user_output_ && (output_tensors_[i] == nullptr ||
+                          output_tensors_[i].use_count() > 1)) {
       model_->GetOutputTensorProperties(
           output_dnn_tensors_[i].properties, i);
 
@@ -248,6 +307,7 @@ int32_t ModelInferTask::PrepareInferInputOutput() {
       output_dnn_tensors_[i] = *output_tensor;
     }
   }
+  infer_io_prepared_ = true;
   return HB_DNN_SUCCESS;
 }
 
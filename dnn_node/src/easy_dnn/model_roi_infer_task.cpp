@@ -144,9 +144,11 @@ int32_t ModelRoiInferTask::ProcessInput() {
 
 int32_t ModelRoiInferTask::RunInfer() {
   
-  int ret = PrepareInferInputOutput();
-  if (ret != 0) {
-    return ret;
+  if (!infer_io_prepared_) {
+    int ret = PrepareInferInputOutput();
+    if (ret != 0) {
+      return ret;
+    }
   }
 
   ctrl_param_.more = false;
@@ -193,21 +195,32 @@ int32_t ModelRoiInferTask::PrepareInferInputOutput() {
   auto const alloc_tensor{[this, &roi_num](
                               int32_t const i,
                               hbDNNTensorProperties properties) -> int32_t {
-    properties.alignedShape.dimensionSize[0] *= roi_num;
-    properties.validShape.dimensionSize[0] *= roi_num;
-    properties.alignedByteSize *= roi_num;
-    real_mem_size_[i] = properties.alignedByteSize;
+    // round roi capacity up to power of 2, limit the number of size classes
+    // in tensor pool and make the tensor reusable for more rois
+    int32_t roi_capacity{1};
+    while (roi_capacity < roi_num) {
+      roi_capacity <<= 1;
+    }
+    auto alloc_properties{properties};
+    alloc_properties.alignedShape.dimensionSize[0] *= roi_capacity;
+    alloc_properties.validShape.dimensionSize[0] *= roi_capacity;
+    alloc_properties.alignedByteSize *= roi_capacity;
+    real_mem_size_[i] = alloc_properties.alignedByteSize;
     RCLCPP_DEBUG(rclcpp::get_logger("dnn"), 
         "Alloc output tensor for branch {%d} internal, alloc mem size {%d}.",
         i,
         real_mem_size_[i]);
 
-    auto const output_tensor{AllocateTensor(properties)};
+    auto const output_tensor{AllocateTensor(alloc_properties)};
     if (output_tensor.get() == nullptr) {
       RCLCPP_ERROR(rclcpp::get_logger("dnn"), 
         "Allocate tensor failed, output branch: %d", i);
       return HB_DNN_OUT_OF_MEMORY;
     }
+    properties.alignedShape.dimensionSize[0] *= roi_num;
+    properties.validShape.dimensionSize[0] *= roi_num;
+    properties.alignedByteSize *= roi_num;
+    output_tensor->properties = properties;
     output_tensors_[i] = output_tensor;
     output_dnn_tensors_[i] = static_cast<hbDNNTensor>(*output_tensor);
     return HB_DNN_SUCCESS;
@@ -226,8 +239,11 @@ int32_t ModelRoiInferTask::PrepareInferInputOutput() {
     }
 
     int32_t const need_size{properties.alignedByteSize * roi_num};
-    if ((output_tensors_[i] != nullptr)) {
-      if (real_mem_size_[i] > need_size) {
+    // output tensor of last inference is still held by user, alloc a new one
+    bool const in_use{output_tensors_[i] != nullptr &&
+                      output_tensors_[i].use_count() > 1};
+    if ((output_tensors_[i] != nullptr) && !in_use) {
+      if (real_mem_size_[i] >= need_size) {
         RCLCPP_DEBUG(rclcpp::get_logger("dnn"), 
             "Use EasyDNN internal tensor for branch {%d}, the real mem size is "
             "{%d}, need mem size is {%d}.",
@@ -248,7 +264,7 @@ int32_t ModelRoiInferTask::PrepareInferInputOutput() {
             need_size);
         RETURN_IF_FAILED(alloc_tensor(i, properties));
       } 
-    } else if (output_tensors_[i] == nullptr) {
+    } else {
       RCLCPP_DEBUG  (rclcpp::get_logger("dnn"), 
             "Alloc internal tensor for branch {%d}, alloc mem size {%d}.",
             i,
@@ -284,6 +300,7 @@ int32_t ModelRoiInferTask::PrepareInferInputOutput() {
       roi_output_tensors_[i][j] = slice;
     }
   }
+  infer_io_prepared_ = true;
   return HB_DNN_SUCCESS;
 }
 
@@ -293,8 +310,8 @@ void ModelRoiInferTask::Reset() {
   inputs_.clear();
   input_tensors_.clear();
   roi_output_tensors_.clear();
-  output_tensors_.clear();
-  real_mem_size_.clear();
+  // output_tensors_ and real_mem_size_ are kept and reused in
+  // PrepareInferInputOutput
 }
 
 }  // namespace easy_dnn
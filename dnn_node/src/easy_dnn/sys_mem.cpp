@@ -0,0 +1,221 @@
+// Copyright (c) [2024] [Horizon Robotics].
+//
+// You can use this software according to the terms and conditions of
+// the Apache v2.0.
+// You may obtain a copy of Apache v2.0. at:
+//
+//     http: //www.apache.org/licenses/LICENSE-2.0
+//
+// THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+// See Apache v2.0 for more details.
+
+#include "easy_dnn/sys_mem.h"
+
+#include <cinttypes>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "dnn/hb_dnn_status.h"
+
+namespace hobot {
+namespace easy_dnn {
+
+SysMemAccounting &SysMemAccounting::Instance() {
+  static SysMemAccounting accounting;
+  return accounting;
+}
+
+SysMemAccounting::SysMemAccounting()
+    : rate_tp_(std::chrono::steady_clock::now()) {}
+
+bool SysMemAccounting::Reserve(Counter &counter, uint64_t size) {
+  uint64_t live_bytes = counter.live_bytes.fetch_add(size) + size;
+  uint64_t budget_bytes = counter.budget_bytes.load();
+  if (budget_bytes > 0 && live_bytes > budget_bytes) {
+    counter.live_bytes.fetch_sub(size);
+    counter.over_budget_count++;
+    return false;
+  }
+  UpdatePeak(counter, live_bytes);
+  return true;
+}
+
+void SysMemAccounting::UpdatePeak(Counter &counter, uint64_t live_bytes) {
+  uint64_t peak_bytes = counter.peak_bytes.load();
+  while (live_bytes > peak_bytes &&
+         !counter.peak_bytes.compare_exchange_weak(peak_bytes, live_bytes)) {
+  }
+}
+
+void SysMemAccounting::Unreserve(Counter &counter, uint64_t size) {
+  counter.live_bytes.fetch_sub(size);
+}
+
+int32_t SysMemAccounting::Alloc(hbSysMem *mem,
+                                uint32_t size,
+                                SysMemCategory category,
+                                bool cached) {
+  if (!mem || category >= SysMemCategory::CATEGORY_NUM) {
+    return HB_DNN_INVALID_ARGUMENT;
+  }
+  auto &counter = counters_[static_cast<size_t>(category)];
+  auto &total = counters_[kCounterNum - 1];
+
+  // reserve before allocating, so concurrent allocations can not exceed
+  // the budget together
+  if (!Reserve(counter, size)) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Alloc %u bytes of %s exceeds budget %" PRIu64
+                 ", live bytes: %" PRIu64,
+                 size,
+                 GetCategoryName(category),
+                 static_cast<uint64_t>(counter.budget_bytes.load()),
+                 static_cast<uint64_t>(counter.live_bytes.load()));
+    counter.fail_count++;
+    total.fail_count++;
+    return HB_DNN_OUT_OF_MEMORY;
+  }
+  if (!Reserve(total, size)) {
+    Unreserve(counter, size);
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Alloc %u bytes of %s exceeds total budget %" PRIu64
+                 ", live bytes: %" PRIu64,
+                 size,
+                 GetCategoryName(category),
+                 static_cast<uint64_t>(total.budget_bytes.load()),
+                 static_cast<uint64_t>(total.live_bytes.load()));
+    counter.over_budget_count++;
+    counter.fail_count++;
+    total.fail_count++;
+    return HB_DNN_OUT_OF_MEMORY;
+  }
+
+  int32_t ret = cached ? hbSysAllocCachedMem(mem, size)
+                       : hbSysAllocMem(mem, size);
+  if (ret != 0) {
+    Unreserve(counter, size);
+    Unreserve(total, size);
+    counter.fail_count++;
+    total.fail_count++;
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Alloc %u bytes of %s failed, ret: %d, live bytes of all "
+                 "categories: %" PRIu64,
+                 size,
+                 GetCategoryName(category),
+                 ret,
+                 static_cast<uint64_t>(total.live_bytes.load()));
+    return ret;
+  }
+  // the allocator may round up the size, account what Free will release
+  uint64_t mem_size = mem->memSize;
+  for (auto *c : {&counter, &total}) {
+    if (mem_size > size) {
+      UpdatePeak(*c, c->live_bytes.fetch_add(mem_size - size) + mem_size -
+                         size);
+    } else if (mem_size < size) {
+      c->live_bytes.fetch_sub(size - mem_size);
+    }
+    c->live_count++;
+    c->alloc_count++;
+    c->alloc_bytes += mem_size;
+  }
+  return ret;
+}
+
+int32_t SysMemAccounting::Free(hbSysMem *mem, SysMemCategory category) {
+  if (!mem || category >= SysMemCategory::CATEGORY_NUM) {
+    return HB_DNN_INVALID_ARGUMENT;
+  }
+  // size is read before free, the allocator may reset mem
+  uint64_t size = mem->memSize;
+  int32_t ret = hbSysFreeMem(mem);
+  auto &counter = counters_[static_cast<size_t>(category)];
+  auto &total = counters_[kCounterNum - 1];
+  for (auto *c : {&counter, &total}) {
+    Unreserve(*c, size);
+    c->live_count--;
+    c->free_count++;
+  }
+  return ret;
+}
+
+void SysMemAccounting::SetBudget(SysMemCategory category,
+                                 uint64_t budget_bytes) {
+  if (category > SysMemCategory::CATEGORY_NUM) {
+    return;
+  }
+  counters_[static_cast<size_t>(category)].budget_bytes = budget_bytes;
+}
+
+std::vector<SysMemStat> SysMemAccounting::GetStat() {
+  {
+    // refresh allocation rate at most once per second
+    std::lock_guard<std::mutex> lk(rate_mtx_);
+    auto tp_now = std::chrono::steady_clock::now();
+    double seconds =
+        std::chrono::duration<double>(tp_now - rate_tp_).count();
+    if (seconds >= 1.0) {
+      for (size_t idx = 0; idx < kCounterNum; idx++) {
+        uint64_t alloc_count = counters_[idx].alloc_count.load();
+        uint64_t alloc_bytes = counters_[idx].alloc_bytes.load();
+        alloc_count_per_sec_[idx] =
+            static_cast<double>(alloc_count - rate_alloc_count_[idx]) /
+            seconds;
+        alloc_bytes_per_sec_[idx] =
+            static_cast<double>(alloc_bytes - rate_alloc_bytes_[idx]) /
+            seconds;
+        rate_alloc_count_[idx] = alloc_count;
+        rate_alloc_bytes_[idx] = alloc_bytes;
+      }
+      rate_tp_ = tp_now;
+    }
+  }
+
+  std::vector<SysMemStat> stats;
+  for (size_t idx = 0; idx < kCounterNum; idx++) {
+    const auto &counter = counters_[idx];
+    SysMemStat stat;
+    stat.category = static_cast<SysMemCategory>(idx);
+    stat.name = GetCategoryName(stat.category);
+    stat.live_bytes = counter.live_bytes.load();
+    stat.live_count = counter.live_count.load();
+    stat.peak_bytes = counter.peak_bytes.load();
+    stat.alloc_count = counter.alloc_count.load();
+    stat.alloc_bytes = counter.alloc_bytes.load();
+    stat.free_count = counter.free_count.load();
+    stat.fail_count = counter.fail_count.load();
+    stat.over_budget_count = counter.over_budget_count.load();
+    stat.budget_bytes = counter.budget_bytes.load();
+    {
+      std::lock_guard<std::mutex> lk(rate_mtx_);
+      stat.alloc_count_per_sec = alloc_count_per_sec_[idx];
+      stat.alloc_bytes_per_sec = alloc_bytes_per_sec_[idx];
+    }
+    stats.push_back(stat);
+  }
+  return stats;
+}
+
+const char *SysMemAccounting::GetCategoryName(SysMemCategory category) {
+  switch (category) {
+    case SysMemCategory::TENSOR_POOL:
+      return "tensor_pool";
+    case SysMemCategory::TASK_OUTPUT:
+      return "task_output";
+    case SysMemCategory::IMAGE_PROC:
+      return "image_proc";
+    case SysMemCategory::WARMUP:
+      return "warmup";
+    case SysMemCategory::USER:
+      return "user";
+    case SysMemCategory::CATEGORY_NUM:
+      return "total";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace easy_dnn
+}  // namespace hobot
@@ -13,6 +13,8 @@
 
 #include "easy_dnn/task.h"
 
+#include "easy_dnn/sys_mem.h"
+
 namespace hobot {
 namespace easy_dnn {
 
@@ -28,48 +30,67 @@ int32_t Task::SetCtrlParam(hbDNNInferCtrlParam &ctrl_param) {
   return HB_DNN_SUCCESS;
 }
 
+void Task::SetTensorPool(std::shared_ptr<TensorPool> const &tensor_pool) {
+  tensor_pool_ = tensor_pool;
+}
+
 std::shared_ptr<DNNTensor> Task::AllocateTensor(
     hbDNNTensorProperties const &tensor_properties) {
+    if (tensor_pool_) {
+      return tensor_pool_->Acquire(tensor_properties);
+    }
 
     auto tensor = new DNNTensor;
 
     // 获取模型输出尺寸
-    int out_aligned_size = 4;
-    switch (tensor_properties.tensorType)
-    {
-      case HB_DNN_TENSOR_TYPE_S8:
-      case HB_DNN_TENSOR_TYPE_U8: out_aligned_size = 1; break;
-      case HB_DNN_TENSOR_TYPE_F16:
-      case HB_DNN_TENSOR_TYPE_S16: 
-      case HB_DNN_TENSOR_TYPE_U16: out_aligned_size = 2; break;
-      case HB_DNN_TENSOR_TYPE_F32:
-      case HB_DNN_TENSOR_TYPE_S32:
-      case HB_DNN_TENSOR_TYPE_U32: out_aligned_size = 4; break;
-      case HB_DNN_TENSOR_TYPE_F64:
-      case HB_DNN_TENSOR_TYPE_S64: 
-      case HB_DNN_TENSOR_TYPE_U64: out_aligned_size = 8; break;
-      default: std::cout << "Tensor Type " 
-        << tensor_properties.tensorType << " is not support" << std::endl; break;
-    }
-
-    for (int j = 0; j < tensor_properties.alignedShape.numDimensions; j++) {
-        out_aligned_size *= tensor_properties.alignedShape.dimensionSize[j];
-    }
+    uint32_t out_aligned_size = TensorPool::GetTensorMemSize(tensor_properties);
 
     hbSysMem *mem = new hbSysMem;
-    hbSysAllocCachedMem(mem, out_aligned_size);
+    if (SysMemAccounting::Instance().Alloc(
+            mem, out_aligned_size, SysMemCategory::TASK_OUTPUT) != 0) {
+      delete tensor;
+      delete mem;
+      return nullptr;
+    }
 
     tensor->properties = tensor_properties;
     tensor->sysMem[0] = *mem;
     
     return std::shared_ptr<DNNTensor>(tensor,
                                       [mem](DNNTensor *tensor) {
-                                        hbSysFreeMem(&(tensor->sysMem[0]));
+                                        SysMemAccounting::Instance().Free(
+                                            &(tensor->sysMem[0]),
+                                            SysMemCategory::TASK_OUTPUT);
                                         delete tensor;
                                         delete mem;
                                       });
 }
 
+int32_t Task::PollInferDone(int32_t timeout) {
+  int32_t code{HB_DNN_SUCCESS};
+  {
+    std::unique_lock<std::mutex> const lk{release_mtx_};
+    if (task_handle_ == nullptr) {
+      return HB_DNN_INVALID_TASK_HANDLE;
+    }
+    code = hbDNNWaitTaskDone(task_handle_, timeout);
+    if (code == HB_DNN_TIMEOUT) {
+      return code;
+    }
+    // release dnn task resource immediately, will not cost much time
+    hbDNNReleaseTask(task_handle_);
+    task_handle_ = nullptr;
+  }
+
+  if (code == HB_DNN_SUCCESS) {
+    SetStatus(TaskStatus::INFERENCE_DONE);
+  } else {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Task infer failed, ret[%d]", code);
+    SetStatus(TaskStatus::TERMINATED);
+  }
+  return code;
+}
+
 void Task::SetStatus(TaskStatus const status) {
   std::lock_guard<std::mutex> const lk{task_status_mutex_};
   if ((task_status_ == TaskStatus::TERMINATED) &&
@@ -87,6 +108,11 @@ void Task::SetStatus(TaskStatus const status) {
   task_status_ = status;
 }
 
+TaskStatus Task::GetStatus() {
+  std::lock_guard<std::mutex> const lk{task_status_mutex_};
+  return task_status_;
+}
+
 int32_t Task::SetModel(Model *model) {
 
   if (model_ != nullptr) {
@@ -102,9 +128,32 @@ int32_t Task::SetModel(Model *model) {
   return HB_DNN_SUCCESS;
 }
 
+int32_t Task::Cancel() {
+  // the waiting thread holds release_mtx_ until the task is done
+  std::unique_lock<std::mutex> lk{release_mtx_, std::try_to_lock};
+  if (!lk.owns_lock()) {
+    return HB_DNN_MODEL_IS_RUNNING;
+  }
+  if (task_handle_ != nullptr) {
+    hbDNNReleaseTask(task_handle_);
+    task_handle_ = nullptr;
+  }
+  lk.unlock();
+  SetStatus(TaskStatus::TERMINATED);
+  return HB_DNN_SUCCESS;
+}
+
 void Task::Reset() {
-  input_dnn_tensors_.clear();
-  output_dnn_tensors_.clear();
+  // tensor descriptors are kept, only per-inference states are reset
+  if (task_handle_ != nullptr) {
+    std::unique_lock<std::mutex> const lk{release_mtx_};
+    hbDNNReleaseTask(task_handle_);
+    task_handle_ = nullptr;
+  }
+  HB_DNN_INITIALIZE_INFER_CTRL_PARAM(&ctrl_param_);
+  infer_io_prepared_ = false;
+  std::lock_guard<std::mutex> const lk{task_status_mutex_};
+  task_status_ = TaskStatus::ALLOCATED;
 }
 
 }  // namespace easy_dnn
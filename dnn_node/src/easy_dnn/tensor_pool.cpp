@@ -0,0 +1,172 @@
+// Copyright (c) [2024] [Horizon Robotics].
+//
+// You can use this software according to the terms and conditions of
+// the Apache v2.0.
+// You may obtain a copy of Apache v2.0. at:
+//
+//     http: //www.apache.org/licenses/LICENSE-2.0
+//
+// THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+// See Apache v2.0 for more details.
+
+#include "easy_dnn/tensor_pool.h"
+
+#include <chrono>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "dnn/hb_dnn_status.h"
+#include "easy_dnn/sys_mem.h"
+
+namespace hobot {
+namespace easy_dnn {
+
+TensorPool::State::~State() {
+  for (auto &slab : slabs) {
+    for (auto &mem : slab.second.free_mems) {
+      SysMemAccounting::Instance().Free(&mem, SysMemCategory::TENSOR_POOL);
+    }
+  }
+}
+
+TensorPool::TensorPool(int32_t default_capacity, int32_t wait_timeout_ms)
+    : default_capacity_(default_capacity),
+      wait_timeout_ms_(wait_timeout_ms),
+      state_(std::make_shared<State>()) {}
+
+uint32_t TensorPool::GetTensorMemSize(
+    hbDNNTensorProperties const &tensor_properties) {
+  uint32_t mem_size = 4;
+  switch (tensor_properties.tensorType) {
+    case HB_DNN_TENSOR_TYPE_S8:
+    case HB_DNN_TENSOR_TYPE_U8: mem_size = 1; break;
+    case HB_DNN_TENSOR_TYPE_F16:
+    case HB_DNN_TENSOR_TYPE_S16:
+    case HB_DNN_TENSOR_TYPE_U16: mem_size = 2; break;
+    case HB_DNN_TENSOR_TYPE_F32:
+    case HB_DNN_TENSOR_TYPE_S32:
+    case HB_DNN_TENSOR_TYPE_U32: mem_size = 4; break;
+    case HB_DNN_TENSOR_TYPE_F64:
+    case HB_DNN_TENSOR_TYPE_S64:
+    case HB_DNN_TENSOR_TYPE_U64: mem_size = 8; break;
+    default:
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Tensor Type %d is not support",
+                  tensor_properties.tensorType);
+      break;
+  }
+
+  for (int j = 0; j < tensor_properties.alignedShape.numDimensions; j++) {
+    mem_size *= tensor_properties.alignedShape.dimensionSize[j];
+  }
+  return mem_size;
+}
+
+int32_t TensorPool::Reserve(hbDNNTensorProperties const &tensor_properties,
+                            int32_t capacity,
+                            int32_t prealloc_count) {
+  uint32_t const mem_size{GetTensorMemSize(tensor_properties)};
+  std::lock_guard<std::mutex> const lk{state_->mtx};
+  auto &slab = state_->slabs[mem_size];
+  slab.capacity += capacity;
+  for (int32_t i{0}; i < prealloc_count && slab.alloc_count < slab.capacity;
+       i++) {
+    hbSysMem mem;
+    if (SysMemAccounting::Instance().Alloc(
+            &mem, mem_size, SysMemCategory::TENSOR_POOL) != 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Tensor pool alloc mem size %u failed", mem_size);
+      return HB_DNN_OUT_OF_MEMORY;
+    }
+    slab.free_mems.push_back(mem);
+    slab.alloc_count++;
+    state_->stat.total_count++;
+    state_->stat.free_count++;
+  }
+  return HB_DNN_SUCCESS;
+}
+
+std::shared_ptr<DNNTensor> TensorPool::Acquire(
+    hbDNNTensorProperties const &tensor_properties) {
+  uint32_t const mem_size{GetTensorMemSize(tensor_properties)};
+  hbSysMem mem;
+  bool need_alloc = false;
+  {
+    std::unique_lock<std::mutex> lk{state_->mtx};
+    auto &slab = state_->slabs[mem_size];
+    if (slab.capacity == 0) {
+      slab.capacity = default_capacity_;
+    }
+    // a buffer is released by users, or a slot is given back by a failed
+    // allocation of another thread
+    auto pred = [&slab]() {
+      return !slab.free_mems.empty() || slab.alloc_count < slab.capacity;
+    };
+    if (!pred()) {
+      // all buffers are held by users, wait for output release
+      state_->stat.wait_count++;
+      if (wait_timeout_ms_ < 0) {
+        state_->cv.wait(lk, pred);
+      } else if (!state_->cv.wait_for(
+                     lk, std::chrono::milliseconds(wait_timeout_ms_), pred)) {
+        state_->stat.timeout_count++;
+        RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                    "Tensor pool of mem size %u is exhausted (capacity %d), "
+                    "output tensors are held by users too long",
+                    mem_size,
+                    slab.capacity);
+        return nullptr;
+      }
+    }
+    if (slab.free_mems.empty()) {
+      // take the slot here and alloc mem outside the lock
+      slab.alloc_count++;
+      state_->stat.total_count++;
+      need_alloc = true;
+    } else {
+      mem = slab.free_mems.back();
+      slab.free_mems.pop_back();
+      state_->stat.free_count--;
+    }
+  }
+
+  if (need_alloc && SysMemAccounting::Instance().Alloc(
+                        &mem, mem_size, SysMemCategory::TENSOR_POOL) != 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Tensor pool alloc mem size %u failed", mem_size);
+    {
+      std::lock_guard<std::mutex> const lk{state_->mtx};
+      state_->slabs[mem_size].alloc_count--;
+      state_->stat.total_count--;
+    }
+    // the slot is free again, wake up the threads waiting for it
+    state_->cv.notify_all();
+    return nullptr;
+  }
+
+  auto tensor = new DNNTensor;
+  tensor->properties = tensor_properties;
+  tensor->sysMem[0] = mem;
+
+  std::shared_ptr<State> state = state_;
+  return std::shared_ptr<DNNTensor>(
+      tensor, [state, mem, mem_size](DNNTensor *tensor) {
+        {
+          std::lock_guard<std::mutex> const lk{state->mtx};
+          state->slabs[mem_size].free_mems.push_back(mem);
+          state->stat.free_count++;
+        }
+        state->cv.notify_all();
+        delete tensor;
+      });
+}
+
+TensorPoolStat TensorPool::GetStat() {
+  std::lock_guard<std::mutex> const lk{state_->mtx};
+  return state_->stat;
+}
+
+}  // namespace easy_dnn
+}  // namespace hobot
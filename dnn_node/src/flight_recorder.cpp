@@ -0,0 +1,185 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/flight_recorder.h"
+
+#include <pthread.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace hobot {
+namespace dnn_node {
+
+FlightRecorder::FlightRecorder(size_t capacity, int min_dump_interval_ms)
+    : capacity_(capacity), min_dump_interval_ms_(min_dump_interval_ms) {
+  records_.reserve(capacity_);
+}
+
+FlightRecorder::~FlightRecorder() {
+  {
+    std::lock_guard<std::mutex> lk(dump_mtx_);
+    stop_ = true;
+  }
+  dump_cv_.notify_all();
+  if (dump_thread_ && dump_thread_->joinable()) {
+    dump_thread_->join();
+  }
+}
+
+void FlightRecorder::Add(const FlightRecord &record) {
+  if (capacity_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(records_mtx_);
+  if (records_.size() < capacity_) {
+    records_.push_back(record);
+  } else {
+    records_[next_idx_] = record;
+  }
+  next_idx_ = (next_idx_ + 1) % capacity_;
+}
+
+std::vector<FlightRecord> FlightRecorder::Snapshot() {
+  std::lock_guard<std::mutex> lk(records_mtx_);
+  if (records_.size() < capacity_) {
+    return records_;
+  }
+  // 记录已满时next_idx_指向最早的记录
+  std::vector<FlightRecord> records(records_.begin() + next_idx_,
+                                    records_.end());
+  records.insert(
+      records.end(), records_.begin(), records_.begin() + next_idx_);
+  return records;
+}
+
+bool FlightRecorder::DumpAsync(const std::string &file_name,
+                               const std::string &title) {
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count();
+  int64_t last_dump_ns = last_dump_ns_.load();
+  if (last_dump_ns > 0 &&
+      now_ns - last_dump_ns <
+          static_cast<int64_t>(min_dump_interval_ms_) * 1000000LL) {
+    return false;
+  }
+  // 多个线程同时触发时只有一个导出
+  if (!last_dump_ns_.compare_exchange_strong(last_dump_ns, now_ns)) {
+    return false;
+  }
+
+  auto records = Snapshot();
+  std::lock_guard<std::mutex> lk(dump_mtx_);
+  if (stop_ || dump_pending_) {
+    return false;
+  }
+  dump_records_.swap(records);
+  dump_file_ = file_name;
+  dump_title_ = title;
+  dump_pending_ = true;
+  if (!dump_thread_) {
+    dump_thread_ =
+        std::make_shared<std::thread>(&FlightRecorder::DumpLoop, this);
+  }
+  dump_cv_.notify_one();
+  return true;
+}
+
+int FlightRecorder::Dump(const std::string &file_name,
+                         const std::string &title) {
+  return WriteCsv(Snapshot(), file_name, title);
+}
+
+void FlightRecorder::DumpLoop() {
+  pthread_setname_np(pthread_self(), "dnn_flight_rec");
+  while (true) {
+    std::vector<FlightRecord> records;
+    std::string file_name;
+    std::string title;
+    {
+      std::unique_lock<std::mutex> lk(dump_mtx_);
+      dump_cv_.wait(lk, [this]() { return stop_ || dump_pending_; });
+      if (!dump_pending_) {
+        return;
+      }
+      records.swap(dump_records_);
+      file_name.swap(dump_file_);
+      title.swap(dump_title_);
+    }
+    WriteCsv(records, file_name, title);
+    std::lock_guard<std::mutex> lk(dump_mtx_);
+    dump_pending_ = false;
+  }
+}
+
+int FlightRecorder::WriteCsv(const std::vector<FlightRecord> &records,
+                             const std::string &file_name,
+                             const std::string &title) {
+  FILE *fp = fopen(file_name.c_str(), "w");
+  if (!fp) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Open flight record file %s failed",
+                 file_name.c_str());
+    return -1;
+  }
+  fprintf(fp, "# %s\n", title.c_str());
+  fprintf(fp,
+          "frame_stamp,stream_id,task_id,bpu_core_id,status,ret,"
+          "preprocess_start_us,alloc_done_us,preprocess_done_us,"
+          "submit_done_us,infer_done_us,parse_done_us,postprocess_start_us,"
+          "postprocess_done_us,end_to_end_us,queue_depth,running_task_num,"
+          "tensor_alloc_count,tensor_wait_count\n");
+  for (const auto &record : records) {
+    fprintf(fp,
+            "%" PRId64 ".%09" PRId64 ",%s,%d,%d,%d,%d,%" PRId64 ",%" PRId64
+            ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64 ",%" PRId64
+            ",%" PRId64 ",%" PRId64 ",%d,%d,%d,%" PRIu64 "\n",
+            static_cast<int64_t>(record.frame_stamp_ns / 1000000000LL),
+            static_cast<int64_t>(record.frame_stamp_ns % 1000000000LL),
+            record.stream_id.c_str(),
+            record.task_id,
+            record.bpu_core_id,
+            record.status,
+            record.ret,
+            record.preprocess_start_us,
+            record.alloc_done_us,
+            record.preprocess_done_us,
+            record.submit_done_us,
+            record.infer_done_us,
+            record.parse_done_us,
+            record.postprocess_start_us,
+            record.postprocess_done_us,
+            record.end_to_end_us,
+            record.queue_depth,
+            record.running_task_num,
+            static_cast<int>(record.tensor_alloc_count),
+            record.tensor_wait_count);
+  }
+  int ret = ferror(fp) ? -1 : 0;
+  fclose(fp);
+
+  RCLCPP_WARN(rclcpp::get_logger("dnn"),
+              "Dump %zu flight records to %s, ret: %d",
+              records.size(),
+              file_name.c_str(),
+              ret);
+  return ret;
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
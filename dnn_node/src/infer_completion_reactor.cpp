@@ -0,0 +1,162 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/infer_completion_reactor.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace hobot {
+namespace dnn_node {
+
+InferCompletionReactor::InferCompletionReactor(int poll_interval_ms,
+                                               bool busy_poll)
+    : poll_interval_ms_(poll_interval_ms < 1 ? 1 : poll_interval_ms),
+      busy_poll_(busy_poll) {}
+
+InferCompletionReactor::~InferCompletionReactor() {
+  Stop();
+  if (event_fd_ >= 0) {
+    close(event_fd_);
+    event_fd_ = -1;
+  }
+}
+
+int InferCompletionReactor::Start() {
+  if (thread_) {
+    return 0;
+  }
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (event_fd_ < 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"), "Create eventfd fail");
+    return -1;
+  }
+  stop_ = false;
+  thread_ = std::make_shared<std::thread>(
+      std::bind(&InferCompletionReactor::exec_loop, this));
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Completion reactor started, poll interval: %d ms, busy poll: %d",
+              poll_interval_ms_,
+              static_cast<int>(busy_poll_));
+  return 0;
+}
+
+void InferCompletionReactor::Stop() {
+  if (!thread_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(submit_mtx_);
+    stop_ = true;
+  }
+  submit_cv_.notify_all();
+  thread_->join();
+  thread_ = nullptr;
+}
+
+int InferCompletionReactor::Submit(
+    const std::shared_ptr<hobot::easy_dnn::Task> &task,
+    int infer_timeout_ms,
+    InferCompletionCbType cb) {
+  if (!task || !thread_) {
+    return -1;
+  }
+  InflightTask inflight_task;
+  inflight_task.task = task;
+  inflight_task.deadline = std::chrono::steady_clock::now() +
+                           std::chrono::milliseconds(infer_timeout_ms);
+  inflight_task.cb = std::move(cb);
+  {
+    std::lock_guard<std::mutex> lk(submit_mtx_);
+    submitted_tasks_.push_back(std::move(inflight_task));
+    inflight_num_++;
+  }
+  submit_cv_.notify_one();
+  return 0;
+}
+
+void InferCompletionReactor::Complete(InflightTask &inflight_task,
+                                      int32_t code) {
+  inflight_num_--;
+  if (inflight_task.cb) {
+    inflight_task.cb(code);
+  }
+  uint64_t event = 1;
+  if (write(event_fd_, &event, sizeof(event)) != sizeof(event)) {
+    RCLCPP_DEBUG(rclcpp::get_logger("dnn"), "Write completion event fail");
+  }
+}
+
+void InferCompletionReactor::exec_loop() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lk(submit_mtx_);
+      if (inflight_tasks_.empty() && submitted_tasks_.empty() && !stop_) {
+        // 没有推理中的任务时等待提交，busy_poll只在有推理中的任务时轮询
+        submit_cv_.wait(
+            lk, [this]() { return stop_ || !submitted_tasks_.empty(); });
+      }
+      inflight_tasks_.splice(inflight_tasks_.end(), submitted_tasks_);
+      if (stop_ && inflight_tasks_.empty()) {
+        break;
+      }
+    }
+
+    // 停止时不再轮询，等待所有推理中的任务完成
+    // 轮询时每个任务只检查不等待，一轮结束后没有任务完成才睡眠一次，
+    // 避免一轮轮询的耗时随推理中的任务数增长
+    size_t completed = 0;
+    for (auto it = inflight_tasks_.begin(); it != inflight_tasks_.end();) {
+      int32_t code = HB_DNN_SUCCESS;
+      if (stop_) {
+        auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           it->deadline - std::chrono::steady_clock::now())
+                           .count();
+        code = it->task->WaitInferDone(timeout > 0 ? timeout : 1);
+      } else {
+        code = it->task->PollInferDone(0);
+        if (code == HB_DNN_TIMEOUT) {
+          if (std::chrono::steady_clock::now() < it->deadline) {
+            ++it;
+            continue;
+          }
+          // 推理超时，释放推理任务
+          code = it->task->WaitInferDone(1);
+        }
+      }
+      Complete(*it, code);
+      it = inflight_tasks_.erase(it);
+      completed++;
+    }
+
+    if (completed > 0 || inflight_tasks_.empty()) {
+      continue;
+    }
+    if (busy_poll_) {
+      std::this_thread::yield();
+    } else {
+      std::unique_lock<std::mutex> lk(submit_mtx_);
+      submit_cv_.wait_for(lk,
+                          std::chrono::milliseconds(poll_interval_ms_),
+                          [this]() { return stop_.load(); });
+    }
+  }
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
@@ -0,0 +1,163 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/latency_histogram.h"
+
+#include <cmath>
+
+namespace hobot {
+namespace dnn_node {
+
+LatencyHistogram::LatencyHistogram() { Reset(); }
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+  if (value < static_cast<uint64_t>(kSubBucketNum)) {
+    return static_cast<int>(value);
+  }
+  int msb = 63 - __builtin_clzll(value);
+  if (msb >= kMaxValueBits) {
+    return kBucketNum - 1;
+  }
+  // 最高位之后的kSubBucketBits位作为桶内的序号
+  int shift = msb - kSubBucketBits;
+  int sub_index = static_cast<int>((value >> shift) & (kSubBucketNum - 1));
+  return (shift + 1) * kSubBucketNum + sub_index;
+}
+
+uint64_t LatencyHistogram::BucketUpperValue(int index) {
+  if (index < kSubBucketNum) {
+    return static_cast<uint64_t>(index);
+  }
+  int shift = index / kSubBucketNum - 1;
+  uint64_t sub_index = static_cast<uint64_t>(index % kSubBucketNum);
+  uint64_t lower = ((1ULL << kSubBucketBits) | sub_index) << shift;
+  return lower + (1ULL << shift) - 1;
+}
+
+void LatencyHistogram::Record(int64_t value_ns) {
+  uint64_t value = value_ns > 0 ? static_cast<uint64_t>(value_ns) : 0;
+  counts_[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  total_ns_.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+  while (value > max_ns &&
+         !max_ns_.compare_exchange_weak(
+             max_ns, value, std::memory_order_relaxed)) {
+  }
+}
+
+DnnNodeLatencyStat LatencyHistogram::GetStat() {
+  DnnNodeLatencyStat stat;
+  // 读取过程中可能有新的记录，按照读到的桶计数计算分位数
+  std::vector<uint64_t> counts(kBucketNum);
+  uint64_t count = 0;
+  for (int idx = 0; idx < kBucketNum; idx++) {
+    counts[idx] = counts_[idx].load(std::memory_order_relaxed);
+    count += counts[idx];
+  }
+  stat.count = count;
+  if (count == 0) {
+    return stat;
+  }
+  stat.mean_us =
+      static_cast<double>(total_ns_.load(std::memory_order_relaxed)) /
+      static_cast<double>(count) / 1000.0;
+  stat.max_us =
+      static_cast<double>(max_ns_.load(std::memory_order_relaxed)) / 1000.0;
+
+  const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+  double *results[] = {
+      &stat.p50_us, &stat.p90_us, &stat.p99_us, &stat.p999_us};
+  uint64_t accumulated = 0;
+  int idx = 0;
+  for (size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); q++) {
+    uint64_t target = static_cast<uint64_t>(
+        std::ceil(quantiles[q] * static_cast<double>(count)));
+    if (target < 1) {
+      target = 1;
+    }
+    while (idx < kBucketNum && accumulated + counts[idx] < target) {
+      accumulated += counts[idx];
+      idx++;
+    }
+    uint64_t value = BucketUpperValue(idx < kBucketNum ? idx : kBucketNum - 1);
+    *results[q] = static_cast<double>(value) / 1000.0;
+    if (*results[q] > stat.max_us) {
+      *results[q] = stat.max_us;
+    }
+  }
+  return stat;
+}
+
+void LatencyHistogram::Reset() {
+  for (auto &count : counts_) {
+    count.store(0, std::memory_order_relaxed);
+  }
+  total_ns_.store(0, std::memory_order_relaxed);
+  max_ns_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyRecorder::Record(DnnNodeLatencyStage stage, int64_t value_ns) {
+  histograms_[static_cast<size_t>(stage)].Record(value_ns);
+}
+
+void LatencyRecorder::Record(
+    DnnNodeLatencyStage stage,
+    const std::chrono::steady_clock::time_point &start,
+    const std::chrono::steady_clock::time_point &end) {
+  Record(stage,
+         std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+             .count());
+}
+
+std::vector<DnnNodeLatencyStat> LatencyRecorder::GetStat() {
+  std::vector<DnnNodeLatencyStat> stats;
+  for (size_t idx = 0; idx < histograms_.size(); idx++) {
+    auto stat = histograms_[idx].GetStat();
+    stat.stage = static_cast<DnnNodeLatencyStage>(idx);
+    stats.push_back(stat);
+  }
+  return stats;
+}
+
+void LatencyRecorder::Reset() {
+  for (auto &histogram : histograms_) {
+    histogram.Reset();
+  }
+}
+
+const char *LatencyRecorder::GetStageName(DnnNodeLatencyStage stage) {
+  switch (stage) {
+    case DnnNodeLatencyStage::QueueWait:
+      return "queue_wait";
+    case DnnNodeLatencyStage::AllocWait:
+      return "alloc_wait";
+    case DnnNodeLatencyStage::PreProcess:
+      return "preprocess";
+    case DnnNodeLatencyStage::Submit:
+      return "submit";
+    case DnnNodeLatencyStage::BpuExec:
+      return "bpu_exec";
+    case DnnNodeLatencyStage::Parse:
+      return "parse";
+    case DnnNodeLatencyStage::PostProcess:
+      return "postprocess";
+    case DnnNodeLatencyStage::EndToEnd:
+      return "end_to_end";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
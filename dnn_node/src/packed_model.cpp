@@ -0,0 +1,359 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/packed_model.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace hobot {
+namespace dnn_node {
+
+namespace {
+
+// 模型文件的路径信息，文件大小和修改时间不变时不重新计算hash
+struct ModelFileInfo {
+  off_t size = 0;
+  struct timespec mtime = {0, 0};
+  uint64_t hash = 0;
+};
+
+// 同一内容的模型文件，load_mtx保证只加载一次
+struct ModelCacheEntry {
+  std::mutex load_mtx;
+  std::weak_ptr<PackedModel> packed_model;
+};
+
+// 模型内容的key，使用长度和64位hash，降低hash冲突导致误用其他模型的概率
+using ModelCacheKey = std::pair<uint64_t, uint64_t>;
+
+struct ModelCacheKeyHash {
+  size_t operator()(const ModelCacheKey &key) const {
+    return std::hash<uint64_t>()(key.first * 31 + key.second);
+  }
+};
+
+struct ModelCache {
+  std::mutex mtx;
+  // key为模型文件的规范路径
+  std::unordered_map<std::string, ModelFileInfo> files;
+  // key为模型内容的长度和hash
+  std::unordered_map<ModelCacheKey,
+                     std::shared_ptr<ModelCacheEntry>,
+                     ModelCacheKeyHash>
+      entries;
+};
+
+ModelCache &GetModelCache() {
+  static ModelCache cache;
+  return cache;
+}
+
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+}  // namespace
+
+PackedModel::~PackedModel() {
+  if (cached_) {
+    // 最后一个引用释放时清理缓存
+    PruneCached(cache_size_, cache_hash_);
+  }
+  for (auto model : models_) {
+    delete model;
+  }
+  models_.clear();
+  if (packed_dnn_handle_) {
+    hbDNNRelease(packed_dnn_handle_);
+    packed_dnn_handle_ = nullptr;
+  }
+  if (mmap_addr_) {
+    munmap(mmap_addr_, mmap_size_);
+    mmap_addr_ = nullptr;
+  }
+}
+
+int PackedModel::Load(const std::string &model_file,
+                      std::shared_ptr<PackedModel> &packed_model,
+                      bool use_mmap) {
+  std::shared_ptr<PackedModel> loaded(new PackedModel());
+  loaded->model_file_ = model_file;
+  int ret = 0;
+  //第一步加载模型
+  if (use_mmap) {
+    int fd = open(model_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return HB_DNN_CAN_NOT_OPEN_FILE;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0 ||
+        file_stat.st_size > INT32_MAX) {
+      close(fd);
+      return HB_DNN_CAN_NOT_OPEN_FILE;
+    }
+    void *addr = mmap(nullptr,
+                      static_cast<size_t>(file_stat.st_size),
+                      PROT_READ,
+                      MAP_PRIVATE | MAP_POPULATE,
+                      fd,
+                      0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+      RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                   "Mmap model file: %s failed: %s",
+                   model_file.c_str(),
+                   strerror(errno));
+      return HB_DNN_CAN_NOT_OPEN_FILE;
+    }
+    loaded->mmap_addr_ = addr;
+    loaded->mmap_size_ = static_cast<size_t>(file_stat.st_size);
+    const void *data = addr;
+    int32_t len = static_cast<int32_t>(file_stat.st_size);
+    ret = hbDNNInitializeFromDDR(&loaded->packed_dnn_handle_, &data, &len, 1);
+  } else {
+    const char *file{model_file.c_str()};
+    ret = hbDNNInitializeFromFiles(&loaded->packed_dnn_handle_,
+                                   static_cast<const char **>(&file),
+                                   1);
+  }
+  if (ret != 0) {
+    loaded->packed_dnn_handle_ = nullptr;
+    return ret;
+  }
+
+  ret = loaded->InitModels();
+  if (ret != 0) {
+    return ret;
+  }
+  packed_model = loaded;
+  return 0;
+}
+
+int PackedModel::LoadFromMemory(const void *data,
+                                int32_t size,
+                                std::shared_ptr<PackedModel> &packed_model) {
+  if (!data || size <= 0) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Invalid model data, size: %d",
+                 size);
+    return HB_DNN_INVALID_ARGUMENT;
+  }
+  std::shared_ptr<PackedModel> loaded(new PackedModel());
+  loaded->model_file_ = "<memory>";
+  int ret =
+      hbDNNInitializeFromDDR(&loaded->packed_dnn_handle_, &data, &size, 1);
+  if (ret != 0) {
+    loaded->packed_dnn_handle_ = nullptr;
+    return ret;
+  }
+  ret = loaded->InitModels();
+  if (ret != 0) {
+    return ret;
+  }
+  packed_model = loaded;
+  return 0;
+}
+
+int PackedModel::InitModels() {
+  // 第二步获取模型名称
+  const char **model_names;
+  int32_t model_count = 0;
+  int ret =
+      hbDNNGetModelNameList(&model_names, &model_count, packed_dnn_handle_);
+  if (ret != 0) {
+    return ret;
+  }
+
+  // 第三步获取dnn_handle
+  for (int32_t i{0}; i < model_count; i++) {
+    hbDNNHandle_t dnn_handle{nullptr};
+    ret = hbDNNGetModelHandle(&dnn_handle, packed_dnn_handle_, model_names[i]);
+    if (ret != 0) {
+      return ret;
+    }
+    models_.push_back(new Model(dnn_handle, model_names[i]));
+  }
+  return 0;
+}
+
+void PackedModel::HashData(const void *data, size_t size, uint64_t &hash) {
+  auto bytes = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+}
+
+bool PackedModel::HashFile(const std::string &file, uint64_t &hash) {
+  std::ifstream ifs(file, std::ios::binary);
+  if (!ifs.is_open()) {
+    return false;
+  }
+  hash = kFnvOffsetBasis;
+  std::vector<char> buf(1 << 20);
+  while (ifs) {
+    ifs.read(buf.data(), buf.size());
+    HashData(buf.data(), static_cast<size_t>(ifs.gcount()), hash);
+  }
+  return !ifs.bad();
+}
+
+void PackedModel::PruneCached(uint64_t size, uint64_t hash) {
+  auto &cache = GetModelCache();
+  std::lock_guard<std::mutex> lk(cache.mtx);
+  auto it = cache.entries.find(ModelCacheKey(size, hash));
+  // 正在加载的entry被Acquire持有，不能删除
+  if (it != cache.entries.end() && it->second->packed_model.expired() &&
+      it->second.use_count() == 1) {
+    cache.entries.erase(it);
+  }
+}
+
+int PackedModel::AcquireCached(
+    uint64_t size,
+    uint64_t hash,
+    const std::function<int(std::shared_ptr<PackedModel> &)> &loader,
+    std::shared_ptr<PackedModel> &packed_model) {
+  auto &cache = GetModelCache();
+  std::shared_ptr<ModelCacheEntry> entry = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(cache.mtx);
+    auto &cache_entry = cache.entries[ModelCacheKey(size, hash)];
+    if (!cache_entry) {
+      cache_entry = std::make_shared<ModelCacheEntry>();
+    }
+    entry = cache_entry;
+  }
+
+  int ret = 0;
+  {
+    // 不同模型文件的加载可以并行，同一模型文件只加载一次
+    std::lock_guard<std::mutex> load_lk(entry->load_mtx);
+    packed_model = entry->packed_model.lock();
+    if (packed_model) {
+      RCLCPP_INFO(rclcpp::get_logger("dnn"),
+                  "Reuse model loaded from: %s",
+                  packed_model->GetFile().c_str());
+      return 0;
+    }
+    ret = loader(packed_model);
+    if (ret == 0) {
+      packed_model->cached_ = true;
+      packed_model->cache_size_ = size;
+      packed_model->cache_hash_ = hash;
+      entry->packed_model = packed_model;
+    }
+  }
+  if (ret != 0) {
+    // 加载失败时清理新建的entry
+    entry.reset();
+    PruneCached(size, hash);
+  }
+  return ret;
+}
+
+int PackedModel::Acquire(const std::string &model_file,
+                         std::shared_ptr<PackedModel> &packed_model,
+                         bool use_mmap) {
+  char real_path[PATH_MAX];
+  struct stat file_stat;
+  if (realpath(model_file.c_str(), real_path) == nullptr ||
+      stat(real_path, &file_stat) != 0) {
+    return HB_DNN_CAN_NOT_OPEN_FILE;
+  }
+
+  // 文件大小和修改时间和缓存中一致时使用缓存的hash
+  auto is_same_file = [&file_stat](const ModelFileInfo &info) {
+    return info.hash != 0 && info.size == file_stat.st_size &&
+           info.mtime.tv_sec == file_stat.st_mtim.tv_sec &&
+           info.mtime.tv_nsec == file_stat.st_mtim.tv_nsec;
+  };
+  auto &cache = GetModelCache();
+  uint64_t hash = 0;
+  {
+    std::lock_guard<std::mutex> lk(cache.mtx);
+    auto info = cache.files.find(real_path);
+    if (info != cache.files.end() && is_same_file(info->second)) {
+      hash = info->second.hash;
+    }
+  }
+
+  if (hash == 0) {
+    // 文件第一次使用或者已经被替换，在锁外计算hash，不阻塞其他模型的获取
+    uint64_t file_hash = 0;
+    if (!HashFile(real_path, file_hash)) {
+      return HB_DNN_CAN_NOT_OPEN_FILE;
+    }
+    std::lock_guard<std::mutex> lk(cache.mtx);
+    auto &info = cache.files[real_path];
+    // 计算期间其他线程可能已经更新了同一文件的hash
+    if (!is_same_file(info)) {
+      info.size = file_stat.st_size;
+      info.mtime = file_stat.st_mtim;
+      info.hash = file_hash;
+    }
+    hash = info.hash;
+  }
+
+  std::string file(real_path);
+  return AcquireCached(
+      static_cast<uint64_t>(file_stat.st_size),
+      hash,
+      [&file, use_mmap](std::shared_ptr<PackedModel> &loaded) {
+        return Load(file, loaded, use_mmap);
+      },
+      packed_model);
+}
+
+size_t PackedModel::GetCachedCount() {
+  auto &cache = GetModelCache();
+  std::lock_guard<std::mutex> lk(cache.mtx);
+  size_t count = 0;
+  for (auto it = cache.entries.begin(); it != cache.entries.end();) {
+    // 正在加载的entry被Acquire持有，不能删除
+    if (it->second->packed_model.expired() && it->second.use_count() == 1) {
+      it = cache.entries.erase(it);
+    } else {
+      count++;
+      ++it;
+    }
+  }
+  return count;
+}
+
+Model *PackedModel::GetModel(const std::string &model_name) const {
+  for (auto model : models_) {
+    if (model->GetName() == model_name) {
+      return model;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
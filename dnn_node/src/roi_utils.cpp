@@ -0,0 +1,98 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/roi_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace hobot {
+namespace dnn_node {
+
+int NormalizeRois(const std::vector<hbDNNRoi> &src_rois,
+                  int32_t img_w,
+                  int32_t img_h,
+                  const DnnNodeRoiConstraint &constraint,
+                  std::vector<hbDNNRoi> &dst_rois,
+                  std::vector<int> &src_index) {
+  dst_rois.clear();
+  src_index.clear();
+  if (img_w < 2 || img_h < 2) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Invalid image size: %d x %d for roi normalization",
+                 img_w,
+                 img_h);
+    return -1;
+  }
+
+  for (size_t i = 0; i < src_rois.size(); i++) {
+    const auto &src = src_rois[i];
+    float w = static_cast<float>(src.right - src.left + 1);
+    float h = static_cast<float>(src.bottom - src.top + 1);
+    if (w <= 0 || h <= 0) {
+      continue;
+    }
+    // roi坐标为闭区间，按照[left, right + 1)计算中心，不扩展时roi不变
+    float center_x = (src.left + src.right + 1) / 2.0f;
+    float center_y = (src.top + src.bottom + 1) / 2.0f;
+    w *= constraint.expand_ratio;
+    h *= constraint.expand_ratio;
+    if (constraint.square) {
+      w = h = std::max(w, h);
+    }
+
+    hbDNNRoi roi;
+    roi.left = static_cast<int32_t>(std::floor(center_x - w / 2.0f));
+    roi.top = static_cast<int32_t>(std::floor(center_y - h / 2.0f));
+    roi.right = static_cast<int32_t>(std::ceil(center_x + w / 2.0f)) - 1;
+    roi.bottom = static_cast<int32_t>(std::ceil(center_y + h / 2.0f)) - 1;
+
+    // 限制在图片内
+    roi.left = std::max(roi.left, 0);
+    roi.top = std::max(roi.top, 0);
+    roi.right = std::min(roi.right, img_w - 1);
+    roi.bottom = std::min(roi.bottom, img_h - 1);
+
+    // nv12图片uv分量宽高为y分量的一半，roi起点对齐到偶数，宽高对齐到偶数
+    roi.left &= ~1;
+    roi.top &= ~1;
+    roi.right |= 1;
+    roi.bottom |= 1;
+    if (roi.right > img_w - 1) {
+      roi.right -= 2;
+    }
+    if (roi.bottom > img_h - 1) {
+      roi.bottom -= 2;
+    }
+
+    int32_t roi_w = roi.right - roi.left + 1;
+    int32_t roi_h = roi.bottom - roi.top + 1;
+    if (roi_w < constraint.min_size || roi_h < constraint.min_size) {
+      continue;
+    }
+    if (constraint.max_size > 0 &&
+        (roi_w > constraint.max_size || roi_h > constraint.max_size)) {
+      continue;
+    }
+    dst_rois.push_back(roi);
+    src_index.push_back(static_cast<int>(i));
+  }
+  return static_cast<int>(dst_rois.size());
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
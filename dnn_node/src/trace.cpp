@@ -0,0 +1,208 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dnn_node/trace.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace hobot {
+namespace dnn_node {
+
+TraceRing::TraceRing(size_t capacity) {
+  // 容量取2的幂，使用位与计算下标
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  slots_.reset(new Slot[size]);
+  capacity_ = size;
+  mask_ = size - 1;
+}
+
+void TraceRing::Push(const TraceEvent &event) {
+  uint64_t idx = write_idx_.load(std::memory_order_relaxed);
+  Slot &slot = slots_[idx & mask_];
+  slot.seq.store(2 * idx + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(event.name, std::memory_order_relaxed);
+  slot.start_ns.store(event.start_ns, std::memory_order_relaxed);
+  slot.dur_ns.store(event.dur_ns, std::memory_order_relaxed);
+  slot.frame_stamp_ns.store(event.frame_stamp_ns, std::memory_order_relaxed);
+  slot.tid.store(event.tid, std::memory_order_relaxed);
+  slot.seq.store(2 * idx + 2, std::memory_order_release);
+  write_idx_.store(idx + 1, std::memory_order_release);
+}
+
+void TraceRing::Snapshot(std::vector<TraceEvent> &events) const {
+  uint64_t end = write_idx_.load(std::memory_order_acquire);
+  // 下标end的事件会写入最早事件所在的位置，不拷贝这个位置
+  uint64_t begin = end >= capacity_ ? end - capacity_ + 1 : 0;
+  for (uint64_t idx = begin; idx < end; idx++) {
+    const Slot &slot = slots_[idx & mask_];
+    uint64_t seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * idx + 2) {
+      // 已经被之后的事件覆盖或者正在写入
+      continue;
+    }
+    TraceEvent event;
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+    event.dur_ns = slot.dur_ns.load(std::memory_order_relaxed);
+    event.frame_stamp_ns = slot.frame_stamp_ns.load(std::memory_order_relaxed);
+    event.tid = slot.tid.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // 读取期间被写入线程覆盖，丢弃读到的事件
+    if (slot.seq.load(std::memory_order_relaxed) != seq) {
+      continue;
+    }
+    events.push_back(event);
+  }
+}
+
+namespace {
+// 线程退出时释放对环形缓存的占用
+struct TraceRingHolder {
+  std::shared_ptr<TraceRing> ring = nullptr;
+  ~TraceRingHolder() {
+    if (ring) {
+      ring->owned.store(false, std::memory_order_release);
+    }
+  }
+};
+thread_local TraceRingHolder tls_ring_holder;
+thread_local int32_t tls_tid = 0;
+}  // namespace
+
+TraceCollector &TraceCollector::Instance() {
+  static TraceCollector collector;
+  return collector;
+}
+
+TraceRing *TraceCollector::GetThreadRing() {
+  if (tls_ring_holder.ring) {
+    return tls_ring_holder.ring.get();
+  }
+  tls_tid = static_cast<int32_t>(syscall(SYS_gettid));
+  std::lock_guard<std::mutex> lck(rings_mtx_);
+  // 优先复用已退出线程的缓存，避免线程频繁创建时内存增长
+  for (auto &ring : rings_) {
+    bool expected = false;
+    if (ring->owned.compare_exchange_strong(expected, true)) {
+      tls_ring_holder.ring = ring;
+      return ring.get();
+    }
+  }
+  auto ring = std::make_shared<TraceRing>(kRingCapacity);
+  rings_.push_back(ring);
+  tls_ring_holder.ring = ring;
+  return ring.get();
+}
+
+void TraceCollector::Record(const char *name,
+                            const std::chrono::steady_clock::time_point &start,
+                            const std::chrono::steady_clock::time_point &end,
+                            int64_t frame_stamp_ns) {
+  TraceRing *ring = GetThreadRing();
+  TraceEvent event;
+  event.name = name;
+  event.start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       start.time_since_epoch())
+                       .count();
+  event.dur_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count();
+  event.frame_stamp_ns = frame_stamp_ns;
+  event.tid = tls_tid;
+  ring->Push(event);
+}
+
+int TraceCollector::DumpChromeJson(const std::string &file_name) {
+  std::vector<TraceEvent> events;
+  {
+    std::lock_guard<std::mutex> lck(rings_mtx_);
+    for (const auto &ring : rings_) {
+      ring->Snapshot(events);
+    }
+  }
+  int64_t clear_ns = clear_ns_.load(std::memory_order_relaxed);
+  std::sort(events.begin(),
+            events.end(),
+            [](const TraceEvent &lhs, const TraceEvent &rhs) {
+              return lhs.start_ns < rhs.start_ns;
+            });
+
+  FILE *fp = fopen(file_name.c_str(), "w");
+  if (!fp) {
+    RCLCPP_ERROR(rclcpp::get_logger("dnn"),
+                 "Open trace file %s failed",
+                 file_name.c_str());
+    return -1;
+  }
+  int pid = static_cast<int>(getpid());
+  fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  bool first = true;
+  size_t dumped = 0;
+  for (const auto &event : events) {
+    if (!event.name || event.start_ns < clear_ns) {
+      continue;
+    }
+    // Chrome trace event的时间单位为us
+    fprintf(fp,
+            "%s\n{\"name\":\"%s\",\"cat\":\"dnn\",\"ph\":\"X\",\"pid\":%d,"
+            "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+            first ? "" : ",",
+            event.name,
+            pid,
+            event.tid,
+            static_cast<double>(event.start_ns) / 1000.0,
+            static_cast<double>(event.dur_ns) / 1000.0);
+    if (event.frame_stamp_ns != 0) {
+      fprintf(fp,
+              ",\"args\":{\"frame_stamp\":\"%" PRId64 ".%09" PRId64 "\"}",
+              static_cast<int64_t>(event.frame_stamp_ns / 1000000000LL),
+              static_cast<int64_t>(event.frame_stamp_ns % 1000000000LL));
+    }
+    fprintf(fp, "}");
+    first = false;
+    dumped++;
+  }
+  fprintf(fp, "\n]}\n");
+  int ret = ferror(fp) ? -1 : 0;
+  fclose(fp);
+
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Dump %zu trace events to %s, ret: %d",
+              dumped,
+              file_name.c_str(),
+              ret);
+  return ret;
+}
+
+void TraceCollector::Clear() {
+  clear_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count(),
+                  std::memory_order_relaxed);
+}
+
+}  // namespace dnn_node
+}  // namespace hobot
@@ -23,22 +23,59 @@
 #include "dnn/hb_sys.h"
 #include "rclcpp/rclcpp.hpp"
 
+#include "dnn_node/trace.h"
+#include "easy_dnn/sys_mem.h"
 #include "include/util/image_proc.h"
 
 namespace hobot {
 namespace dnn_node {
 
+using hobot::easy_dnn::SysMemAccounting;
+using hobot::easy_dnn::SysMemCategory;
+
+// 图片内存统计在IMAGE_PROC类别下，超出预算时申请失败
+static int32_t AllocImageMem(hbSysMem *mem, uint32_t size) {
+  return SysMemAccounting::Instance().Alloc(
+      mem, size, SysMemCategory::IMAGE_PROC);
+}
+
+static void FreeImageMem(hbSysMem *mem) {
+  SysMemAccounting::Instance().Free(mem, SysMemCategory::IMAGE_PROC);
+}
+
+// 申请NV12图片的y和uv内存，失败时释放已申请的内存
+static int32_t AllocNV12Mem(hbSysMem *y,
+                            uint32_t y_size,
+                            hbSysMem *uv,
+                            uint32_t uv_size) {
+  if (AllocImageMem(y, y_size) != 0) {
+    return -1;
+  }
+  if (AllocImageMem(uv, uv_size) != 0) {
+    FreeImageMem(y);
+    return -1;
+  }
+  return 0;
+}
+
 std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromNV12Img(
     const char *in_img_data,
     const int &in_img_height,
     const int &in_img_width,
     const int &scaled_img_height,
     const int &scaled_img_width) {
+  DNN_TRACE_SCOPE("nv12_to_pyramid", 0);
   auto *y = new hbSysMem;
   auto *uv = new hbSysMem;
   auto w_stride = ALIGN_16(scaled_img_width);
-  hbSysAllocCachedMem(y, scaled_img_height * w_stride);
-  hbSysAllocCachedMem(uv, scaled_img_height / 2 * w_stride);
+  if (AllocNV12Mem(y,
+                   scaled_img_height * w_stride,
+                   uv,
+                   scaled_img_height / 2 * w_stride) != 0) {
+    delete y;
+    delete uv;
+    return nullptr;
+  }
   //内存初始化
   memset(y->virAddr, 0, scaled_img_height * w_stride);
   memset(uv->virAddr, 0, scaled_img_height / 2 * w_stride);
@@ -78,8 +115,8 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromNV12Img(
   return std::shared_ptr<NV12PyramidInput>(pyramid,
                                            [y, uv](NV12PyramidInput *pyramid) {
                                              // Release memory after deletion
-                                             hbSysFreeMem(y);
-                                             hbSysFreeMem(uv);
+                                             FreeImageMem(y);
+                                             FreeImageMem(uv);
                                              delete y;
                                              delete uv;
                                              delete pyramid;
@@ -96,6 +133,7 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromNV12Img(
     int &padding_t,
     int &padding_r,
     int &padding_b) {
+  DNN_TRACE_SCOPE("nv12_to_pyramid", 0);
   // 1 要求输入图片分辨率小于模型输入分辨率
   if (in_img_width > scaled_img_width && in_img_height > scaled_img_height) {
     return nullptr;
@@ -124,8 +162,14 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromNV12Img(
   // 3 申请内存并初始化
   auto *y = new hbSysMem;
   auto *uv = new hbSysMem;
-  hbSysAllocCachedMem(y, scaled_img_height * w_stride);
-  hbSysAllocCachedMem(uv, scaled_img_height / 2 * w_stride);
+  if (AllocNV12Mem(y,
+                   scaled_img_height * w_stride,
+                   uv,
+                   scaled_img_height / 2 * w_stride) != 0) {
+    delete y;
+    delete uv;
+    return nullptr;
+  }
   memset(y->virAddr, 0, scaled_img_height * w_stride);
   memset(uv->virAddr, 0, scaled_img_height / 2 * w_stride);
 
@@ -164,8 +208,8 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromNV12Img(
   return std::shared_ptr<NV12PyramidInput>(pyramid,
                                            [y, uv](NV12PyramidInput *pyramid) {
                                              // Release memory after deletion
-                                             hbSysFreeMem(y);
-                                             hbSysFreeMem(uv);
+                                             FreeImageMem(y);
+                                             FreeImageMem(uv);
                                              delete y;
                                              delete uv;
                                              delete pyramid;
@@ -174,6 +218,7 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromNV12Img(
 
 std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromBGRImg(
     const cv::Mat &bgr_mat, int scaled_img_height, int scaled_img_width) {
+  DNN_TRACE_SCOPE("bgr_to_pyramid", 0);
   cv::Mat nv12_mat;
   cv::Mat mat_tmp;
   mat_tmp.create(scaled_img_height, scaled_img_width, bgr_mat.type());
@@ -189,8 +234,14 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromBGRImg(
   auto *uv = new hbSysMem;
 
   auto w_stride = ALIGN_16(scaled_img_width);
-  hbSysAllocCachedMem(y, scaled_img_height * w_stride);
-  hbSysAllocCachedMem(uv, scaled_img_height / 2 * w_stride);
+  if (AllocNV12Mem(y,
+                   scaled_img_height * w_stride,
+                   uv,
+                   scaled_img_height / 2 * w_stride) != 0) {
+    delete y;
+    delete uv;
+    return nullptr;
+  }
 
   uint8_t *data = nv12_mat.data;
   auto *hb_y_addr = reinterpret_cast<uint8_t *>(y->virAddr);
@@ -227,8 +278,8 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromBGRImg(
   return std::shared_ptr<NV12PyramidInput>(pyramid,
                                            [y, uv](NV12PyramidInput *pyramid) {
                                              // Release memory after deletion
-                                             hbSysFreeMem(y);
-                                             hbSysFreeMem(uv);
+                                             FreeImageMem(y);
+                                             FreeImageMem(uv);
                                              delete y;
                                              delete uv;
                                              delete pyramid;
@@ -284,8 +335,14 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromBGR(
   auto *y = new hbSysMem;
   auto *uv = new hbSysMem;
 
-  hbSysAllocCachedMem(y, scaled_img_height * w_stride);
-  hbSysAllocCachedMem(uv, scaled_img_height / 2 * w_stride);
+  if (AllocNV12Mem(y,
+                   scaled_img_height * w_stride,
+                   uv,
+                   scaled_img_height / 2 * w_stride) != 0) {
+    delete y;
+    delete uv;
+    return nullptr;
+  }
 
   uint8_t *data = nv12_mat.data;
   auto *hb_y_addr = reinterpret_cast<uint8_t *>(y->virAddr);
@@ -322,8 +379,8 @@ std::shared_ptr<NV12PyramidInput> ImageProc::GetNV12PyramidFromBGR(
   return std::shared_ptr<NV12PyramidInput>(pyramid,
                                            [y, uv](NV12PyramidInput *pyramid) {
                                              // Release memory after deletion
-                                             hbSysFreeMem(y);
-                                             hbSysFreeMem(uv);
+                                             FreeImageMem(y);
+                                             FreeImageMem(uv);
                                              delete y;
                                              delete uv;
                                              delete pyramid;
@@ -350,8 +407,14 @@ std::shared_ptr<DNNTensor> ImageProc::GetNV12TensorFromNV12(const std::string &i
   auto *uv = new hbSysMem;
 
   auto w_stride = ALIGN_16(scaled_img_width);
-  hbSysAllocCachedMem(y, scaled_img_height * w_stride);
-  hbSysAllocCachedMem(uv, scaled_img_height / 2 * w_stride);
+  if (AllocNV12Mem(y,
+                   scaled_img_height * w_stride,
+                   uv,
+                   scaled_img_height / 2 * w_stride) != 0) {
+    delete y;
+    delete uv;
+    return nullptr;
+  }
 
   uint8_t *data = nv12_mat.data;
   auto *hb_y_addr = reinterpret_cast<uint8_t *>(y->virAddr);
@@ -386,8 +449,8 @@ std::shared_ptr<DNNTensor> ImageProc::GetNV12TensorFromNV12(const std::string &i
   return std::shared_ptr<DNNTensor>(
       input_tensor, [y, uv](DNNTensor *input_tensor) {
         // Release memory after deletion
-        hbSysFreeMem(y);
-        hbSysFreeMem(uv);
+        FreeImageMem(y);
+        FreeImageMem(uv);
         delete y;
         delete uv;
         delete input_tensor;
@@ -471,7 +534,11 @@ std::shared_ptr<DNNTensor> ImageProc::GetBGRTensorFromBGR(const std::string &ima
   }
 
   auto *mem = new hbSysMem;
-  hbSysAllocCachedMem(mem, scaled_img_height * w_stride * channel * src_elem_size);
+  if (AllocImageMem(
+          mem, scaled_img_height * w_stride * channel * src_elem_size) != 0) {
+    delete mem;
+    return nullptr;
+  }
   uint8_t *data = mat_tmp.data;
   auto *hb_mem_addr = reinterpret_cast<uint8_t *>(mem->virAddr);
 
@@ -503,7 +570,7 @@ std::shared_ptr<DNNTensor> ImageProc::GetBGRTensorFromBGR(const std::string &ima
   return std::shared_ptr<DNNTensor>(
       input_tensor, [mem](DNNTensor *input_tensor) {
         // Release memory after deletion
-        hbSysFreeMem(mem);
+        FreeImageMem(mem);
         delete mem;
         delete input_tensor;
       });
@@ -567,7 +634,11 @@ std::shared_ptr<DNNTensor> ImageProc::GetBGRTensorFromBGRImg(
   }
 
   auto *mem = new hbSysMem;
-  hbSysAllocCachedMem(mem, scaled_img_height * w_stride * channel * src_elem_size);
+  if (AllocImageMem(
+          mem, scaled_img_height * w_stride * channel * src_elem_size) != 0) {
+    delete mem;
+    return nullptr;
+  }
   uint8_t *data = mat_tmp.data;
   auto *hb_mem_addr = reinterpret_cast<uint8_t *>(mem->virAddr);
 
@@ -599,7 +670,7 @@ std::shared_ptr<DNNTensor> ImageProc::GetBGRTensorFromBGRImg(
   return std::shared_ptr<DNNTensor>(
       input_tensor, [mem](DNNTensor *input_tensor) {
         // Release memory after deletion
-        hbSysFreeMem(mem);
+        FreeImageMem(mem);
         delete mem;
         delete input_tensor;
       });
@@ -634,7 +705,11 @@ std::shared_ptr<DNNTensor> ImageProc::GetBGRTensorFromBGRImg(
   }
 
   auto *mem = new hbSysMem;
-  hbSysAllocCachedMem(mem, scaled_img_height * w_stride * 3 * src_elem_size);
+  if (AllocImageMem(mem, scaled_img_height * w_stride * 3 * src_elem_size) !=
+      0) {
+    delete mem;
+    return nullptr;
+  }
   //内存初始化
   memset(mem->virAddr, 0, scaled_img_height * w_stride * 3 * src_elem_size);
 
@@ -660,13 +735,14 @@ std::shared_ptr<DNNTensor> ImageProc::GetBGRTensorFromBGRImg(
   return std::shared_ptr<DNNTensor>(
       input_tensor, [mem](DNNTensor *input_tensor) {
         // Release memory after deletion
-        hbSysFreeMem(mem);
+        FreeImageMem(mem);
         delete mem;
         delete input_tensor;
       });
 }
 
 int32_t ImageProc::BGRToNv12(cv::Mat &bgr_mat, cv::Mat &img_nv12) {
+  DNN_TRACE_SCOPE("bgr_to_nv12", 0);
   auto height = bgr_mat.rows;
   auto width = bgr_mat.cols;
 
@@ -709,6 +785,7 @@ int32_t ImageProc::BGRToNv12(cv::Mat &bgr_mat, cv::Mat &img_nv12) {
 }
 
 int32_t ImageProc::Nv12ToBGR(const char *in_img_data, const int &in_img_height, const int &in_img_width, cv::Mat &bgr_mat) {
+  DNN_TRACE_SCOPE("nv12_to_bgr", 0);
   cv::Mat Nv12_image(in_img_height + in_img_height / 2, in_img_width, CV_8UC1, (void*)in_img_data);
 
   cv::cvtColor(Nv12_image, bgr_mat, cv::COLOR_YUV2BGR_NV12);
@@ -0,0 +1,263 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "threads/work_stealing_executor.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace hobot {
+
+// workers check this to post into their own deque
+static thread_local WorkStealingExecutor *tls_executor = nullptr;
+static thread_local int tls_worker_idx = -1;
+
+WorkStealingExecutor::WorkStealingExecutor(const ExecutorConfig &config)
+    : config_(config), inject_queue_(config.queue_capacity) {
+  if (config_.thread_num < 1) {
+    config_.thread_num = 1;
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  stop_ = true;
+  for (auto &worker : workers_) {
+    Unpark(*worker);
+  }
+  for (auto &worker : workers_) {
+    if (worker->thread) {
+      worker->thread->join();
+    }
+  }
+}
+
+int WorkStealingExecutor::Start() {
+  std::lock_guard<std::mutex> lck(start_mtx_);
+  if (started_) {
+    return 0;
+  }
+  for (int i = 0; i < config_.thread_num; i++) {
+    workers_.emplace_back(new Worker());
+  }
+  for (int i = 0; i < config_.thread_num; i++) {
+    workers_[i]->thread = std::make_shared<std::thread>(
+        std::bind(&WorkStealingExecutor::exec_loop, this, i));
+  }
+  started_ = true;
+  RCLCPP_INFO(rclcpp::get_logger("dnn"),
+              "Executor [%s] started, thread num: %d, pinned cpu num: %zu, "
+              "sched priority: %d, nice: %d",
+              config_.name.c_str(),
+              config_.thread_num,
+              config_.cpu_affinity.size(),
+              config_.sched_priority,
+              config_.nice);
+  return 0;
+}
+
+void WorkStealingExecutor::ConfigThread(int worker_idx) {
+  // thread name is limited to 16 bytes including the terminating null
+  std::string thread_name =
+      config_.name.substr(0, 11) + "_" + std::to_string(worker_idx);
+  pthread_setname_np(pthread_self(), thread_name.substr(0, 15).c_str());
+
+  if (!config_.cpu_affinity.empty()) {
+    int cpu = config_.cpu_affinity[worker_idx % config_.cpu_affinity.size()];
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (ret != 0) {
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Set affinity of thread [%s] to cpu %d failed: %s",
+                  thread_name.c_str(),
+                  cpu,
+                  strerror(ret));
+    }
+  }
+
+  if (config_.sched_priority > 0) {
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = config_.sched_priority;
+    int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0) {
+      // usually EPERM without CAP_SYS_NICE, keep running with SCHED_OTHER
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Set SCHED_FIFO priority %d of thread [%s] failed: %s",
+                  config_.sched_priority,
+                  thread_name.c_str(),
+                  strerror(ret));
+    }
+  } else if (config_.nice != 0) {
+    // nice is a per thread attribute on linux
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    if (setpriority(PRIO_PROCESS, tid, config_.nice) != 0) {
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Set nice %d of thread [%s] failed: %s",
+                  config_.nice,
+                  thread_name.c_str(),
+                  strerror(errno));
+    }
+  }
+}
+
+bool WorkStealingExecutor::PostTask(TaskFunction task) {
+  if (stop_) {
+    return false;
+  }
+  if (tls_executor == this && tls_worker_idx >= 0) {
+    auto &worker = *workers_[tls_worker_idx];
+    std::lock_guard<std::mutex> lck(worker.deque_mtx);
+    worker.tasks.push_back(std::move(task));
+  } else if (!inject_queue_.Push(std::move(task))) {
+    return false;
+  }
+  task_num_.fetch_add(1);
+  WakeOne();
+  return true;
+}
+
+bool WorkStealingExecutor::TakeTask(int worker_idx, TaskFunction &task) {
+  // own deque first, in post order
+  {
+    auto &worker = *workers_[worker_idx];
+    std::lock_guard<std::mutex> lck(worker.deque_mtx);
+    if (!worker.tasks.empty()) {
+      task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+      return true;
+    }
+  }
+  if (inject_queue_.Pop(task)) {
+    return true;
+  }
+  // steal the oldest task of the other workers, tasks are run in post
+  // order no matter which worker takes them
+  size_t worker_num = workers_.size();
+  for (size_t i = 1; i < worker_num; i++) {
+    auto &victim = *workers_[(worker_idx + i) % worker_num];
+    std::unique_lock<std::mutex> lck(victim.deque_mtx, std::try_to_lock);
+    if (!lck.owns_lock() || victim.tasks.empty()) {
+      continue;
+    }
+    task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+void WorkStealingExecutor::Park(Worker &worker) {
+  std::unique_lock<std::mutex> lck(worker.park_mtx);
+  worker.park_cv.wait(lck, [&worker]() { return worker.permit; });
+  worker.permit = false;
+}
+
+void WorkStealingExecutor::Unpark(Worker &worker) {
+  {
+    std::lock_guard<std::mutex> lck(worker.park_mtx);
+    worker.permit = true;
+  }
+  worker.park_cv.notify_one();
+}
+
+void WorkStealingExecutor::WakeOne() {
+  size_t worker_num = workers_.size();
+  if (worker_num == 0) {
+    return;
+  }
+  unsigned int start = wake_idx_.fetch_add(1, std::memory_order_relaxed);
+  for (size_t i = 0; i < worker_num; i++) {
+    auto &worker = workers_[(start + i) % worker_num];
+    int expected = WORKER_PARKED;
+    if (worker->state.compare_exchange_strong(expected, WORKER_RUNNING)) {
+      Unpark(*worker);
+      return;
+    }
+  }
+}
+
+void WorkStealingExecutor::exec_loop(int worker_idx) {
+  tls_executor = this;
+  tls_worker_idx = worker_idx;
+  ConfigThread(worker_idx);
+
+  Worker &worker = *workers_[worker_idx];
+  TaskFunction task;
+  while (!stop_) {
+    if (TakeTask(worker_idx, task)) {
+      task_num_.fetch_sub(1);
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    // a task may be skipped by a failed try_lock while stealing,
+    // so recheck the counter after announcing parking
+    worker.state.store(WORKER_PARKED);
+    if (stop_ || task_num_.load() > 0) {
+      int expected = WORKER_PARKED;
+      if (worker.state.compare_exchange_strong(expected, WORKER_RUNNING)) {
+        std::this_thread::yield();
+        continue;
+      }
+    }
+    Park(worker);
+    worker.state.store(WORKER_RUNNING);
+  }
+}
+
+int WorkStealingExecutor::GetTaskNum() {
+  int task_num = task_num_.load(std::memory_order_relaxed);
+  return task_num > 0 ? task_num : 0;
+}
+
+std::shared_ptr<WorkStealingExecutor> WorkStealingExecutor::GetShared(
+    const ExecutorConfig &config) {
+  static std::mutex registry_mtx;
+  static std::map<std::string, std::weak_ptr<WorkStealingExecutor>> registry;
+
+  std::lock_guard<std::mutex> lck(registry_mtx);
+  auto executor = registry[config.name].lock();
+  if (executor) {
+    if (executor->GetConfig().thread_num != config.thread_num) {
+      RCLCPP_WARN(rclcpp::get_logger("dnn"),
+                  "Executor [%s] is shared with thread num %d, requested "
+                  "thread num %d is ignored",
+                  config.name.c_str(),
+                  executor->GetConfig().thread_num,
+                  config.thread_num);
+    }
+    return executor;
+  }
+  executor = std::make_shared<WorkStealingExecutor>(config);
+  if (executor->Start() != 0) {
+    return nullptr;
+  }
+  registry[config.name] = executor;
+  return executor;
+}
+
+}  // namespace hobot
@@ -0,0 +1,127 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "threads/bounded_queue.h"
+
+// each admission policy of the async run queue maps to one push mode
+
+TEST(TestBoundedQueue, RejectNewWhenFull) {
+  hobot::BoundedQueue<int> queue(2);
+  EXPECT_TRUE(queue.Push(1, 0));
+  EXPECT_TRUE(queue.Push(2, 0));
+  EXPECT_FALSE(queue.Push(3, 0));
+  EXPECT_EQ(queue.Size(), 2u);
+
+  int item = 0;
+  ASSERT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(item, 1);
+  EXPECT_TRUE(queue.Push(3, 0));
+}
+
+TEST(TestBoundedQueue, BoundedWaitTimeout) {
+  hobot::BoundedQueue<int> queue(1);
+  ASSERT_TRUE(queue.Push(1, 0));
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(queue.Push(2, 30));
+  auto waited_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  EXPECT_GE(waited_ms, 30);
+
+  // a consumer freeing a slot within the wait admits the item
+  std::thread consumer([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    int item = 0;
+    queue.Pop(item);
+  });
+  EXPECT_TRUE(queue.Push(3, 5000));
+  consumer.join();
+  EXPECT_EQ(queue.Size(), 1u);
+}
+
+TEST(TestBoundedQueue, DropOldestEvicts) {
+  hobot::BoundedQueue<int> queue(2);
+  int evicted = 0;
+  EXPECT_TRUE(queue.PushEvict(1, evicted));
+  EXPECT_TRUE(queue.PushEvict(2, evicted));
+  EXPECT_EQ(evicted, 0);
+  EXPECT_TRUE(queue.PushEvict(3, evicted));
+  EXPECT_EQ(evicted, 1);
+  EXPECT_EQ(queue.Size(), 2u);
+
+  int item = 0;
+  ASSERT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(item, 2);
+  ASSERT_TRUE(queue.TryPop(item));
+  EXPECT_EQ(item, 3);
+}
+
+TEST(TestBoundedQueue, LatestOnlyCoalesces) {
+  // item is stream id * 10 + sequence in stream
+  hobot::BoundedQueue<int> queue(8);
+  for (int item : {10, 20, 11, 21, 12}) {
+    ASSERT_TRUE(queue.Push(item, 0));
+  }
+
+  std::vector<int> removed;
+  auto count =
+      queue.RemoveIf([](int pending) { return pending / 10 == 1; }, removed);
+  EXPECT_EQ(count, 3u);
+  EXPECT_EQ(removed, (std::vector<int>{10, 11, 12}));
+  int evicted = 0;
+  EXPECT_TRUE(queue.PushEvict(13, evicted));
+  EXPECT_EQ(evicted, 0);
+
+  std::vector<int> remaining;
+  queue.Close(remaining);
+  EXPECT_EQ(remaining, (std::vector<int>{20, 21, 13}));
+}
+
+TEST(TestBoundedQueue, RemoveIfWakesBlockedPush) {
+  hobot::BoundedQueue<int> queue(1);
+  ASSERT_TRUE(queue.Push(1, 0));
+
+  std::thread canceler([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::vector<int> removed;
+    queue.RemoveIf([](int) { return true; }, removed);
+  });
+  EXPECT_TRUE(queue.Push(2, 5000));
+  canceler.join();
+}
+
+TEST(TestBoundedQueue, CloseRejectsAndReturnsItems) {
+  hobot::BoundedQueue<std::unique_ptr<int>> queue(2);
+  ASSERT_TRUE(queue.Push(std::unique_ptr<int>(new int(1)), 0));
+
+  std::vector<std::unique_ptr<int>> remaining;
+  queue.Close(remaining);
+  ASSERT_EQ(remaining.size(), 1u);
+  EXPECT_EQ(*remaining[0], 1);
+
+  std::unique_ptr<int> evicted;
+  EXPECT_FALSE(queue.Push(std::unique_ptr<int>(new int(2)), 0));
+  EXPECT_FALSE(queue.PushEvict(std::unique_ptr<int>(new int(3)), evicted));
+  EXPECT_FALSE(queue.PushForce(std::unique_ptr<int>(new int(4))));
+  std::unique_ptr<int> item;
+  EXPECT_FALSE(queue.Pop(item));
+}
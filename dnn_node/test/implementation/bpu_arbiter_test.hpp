@@ -0,0 +1,120 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dnn/hb_dnn_status.h"
+
+#include "dnn_node/bpu_arbiter.h"
+
+using hobot::dnn_node::BpuArbiter;
+using hobot::dnn_node::DnnPriorityClass;
+
+// 仲裁器是进程内单例，只有第一次配置生效，用例都基于这里的配置
+class TestBpuArbiter : public ::testing::Test {
+ protected:
+  static constexpr int kAgingMs = 100;
+
+  void SetUp() {
+    BpuArbiter::Instance().Configure(1, kAgingMs);
+    int waiting = 0;
+    int inflight = 0;
+    BpuArbiter::Instance().GetLoad(waiting, inflight);
+    ASSERT_EQ(waiting, 0);
+    ASSERT_EQ(inflight, 0);
+  }
+
+  // 在线程中等待名额，拿到名额后记录顺序并释放
+  std::thread Wait(DnnPriorityClass priority) {
+    std::thread waiter([this, priority]() {
+      if (BpuArbiter::Instance().Acquire(priority, false, -1) != 0) {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lk(mtx_);
+        granted_.push_back(priority);
+      }
+      BpuArbiter::Instance().Release();
+    });
+    WaitForWaiting(static_cast<int>(waiters_num_++) + 1);
+    return waiter;
+  }
+
+  void WaitForWaiting(int expected) {
+    int waiting = 0;
+    int inflight = 0;
+    for (int i = 0; i < 1000; i++) {
+      BpuArbiter::Instance().GetLoad(waiting, inflight);
+      if (waiting >= expected) {
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    FAIL() << "waiting: " << waiting << ", expected: " << expected;
+  }
+
+  std::mutex mtx_;
+  std::vector<DnnPriorityClass> granted_;
+  size_t waiters_num_ = 0;
+};
+
+constexpr int TestBpuArbiter::kAgingMs;
+
+TEST_F(TestBpuArbiter, HigherPriorityFirst) {
+  ASSERT_EQ(BpuArbiter::Instance().Acquire(DnnPriorityClass::Normal, false, -1),
+            0);
+  auto low = Wait(DnnPriorityClass::Low);
+  auto high = Wait(DnnPriorityClass::High);
+  BpuArbiter::Instance().Release();
+  low.join();
+  high.join();
+  EXPECT_EQ(granted_, (std::vector<DnnPriorityClass>{DnnPriorityClass::High,
+                                                      DnnPriorityClass::Low}));
+}
+
+TEST_F(TestBpuArbiter, AgingAvoidsStarvation) {
+  ASSERT_EQ(BpuArbiter::Instance().Acquire(DnnPriorityClass::Normal, false, -1),
+            0);
+  auto low = Wait(DnnPriorityClass::Low);
+  // 等待超过3个aging周期后，Low的有效优先级超过High
+  std::this_thread::sleep_for(std::chrono::milliseconds(kAgingMs * 3 + 50));
+  auto high = Wait(DnnPriorityClass::High);
+  BpuArbiter::Instance().Release();
+  low.join();
+  high.join();
+  EXPECT_EQ(granted_, (std::vector<DnnPriorityClass>{DnnPriorityClass::Low,
+                                                      DnnPriorityClass::High}));
+}
+
+TEST_F(TestBpuArbiter, TimeoutAndPreempt) {
+  auto &arbiter = BpuArbiter::Instance();
+  ASSERT_EQ(arbiter.Acquire(DnnPriorityClass::Normal, false, -1), 0);
+  EXPECT_EQ(arbiter.Acquire(DnnPriorityClass::Critical, false, 10),
+            HB_DNN_TIMEOUT);
+
+  // 抢占的推理任务不受名额限制
+  EXPECT_EQ(arbiter.Acquire(DnnPriorityClass::Low, true, 0), 0);
+  int waiting = 0;
+  int inflight = 0;
+  arbiter.GetLoad(waiting, inflight);
+  EXPECT_EQ(waiting, 0);
+  EXPECT_EQ(inflight, 2);
+  arbiter.Release();
+  arbiter.Release();
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "dnn_node/bpu_core_scheduler.h"
+
+using hobot::dnn_node::BpuCoreScheduler;
+
+TEST(TestBpuCoreScheduler, SingleCore) {
+  BpuCoreScheduler scheduler(1);
+  EXPECT_EQ(scheduler.GetCoreNum(), 1);
+  EXPECT_EQ(scheduler.Acquire(), HB_BPU_CORE_0);
+  EXPECT_EQ(scheduler.Acquire(), HB_BPU_CORE_0);
+  // 单核时指定的其他BPU核不合法，按照负载选择
+  EXPECT_EQ(scheduler.Acquire(HB_BPU_CORE_1), HB_BPU_CORE_0);
+}
+
+TEST(TestBpuCoreScheduler, EwmaUpdate) {
+  BpuCoreScheduler scheduler(2, 0.5);
+  ASSERT_EQ(scheduler.Acquire(HB_BPU_CORE_0), HB_BPU_CORE_0);
+  scheduler.Release(HB_BPU_CORE_0, 1000, true);
+  ASSERT_EQ(scheduler.Acquire(HB_BPU_CORE_0), HB_BPU_CORE_0);
+  scheduler.Release(HB_BPU_CORE_0, 2000, true);
+  // 失败的推理耗时不计入平均值
+  ASSERT_EQ(scheduler.Acquire(HB_BPU_CORE_0), HB_BPU_CORE_0);
+  scheduler.Release(HB_BPU_CORE_0, 100000, false);
+
+  auto stats = scheduler.GetStat();
+  ASSERT_EQ(stats.size(), 2u);
+  EXPECT_EQ(stats[0].core_id, HB_BPU_CORE_0);
+  EXPECT_FLOAT_EQ(stats[0].ewma_service_ms, 1.5f);
+  EXPECT_EQ(stats[0].inflight, 0);
+  EXPECT_EQ(stats[0].submit_count, 3u);
+  EXPECT_EQ(stats[0].done_count, 2u);
+  EXPECT_EQ(stats[0].fail_count, 1u);
+  EXPECT_EQ(stats[1].core_id, HB_BPU_CORE_1);
+  EXPECT_EQ(stats[1].submit_count, 0u);
+}
+
+TEST(TestBpuCoreScheduler, ChooseShortestExpectedFinish) {
+  BpuCoreScheduler scheduler(2, 0.5);
+  // 没有统计数据时轮流选择
+  ASSERT_EQ(scheduler.Acquire(), HB_BPU_CORE_0);
+  scheduler.Release(HB_BPU_CORE_0, 1000, true);
+  ASSERT_EQ(scheduler.Acquire(), HB_BPU_CORE_1);
+  scheduler.Release(HB_BPU_CORE_1, 4000, true);
+
+  // 核0期望完成时间为(inflight + 1) * 1ms，直到和核1的4ms相同
+  EXPECT_EQ(scheduler.Acquire(), HB_BPU_CORE_0);
+  EXPECT_EQ(scheduler.Acquire(), HB_BPU_CORE_0);
+  EXPECT_EQ(scheduler.Acquire(), HB_BPU_CORE_0);
+  EXPECT_EQ(scheduler.Acquire(), HB_BPU_CORE_1);
+
+  auto stats = scheduler.GetStat();
+  EXPECT_EQ(stats[0].inflight, 3);
+  EXPECT_EQ(stats[1].inflight, 1);
+
+  // 用户指定的BPU核不受负载影响
+  EXPECT_EQ(scheduler.Acquire(HB_BPU_CORE_1), HB_BPU_CORE_1);
+}
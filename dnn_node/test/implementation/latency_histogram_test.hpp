@@ -0,0 +1,125 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "dnn_node/latency_histogram.h"
+
+using hobot::dnn_node::DnnNodeLatencyStage;
+using hobot::dnn_node::LatencyHistogram;
+using hobot::dnn_node::LatencyRecorder;
+
+TEST(TestLatencyHistogram, Empty) {
+  LatencyHistogram histogram;
+  auto stat = histogram.GetStat();
+  EXPECT_EQ(stat.count, 0u);
+  EXPECT_DOUBLE_EQ(stat.p50_us, 0);
+  EXPECT_DOUBLE_EQ(stat.max_us, 0);
+}
+
+TEST(TestLatencyHistogram, ExactSmallValues) {
+  // 小于32ns的值每个值一个桶，分位数没有误差
+  LatencyHistogram histogram;
+  for (int value = 0; value < 32; value++) {
+    histogram.Record(value);
+  }
+  auto stat = histogram.GetStat();
+  EXPECT_EQ(stat.count, 32u);
+  EXPECT_DOUBLE_EQ(stat.p50_us, 0.015);
+  EXPECT_DOUBLE_EQ(stat.p90_us, 0.028);
+  EXPECT_DOUBLE_EQ(stat.max_us, 0.031);
+  EXPECT_DOUBLE_EQ(stat.mean_us, 0.0155);
+}
+
+TEST(TestLatencyHistogram, RelativeError) {
+  // 分位数为桶内最大值，不低估耗时，相对误差不超过1/32
+  for (int64_t value_ns : {33LL, 1000LL, 123456LL, 33000000LL}) {
+    LatencyHistogram histogram;
+    histogram.Record(value_ns);
+    histogram.Record(value_ns * 100);
+    auto stat = histogram.GetStat();
+    double value_us = value_ns / 1000.0;
+    EXPECT_GE(stat.p50_us, value_us) << value_ns;
+    EXPECT_LE(stat.p50_us, value_us * (1 + 1.0 / 32)) << value_ns;
+  }
+}
+
+TEST(TestLatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 99; i++) {
+    histogram.Record(1000);
+  }
+  histogram.Record(1000000);
+  auto stat = histogram.GetStat();
+  EXPECT_EQ(stat.count, 100u);
+  EXPECT_DOUBLE_EQ(stat.mean_us, 10.99);
+  // 1000ns所在桶为[992, 1007]
+  EXPECT_DOUBLE_EQ(stat.p50_us, 1.007);
+  EXPECT_DOUBLE_EQ(stat.p90_us, 1.007);
+  EXPECT_DOUBLE_EQ(stat.p99_us, 1.007);
+  // 分位数不超过最大值
+  EXPECT_DOUBLE_EQ(stat.p999_us, 1000);
+  EXPECT_DOUBLE_EQ(stat.max_us, 1000);
+}
+
+TEST(TestLatencyHistogram, OutOfRange) {
+  LatencyHistogram histogram;
+  histogram.Record(-5);
+  auto stat = histogram.GetStat();
+  EXPECT_EQ(stat.count, 1u);
+  EXPECT_DOUBLE_EQ(stat.max_us, 0);
+
+  // 超过最大值时记入最后一个桶，最大值保留实际值
+  histogram.Reset();
+  histogram.Record(1LL << 41);
+  stat = histogram.GetStat();
+  EXPECT_EQ(stat.count, 1u);
+  EXPECT_DOUBLE_EQ(stat.p50_us, static_cast<double>((1ULL << 40) - 1) / 1000);
+  EXPECT_DOUBLE_EQ(stat.max_us, static_cast<double>(1ULL << 41) / 1000);
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetStat().count, 0u);
+}
+
+TEST(TestLatencyHistogram, Recorder) {
+  LatencyRecorder recorder;
+  auto start = std::chrono::steady_clock::now();
+  recorder.Record(DnnNodeLatencyStage::BpuExec,
+                  start,
+                  start + std::chrono::microseconds(20));
+  recorder.Record(DnnNodeLatencyStage::Parse, 8000);
+
+  auto stats = recorder.GetStat();
+  ASSERT_EQ(stats.size(),
+            static_cast<size_t>(DnnNodeLatencyStage::StageNum));
+  for (size_t idx = 0; idx < stats.size(); idx++) {
+    EXPECT_EQ(stats[idx].stage, static_cast<DnnNodeLatencyStage>(idx));
+  }
+  auto bpu_exec_idx = static_cast<size_t>(DnnNodeLatencyStage::BpuExec);
+  auto parse_idx = static_cast<size_t>(DnnNodeLatencyStage::Parse);
+  auto queue_wait_idx = static_cast<size_t>(DnnNodeLatencyStage::QueueWait);
+  EXPECT_EQ(stats[bpu_exec_idx].count, 1u);
+  EXPECT_DOUBLE_EQ(stats[bpu_exec_idx].max_us, 20);
+  EXPECT_DOUBLE_EQ(stats[parse_idx].max_us, 8);
+  EXPECT_EQ(stats[queue_wait_idx].count, 0u);
+  EXPECT_EQ(std::string(LatencyRecorder::GetStageName(
+                DnnNodeLatencyStage::BpuExec)),
+            "bpu_exec");
+
+  recorder.Reset();
+  EXPECT_EQ(recorder.GetStat()[bpu_exec_idx].count, 0u);
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "threads/mpmc_ring.h"
+#include "threads/threadpool.h"
+
+TEST(TestMpmcRing, CapacityRoundUp) {
+  EXPECT_EQ(hobot::MpmcRing<int>(1).Capacity(), 2u);
+  EXPECT_EQ(hobot::MpmcRing<int>(5).Capacity(), 8u);
+  EXPECT_EQ(hobot::MpmcRing<int>(8).Capacity(), 8u);
+}
+
+TEST(TestMpmcRing, FullAndEmpty) {
+  hobot::MpmcRing<std::unique_ptr<int>> ring(4);
+  std::unique_ptr<int> item;
+  EXPECT_FALSE(ring.Pop(item));
+
+  // wrap around several laps in FIFO order
+  int next_push = 0;
+  int next_pop = 0;
+  for (int lap = 0; lap < 3; lap++) {
+    while (true) {
+      std::unique_ptr<int> value(new int(next_push));
+      if (!ring.Push(std::move(value))) {
+        // a rejected item is left untouched
+        ASSERT_NE(value, nullptr);
+        break;
+      }
+      next_push++;
+    }
+    EXPECT_EQ(next_push - next_pop, 4);
+    while (ring.Pop(item)) {
+      ASSERT_NE(item, nullptr);
+      EXPECT_EQ(*item, next_pop++);
+    }
+    EXPECT_EQ(next_pop, next_push);
+  }
+}
+
+TEST(TestMpmcRing, MoveOnlyJob) {
+  hobot::MpmcRing<hobot::TaskFunction> ring(2);
+  std::unique_ptr<int> value(new int(7));
+  int result = 0;
+  ASSERT_TRUE(ring.Push(
+      hobot::TaskFunction([value = std::move(value), &result]() {
+        result = *value;
+      })));
+
+  hobot::TaskFunction job;
+  ASSERT_TRUE(ring.Pop(job));
+  ASSERT_TRUE(static_cast<bool>(job));
+  job();
+  EXPECT_EQ(result, 7);
+}
+
+TEST(TestMpmcRing, ConcurrentProducersConsumers) {
+  const int producer_num = 4;
+  const int consumer_num = 4;
+  const int item_num = 20000;
+  hobot::MpmcRing<int> ring(64);
+  std::atomic<int> popped{0};
+  std::atomic<int64_t> sum{0};
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producer_num; p++) {
+    threads.emplace_back([&ring, p, item_num]() {
+      for (int i = 0; i < item_num; i++) {
+        int item = p * item_num + i;
+        while (!ring.Push(std::move(item))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (int c = 0; c < consumer_num; c++) {
+    threads.emplace_back([&]() {
+      int item = 0;
+      while (popped.load() < producer_num * item_num) {
+        if (ring.Pop(item)) {
+          sum += item;
+          popped++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // every item is popped exactly once
+  int64_t total = static_cast<int64_t>(producer_num) * item_num;
+  EXPECT_EQ(popped.load(), total);
+  EXPECT_EQ(sum.load(), total * (total - 1) / 2);
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "dnn_node/roi_utils.h"
+
+using hobot::dnn_node::DnnNodeRoiConstraint;
+using hobot::dnn_node::NormalizeRois;
+
+static hbDNNRoi MakeRoi(int32_t left,
+                        int32_t top,
+                        int32_t right,
+                        int32_t bottom) {
+  hbDNNRoi roi;
+  roi.left = left;
+  roi.top = top;
+  roi.right = right;
+  roi.bottom = bottom;
+  return roi;
+}
+
+static void ExpectRoi(const hbDNNRoi &roi,
+                      int32_t left,
+                      int32_t top,
+                      int32_t right,
+                      int32_t bottom) {
+  EXPECT_EQ(roi.left, left);
+  EXPECT_EQ(roi.top, top);
+  EXPECT_EQ(roi.right, right);
+  EXPECT_EQ(roi.bottom, bottom);
+}
+
+TEST(TestRoiUtils, Align) {
+  DnnNodeRoiConstraint constraint;
+  std::vector<hbDNNRoi> dst_rois;
+  std::vector<int> src_index;
+  ASSERT_EQ(NormalizeRois({MakeRoi(9, 11, 49, 50)},
+                          100,
+                          100,
+                          constraint,
+                          dst_rois,
+                          src_index),
+            1);
+  // left和top对齐到偶数，right和bottom对齐到奇数，宽高为偶数
+  ExpectRoi(dst_rois[0], 8, 10, 49, 51);
+  EXPECT_EQ(src_index, std::vector<int>{0});
+}
+
+TEST(TestRoiUtils, ClampToImage) {
+  DnnNodeRoiConstraint constraint;
+  std::vector<hbDNNRoi> dst_rois;
+  std::vector<int> src_index;
+  // 奇数宽高的图片，对齐后超出图片的right和bottom向内收缩
+  ASSERT_EQ(NormalizeRois({MakeRoi(-20, -10, 30, 40),
+                           MakeRoi(60, 30, 150, 90)},
+                          101,
+                          61,
+                          constraint,
+                          dst_rois,
+                          src_index),
+            2);
+  ExpectRoi(dst_rois[0], 0, 0, 31, 41);
+  ExpectRoi(dst_rois[1], 60, 30, 99, 59);
+}
+
+TEST(TestRoiUtils, ExpandAndSquare) {
+  DnnNodeRoiConstraint constraint;
+  constraint.expand_ratio = 2.0f;
+  constraint.square = true;
+  std::vector<hbDNNRoi> dst_rois;
+  std::vector<int> src_index;
+  ASSERT_EQ(NormalizeRois({MakeRoi(40, 40, 59, 49)},
+                          200,
+                          200,
+                          constraint,
+                          dst_rois,
+                          src_index),
+            1);
+  // 20x10扩展为40x20，再以长边扩展为40x40，top对齐后为40x42
+  ExpectRoi(dst_rois[0], 30, 24, 69, 65);
+}
+
+TEST(TestRoiUtils, FilterBySize) {
+  DnnNodeRoiConstraint constraint;
+  constraint.min_size = 16;
+  constraint.max_size = 64;
+  std::vector<hbDNNRoi> dst_rois;
+  std::vector<int> src_index;
+  ASSERT_EQ(NormalizeRois({MakeRoi(0, 0, 7, 7),
+                           MakeRoi(0, 0, 31, 31),
+                           MakeRoi(10, 10, 5, 20),
+                           MakeRoi(0, 0, 99, 99),
+                           MakeRoi(20, 20, 51, 51)},
+                          200,
+                          200,
+                          constraint,
+                          dst_rois,
+                          src_index),
+            2);
+  EXPECT_EQ(src_index, (std::vector<int>{1, 4}));
+  ExpectRoi(dst_rois[0], 0, 0, 31, 31);
+  ExpectRoi(dst_rois[1], 20, 20, 51, 51);
+}
+
+TEST(TestRoiUtils, InvalidImage) {
+  DnnNodeRoiConstraint constraint;
+  std::vector<hbDNNRoi> dst_rois{MakeRoi(0, 0, 31, 31)};
+  std::vector<int> src_index{0};
+  EXPECT_EQ(NormalizeRois({MakeRoi(0, 0, 31, 31)},
+                          0,
+                          100,
+                          constraint,
+                          dst_rois,
+                          src_index),
+            -1);
+  EXPECT_TRUE(dst_rois.empty());
+  EXPECT_TRUE(src_index.empty());
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "dnn/hb_dnn_status.h"
+
+#include "easy_dnn/sys_mem.h"
+
+using hobot::easy_dnn::SysMemAccounting;
+using hobot::easy_dnn::SysMemCategory;
+using hobot::easy_dnn::SysMemStat;
+
+// the accounting is process wide, cases check deltas of the statistics
+// and restore the budgets they set
+class TestSysMem : public ::testing::Test {
+ protected:
+  void SetUp() { before_ = SysMemAccounting::Instance().GetStat(); }
+
+  void TearDown() {
+    SysMemAccounting::Instance().SetBudget(SysMemCategory::USER, 0);
+    SysMemAccounting::Instance().SetBudget(SysMemCategory::CATEGORY_NUM, 0);
+  }
+
+  static size_t Index(SysMemCategory category) {
+    return static_cast<size_t>(category);
+  }
+
+  SysMemStat Delta(SysMemCategory category) {
+    auto after = SysMemAccounting::Instance().GetStat();
+    const auto &old_stat = before_[Index(category)];
+    SysMemStat stat = after[Index(category)];
+    stat.live_bytes -= old_stat.live_bytes;
+    stat.alloc_count -= old_stat.alloc_count;
+    stat.free_count -= old_stat.free_count;
+    stat.fail_count -= old_stat.fail_count;
+    stat.over_budget_count -= old_stat.over_budget_count;
+    return stat;
+  }
+
+  std::vector<SysMemStat> before_;
+};
+
+TEST_F(TestSysMem, AllocAndFree) {
+  auto &accounting = SysMemAccounting::Instance();
+  hbSysMem mem;
+  ASSERT_EQ(accounting.Alloc(&mem, 4096, SysMemCategory::USER), 0);
+  auto stat = Delta(SysMemCategory::USER);
+  EXPECT_EQ(stat.live_bytes, mem.memSize);
+  EXPECT_EQ(stat.alloc_count, 1u);
+  EXPECT_GE(stat.peak_bytes, mem.memSize);
+
+  EXPECT_EQ(accounting.Free(&mem, SysMemCategory::USER), 0);
+  stat = Delta(SysMemCategory::USER);
+  EXPECT_EQ(stat.live_bytes, 0u);
+  EXPECT_EQ(stat.free_count, 1u);
+  EXPECT_EQ(stat.fail_count, 0u);
+  EXPECT_EQ(Delta(SysMemCategory::CATEGORY_NUM).live_bytes, 0u);
+}
+
+TEST_F(TestSysMem, CategoryBudget) {
+  auto &accounting = SysMemAccounting::Instance();
+  ASSERT_EQ(before_[Index(SysMemCategory::USER)].live_bytes, 0u);
+  accounting.SetBudget(SysMemCategory::USER, 8192);
+
+  hbSysMem mem0;
+  hbSysMem mem1;
+  hbSysMem rejected;
+  ASSERT_EQ(accounting.Alloc(&mem0, 4096, SysMemCategory::USER), 0);
+  EXPECT_EQ(accounting.Alloc(&rejected, 8192, SysMemCategory::USER),
+            HB_DNN_OUT_OF_MEMORY);
+  // the budget itself can be used up
+  ASSERT_EQ(accounting.Alloc(&mem1, 4096, SysMemCategory::USER), 0);
+  EXPECT_EQ(accounting.Alloc(&rejected, 1, SysMemCategory::USER),
+            HB_DNN_OUT_OF_MEMORY);
+  // other categories are not limited by the budget of USER
+  hbSysMem warmup;
+  ASSERT_EQ(accounting.Alloc(&warmup, 4096, SysMemCategory::WARMUP), 0);
+  accounting.Free(&warmup, SysMemCategory::WARMUP);
+
+  auto stat = Delta(SysMemCategory::USER);
+  EXPECT_EQ(stat.budget_bytes, 8192u);
+  EXPECT_EQ(stat.live_bytes, 8192u);
+  EXPECT_EQ(stat.alloc_count, 2u);
+  EXPECT_EQ(stat.fail_count, 2u);
+  EXPECT_EQ(stat.over_budget_count, 2u);
+
+  accounting.Free(&mem0, SysMemCategory::USER);
+  ASSERT_EQ(accounting.Alloc(&mem0, 4096, SysMemCategory::USER), 0);
+  accounting.Free(&mem0, SysMemCategory::USER);
+  accounting.Free(&mem1, SysMemCategory::USER);
+  EXPECT_EQ(Delta(SysMemCategory::USER).live_bytes, 0u);
+}
+
+TEST_F(TestSysMem, TotalBudget) {
+  auto &accounting = SysMemAccounting::Instance();
+  uint64_t live_bytes = before_[Index(SysMemCategory::CATEGORY_NUM)].live_bytes;
+  accounting.SetBudget(SysMemCategory::CATEGORY_NUM, live_bytes + 4096);
+
+  hbSysMem mem;
+  hbSysMem rejected;
+  ASSERT_EQ(accounting.Alloc(&mem, 4096, SysMemCategory::USER), 0);
+  EXPECT_EQ(accounting.Alloc(&rejected, 4096, SysMemCategory::WARMUP),
+            HB_DNN_OUT_OF_MEMORY);
+
+  // the rejection is counted in both the category and the total
+  auto warmup = Delta(SysMemCategory::WARMUP);
+  EXPECT_EQ(warmup.live_bytes, 0u);
+  EXPECT_EQ(warmup.fail_count, 1u);
+  EXPECT_EQ(warmup.over_budget_count, 1u);
+  auto total = Delta(SysMemCategory::CATEGORY_NUM);
+  EXPECT_EQ(total.live_bytes, 4096u);
+  EXPECT_EQ(total.fail_count, 1u);
+  EXPECT_EQ(total.over_budget_count, 1u);
+
+  accounting.Free(&mem, SysMemCategory::USER);
+  EXPECT_EQ(Delta(SysMemCategory::CATEGORY_NUM).live_bytes, 0u);
+}
+
+TEST_F(TestSysMem, InvalidArgument) {
+  auto &accounting = SysMemAccounting::Instance();
+  hbSysMem mem;
+  EXPECT_EQ(accounting.Alloc(nullptr, 16, SysMemCategory::USER),
+            HB_DNN_INVALID_ARGUMENT);
+  EXPECT_EQ(accounting.Alloc(&mem, 16, SysMemCategory::CATEGORY_NUM),
+            HB_DNN_INVALID_ARGUMENT);
+  EXPECT_EQ(Delta(SysMemCategory::CATEGORY_NUM).alloc_count, 0u);
+}
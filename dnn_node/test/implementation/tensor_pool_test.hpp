@@ -0,0 +1,150 @@
+// Copyright (c) 2024，Horizon Robotics.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "easy_dnn/sys_mem.h"
+#include "easy_dnn/tensor_pool.h"
+
+using hobot::easy_dnn::DNNTensor;
+using hobot::easy_dnn::SysMemAccounting;
+using hobot::easy_dnn::SysMemCategory;
+using hobot::easy_dnn::TensorPool;
+
+class TestTensorPool : public ::testing::Test {
+ protected:
+  void SetUp() {
+    // 1x1x4x4 u8 tensor, 16 bytes
+    properties_ = {};
+    properties_.tensorType = HB_DNN_TENSOR_TYPE_U8;
+    properties_.alignedShape.numDimensions = 4;
+    properties_.alignedShape.dimensionSize[0] = 1;
+    properties_.alignedShape.dimensionSize[1] = 1;
+    properties_.alignedShape.dimensionSize[2] = 4;
+    properties_.alignedShape.dimensionSize[3] = 4;
+    properties_.validShape = properties_.alignedShape;
+  }
+
+  hbDNNTensorProperties properties_;
+};
+
+TEST_F(TestTensorPool, MemSize) {
+  EXPECT_EQ(TensorPool::GetTensorMemSize(properties_), 16u);
+  properties_.tensorType = HB_DNN_TENSOR_TYPE_F32;
+  EXPECT_EQ(TensorPool::GetTensorMemSize(properties_), 64u);
+}
+
+TEST_F(TestTensorPool, ReuseReleasedBuffer) {
+  TensorPool pool(2, 100);
+  ASSERT_EQ(pool.Reserve(properties_, 2, 1), 0);
+  auto stat = pool.GetStat();
+  EXPECT_EQ(stat.total_count, 1);
+  EXPECT_EQ(stat.free_count, 1);
+
+  void *vir_addr = nullptr;
+  {
+    auto tensor = pool.Acquire(properties_);
+    ASSERT_NE(tensor, nullptr);
+    vir_addr = tensor->sysMem[0].virAddr;
+    EXPECT_EQ(pool.GetStat().free_count, 0);
+  }
+  // the released buffer goes back to the pool instead of the system
+  auto tensor = pool.Acquire(properties_);
+  ASSERT_NE(tensor, nullptr);
+  EXPECT_EQ(tensor->sysMem[0].virAddr, vir_addr);
+  stat = pool.GetStat();
+  EXPECT_EQ(stat.total_count, 1);
+  EXPECT_EQ(stat.wait_count, 0u);
+}
+
+TEST_F(TestTensorPool, TimeoutWhenExhausted) {
+  const int32_t wait_timeout_ms = 50;
+  TensorPool pool(2, wait_timeout_ms);
+  auto tensor0 = pool.Acquire(properties_);
+  auto tensor1 = pool.Acquire(properties_);
+  ASSERT_NE(tensor0, nullptr);
+  ASSERT_NE(tensor1, nullptr);
+
+  auto start = std::chrono::steady_clock::now();
+  auto tensor2 = pool.Acquire(properties_);
+  auto waited_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  EXPECT_EQ(tensor2, nullptr);
+  EXPECT_GE(waited_ms, wait_timeout_ms);
+
+  auto stat = pool.GetStat();
+  EXPECT_EQ(stat.total_count, 2);
+  EXPECT_EQ(stat.free_count, 0);
+  EXPECT_EQ(stat.wait_count, 1u);
+  EXPECT_EQ(stat.timeout_count, 1u);
+}
+
+TEST_F(TestTensorPool, WakeUpOnRelease) {
+  TensorPool pool(1, 5000);
+  auto tensor = pool.Acquire(properties_);
+  ASSERT_NE(tensor, nullptr);
+
+  std::thread releaser([&tensor]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    tensor.reset();
+  });
+  // blocks until the releaser gives the only buffer back
+  auto waited = pool.Acquire(properties_);
+  releaser.join();
+  EXPECT_NE(waited, nullptr);
+
+  auto stat = pool.GetStat();
+  EXPECT_EQ(stat.total_count, 1);
+  EXPECT_EQ(stat.wait_count, 1u);
+  EXPECT_EQ(stat.timeout_count, 0u);
+}
+
+TEST_F(TestTensorPool, AllocFailureGivesSlotBack) {
+  TensorPool pool(1, 100);
+  auto &accounting = SysMemAccounting::Instance();
+  uint64_t live_bytes =
+      accounting.GetStat()[static_cast<size_t>(SysMemCategory::TENSOR_POOL)]
+          .live_bytes;
+  // no room for another buffer, the allocation is rejected by budget
+  accounting.SetBudget(SysMemCategory::TENSOR_POOL, live_bytes + 1);
+  EXPECT_EQ(pool.Acquire(properties_), nullptr);
+  accounting.SetBudget(SysMemCategory::TENSOR_POOL, 0);
+  auto stat = pool.GetStat();
+  EXPECT_EQ(stat.total_count, 0);
+  EXPECT_EQ(stat.wait_count, 0u);
+
+  // the slot taken by the failed allocation can be used without waiting
+  auto tensor = pool.Acquire(properties_);
+  EXPECT_NE(tensor, nullptr);
+  stat = pool.GetStat();
+  EXPECT_EQ(stat.total_count, 1);
+  EXPECT_EQ(stat.wait_count, 0u);
+}
+
+TEST_F(TestTensorPool, TensorOutlivesPool) {
+  std::shared_ptr<DNNTensor> tensor;
+  {
+    TensorPool pool(1, 0);
+    tensor = pool.Acquire(properties_);
+    ASSERT_NE(tensor, nullptr);
+  }
+  // the deleter holds the pool state, releasing late must be safe
+  tensor.reset();
+}
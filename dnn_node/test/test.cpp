@@ -21,6 +21,14 @@
 
 #include "implementation/implementation.hpp"
 #include "interface/interface.hpp"
+#include "implementation/tensor_pool_test.hpp"
+#include "implementation/bounded_queue_test.hpp"
+#include "implementation/mpmc_ring_test.hpp"
+#include "implementation/bpu_core_scheduler_test.hpp"
+#include "implementation/bpu_arbiter_test.hpp"
+#include "implementation/roi_utils_test.hpp"
+#include "implementation/latency_histogram_test.hpp"
+#include "implementation/sys_mem_test.hpp"
 
 int main(int argc, char** argv) {
   rclcpp::init(argc, argv);